@@ -35,3 +35,21 @@ Status DisplayManagerBase::Rescale(uint8_t *frame_buffer, void *display_buffer,
   // No rescale was required
   return Status::kFailure;
 }
+
+Status DisplayManagerBase::DisplayFrame(const FrameView &frame, std::string text, int tile) {
+  Status status = Status::kError;
+
+  if (tile != 0) {
+    std::cerr << "Tiles not supported by this display\n";
+  } else if (frame.format == PixelFormat::kRgb24 && frame.strides[0] == frame.width * 3) {
+    status = DisplayBuffer(frame.planes[0], {frame.width, frame.height, 3}, text);
+  } else {
+    std::cerr << "Pixel format not supported by this display\n";
+  }
+
+  // DisplayBuffer() has copied the frame
+  if (frame.release) frame.release();
+  return status;
+}
+
+Status DisplayManagerBase::ClearTile(int tile) { return Status::kSuccess; }
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,33 @@ struct Resolution {
   int bpp;
 };
 
+/// Pixel formats a frame can be displayed in
+enum class PixelFormat {
+  /// \brief Packed 24 bit RGB
+  kRgb24,
+  /// \brief Planar 4:2:0, Y then U then V
+  kI420,
+  /// \brief Semi-planar 4:2:0, Y then interleaved UV
+  kNv12
+};
+
+/// A video frame in memory owned by the caller
+struct FrameView {
+  /// \brief The pixel format
+  PixelFormat format = PixelFormat::kRgb24;
+  /// \brief The width in pixels
+  int width = 0;
+  /// \brief The height in pixels
+  int height = 0;
+  /// \brief The planes, only the first is used for RGB24
+  uint8_t *planes[3] = {};
+  /// \brief The stride of each plane in bytes
+  int strides[3] = {};
+  /// \brief Called once the display has finished with the planes, if set the display may hold on to them instead of
+  /// copying
+  std::function<void()> release;
+};
+
 /// The display manager class
 class DisplayManagerBase {
  public:
@@ -90,6 +118,27 @@ class DisplayManagerBase {
   ///
   virtual Status DisplayBuffer(uint8_t *frame_buffer, Resolution resolution, std::string text) = 0;
 
+  ///
+  /// \brief Display a frame in any supported pixel format
+  ///
+  /// The default only supports tightly packed RGB24 in a single tile and passes it to DisplayBuffer(). The frame is
+  /// always released, including on error.
+  ///
+  /// \param frame The frame to display
+  /// \param text The text to display
+  /// \param tile The tile to show the frame in, for displays that show several streams at once
+  /// \return Status
+  ///
+  virtual Status DisplayFrame(const FrameView &frame, std::string text, int tile = 0);
+
+  ///
+  /// \brief Blank a tile once its stream has gone, the default does nothing and the last frame stays up
+  ///
+  /// \param tile The tile to clear
+  /// \return Status
+  ///
+  virtual Status ClearTile(int tile);
+
   ///
   /// \brief Rescale the video if needed
   ///
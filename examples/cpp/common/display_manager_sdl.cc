@@ -15,13 +15,14 @@
 #include <SDL2/SDL_image.h>
 #include <signal.h>
 
+#include <cmath>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 /// Static frame buffer
 std::vector<uint8_t> DisplayManager::frame_buffer_;
-SDL_Texture *DisplayManager::texture_ = nullptr;
 
 /// Initalise width (default)
 uint32_t DisplayManager::width_ = 0;
@@ -29,6 +30,8 @@ uint32_t DisplayManager::width_ = 0;
 uint32_t DisplayManager::height_ = 0;
 /// Draw buffer
 std::vector<uint8_t> DisplayManager::draw_buffer_;
+/// Draw buffer has not been uploaded, initially black
+bool DisplayManager::draw_buffer_dirty_ = true;
 bool DisplayManager::running_ = true;
 
 std::string DisplayManager::text_ = "0x0";  // NOLINT
@@ -40,6 +43,18 @@ std::string DisplayManager::text_ = "0x0";  // NOLINT
 /// \brief Default fullscreen
 bool DEFAULT_FULLSCREEN = false;
 
+/// \brief The SDL texture format for a pixel format
+static Uint32 SdlFormat(PixelFormat format) {
+  switch (format) {
+    case PixelFormat::kI420:
+      return SDL_PIXELFORMAT_IYUV;
+    case PixelFormat::kNv12:
+      return SDL_PIXELFORMAT_NV12;
+    default:
+      return SDL_PIXELFORMAT_RGB24;
+  }
+}
+
 DisplayManager::DisplayManager() {
   // Set the width and height
   width_ = DEFAULT_WIDTH;
@@ -113,7 +128,9 @@ Status DisplayManager::Initalise(uint32_t width, uint32_t height, std::string ti
 }
 
 void DisplayManager::Run() {
-  int w, h;  // texture width & height
+  int w, h;  // render width & height
+  std::vector<TileTexture> textures;
+  std::vector<FrameView> frames;
 
   if (!window_) {
     std::cerr << "Window not created\n";
@@ -129,14 +146,8 @@ void DisplayManager::Run() {
     exit(1);
   }
 
-  // Create the texture once
-  texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width_, height_);
-  if (!texture_) {
-    std::cerr << "Could not create texture: " << SDL_GetError() << "\n";
-    SDL_DestroyRenderer(renderer_);
-    SDL_DestroyWindow(window_);
-    exit(1);
-  }
+  // Frames that do not match the window are scaled on the GPU
+  SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
   // Main loop
   SDL_Event event;
@@ -146,40 +157,86 @@ void DisplayManager::Run() {
     else if (event.type == SDL_KEYUP && event.key.keysym.sym == SDLK_ESCAPE)
       break;
 
-    // Update the texture with the surface data
-    SDL_UpdateTexture(texture_, NULL, draw_buffer_.data(), width_ * 3);
+    {
+      std::lock_guard<std::mutex> lock(frame_mutex_);
+      textures.resize(tiles_.size());
+      frames.resize(tiles_.size());
+
+      for (size_t i = 0; i < tiles_.size(); i++) {
+        // The stream has gone, leave the tile black
+        if (tiles_[i].cleared) {
+          if (textures[i].texture) SDL_DestroyTexture(textures[i].texture);
+          textures[i] = TileTexture();
+          tiles_[i].cleared = false;
+        }
+
+        // Take the queued zero copy frame if there is one
+        frames[i] = std::move(tiles_[i].queued);
+        tiles_[i].queued = FrameView();
+        if (frames[i].planes[0] != nullptr) continue;
+
+        // Otherwise show a copied frame if it has changed, uploaded under the lock as the producer writes it in place
+        if (tiles_[i].dirty) {
+          Upload(&textures[i], tiles_[i].copied);
+        } else if (i == 0 && draw_buffer_dirty_) {
+          Upload(&textures[i], DrawBufferView());
+        }
+        tiles_[i].dirty = false;
+      }
+      draw_buffer_dirty_ = false;
+    }
+
+    // Update the textures straight from the frame memory, then hand it back to the producer
+    for (size_t i = 0; i < frames.size(); i++) {
+      if (frames[i].planes[0] == nullptr) continue;
+      Upload(&textures[i], frames[i]);
+      if (frames[i].release) frames[i].release();
+      frames[i] = FrameView();
+    }
 
     // Clear the screen
     SDL_RenderClear(renderer_);
 
-    // Get the width and height of the texture
-    SDL_QueryTexture(texture_, NULL, NULL, &w, &h);
-
     // Check keypress if 'f' or 'F' is pressed, toggle fullscreen
     if (event.type == SDL_KEYUP && (event.key.keysym.sym == SDLK_f || event.key.keysym.sym == 'F')) {
       ToggleFullscreen();
     }
 
-    if (DEFAULT_FULLSCREEN) {
-      // If fullscreen, set the width and height to the screen's width and height
-      Resolution res = GetResolution();
-      h = res.height;
-      w = res.width;
-    } else {
-      h = height_;
-      w = width_;
+    // Scale the textures to the window, or the screen if fullscreen, whatever the frame size. More than one tile is
+    // laid out in a grid.
+    SDL_GetRendererOutputSize(renderer_, &w, &h);
+    int tiles = static_cast<int>(textures.size());
+    int columns = static_cast<int>(std::ceil(std::sqrt(tiles)));
+    int rows = (tiles + columns - 1) / columns;
+
+    for (int i = 0; i < tiles; i++) {
+      if (!textures[i].texture) continue;
+      int column = i % columns;
+      int row = i / columns;
+      // Rect to hold the texture's position and size
+      texr_ = {column * w / columns, row * h / rows, (column + 1) * w / columns - column * w / columns,
+               (row + 1) * h / rows - row * h / rows};
+
+      // Copy the texture to the rendering context
+      SDL_RenderCopy(renderer_, textures[i].texture, NULL, &texr_);
     }
 
-    texr_ = {0, 0, w, h};  // Rect to hold the texture's position and size
-
-    // Copy the texture to the rendering context
-    SDL_RenderCopy(renderer_, texture_, NULL, &texr_);
-
     // Flip the back buffer
     SDL_RenderPresent(renderer_);
   }
 
-  if (texture_) SDL_DestroyTexture(texture_);
+  // Hand back frames that were never shown
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    for (auto &tile : tiles_) {
+      if (tile.queued.release) tile.queued.release();
+      tile.queued = FrameView();
+    }
+  }
+
+  for (auto &texture : textures) {
+    if (texture.texture) SDL_DestroyTexture(texture.texture);
+  }
   if (renderer_) SDL_DestroyRenderer(renderer_);
   if (window_) SDL_DestroyWindow(window_);
 
@@ -245,16 +302,20 @@ Status DisplayManager::DisplayBuffer(uint8_t *frame_buffer, Resolution resolutio
     return Status::kError;
   }
 
-  if (resolution.width != width_ || resolution.height != height_) {
-    width_ = resolution.width;
-    height_ = resolution.height;
-    std::cerr << "Resolution changed to " << width_ << "x" << height_ << "\n";
-  }
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    if (resolution.width != width_ || resolution.height != height_) {
+      width_ = resolution.width;
+      height_ = resolution.height;
+      std::cerr << "Resolution changed to " << width_ << "x" << height_ << "\n";
+    }
 
-  memcpy(draw_buffer_.data(), frame_buffer, resolution.height * resolution.width * resolution.bpp);
+    // Fill the mask area with black, last kMaskBottomPixels at the bottom of the screen
+    draw_buffer_.resize((width_ * 3) * (height_));
 
-  // Fill the mask area with black, last kMaskBottomPixels at the bottom of the screen
-  draw_buffer_.resize((width_ * 3) * (height_));
+    memcpy(draw_buffer_.data(), frame_buffer, resolution.height * resolution.width * resolution.bpp);
+    draw_buffer_dirty_ = true;
+  }
 
   // Destroy the previous surface if it exists
   if (surface_) {
@@ -273,3 +334,143 @@ Status DisplayManager::DisplayBuffer(uint8_t *frame_buffer, Resolution resolutio
 
   return Status::kSuccess;
 }
+
+Status DisplayManager::DisplayFrame(const FrameView &frame, std::string text, int tile) {
+  text_ = text;
+  if (!initaliased_) {
+    std::cerr << "Display not initialised\n";
+    if (frame.release) frame.release();
+    return Status::kError;
+  }
+
+  if (frame.planes[0] == nullptr || tile < 0) {
+    std::cerr << "No frame buffer to display\n";
+    if (frame.release) frame.release();
+    return Status::kError;
+  }
+
+  if (frame.release) {
+    // Zero copy, the display holds on to the frame until it has been uploaded. Only the latest frame is queued, one
+    // that has not been shown yet is dropped.
+    FrameView dropped;
+    {
+      std::lock_guard<std::mutex> lock(frame_mutex_);
+      if (static_cast<size_t>(tile) >= tiles_.size()) tiles_.resize(tile + 1);
+      dropped = std::move(tiles_[tile].queued);
+      tiles_[tile].queued = frame;
+    }
+    if (dropped.release) dropped.release();
+  } else {
+    // Plane sizes as (bytes per row, rows), packed back to back in the tile buffer
+    int chroma_width = (frame.width + 1) / 2;
+    int chroma_height = (frame.height + 1) / 2;
+    std::vector<std::pair<int, int>> planes;
+    switch (frame.format) {
+      case PixelFormat::kI420:
+        planes = {{frame.width, frame.height}, {chroma_width, chroma_height}, {chroma_width, chroma_height}};
+        break;
+      case PixelFormat::kNv12:
+        planes = {{frame.width, frame.height}, {chroma_width * 2, chroma_height}};
+        break;
+      default:
+        planes = {{frame.width * 3, frame.height}};
+        break;
+    }
+
+    size_t size = 0;
+    for (const auto &plane : planes) size += plane.first * plane.second;
+
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    if (static_cast<size_t>(tile) >= tiles_.size()) tiles_.resize(tile + 1);
+    Tile &target = tiles_[tile];
+    target.buffer.resize(size);
+    target.copied = FrameView();
+    target.copied.format = frame.format;
+    target.copied.width = frame.width;
+    target.copied.height = frame.height;
+
+    uint8_t *dst = target.buffer.data();
+    for (size_t p = 0; p < planes.size(); p++) {
+      target.copied.planes[p] = dst;
+      target.copied.strides[p] = planes[p].first;
+      for (int row = 0; row < planes[p].second; row++) {
+        memcpy(dst, frame.planes[p] + row * frame.strides[p], planes[p].first);
+        dst += planes[p].first;
+      }
+    }
+    target.dirty = true;
+  }
+
+  // SDL create event, this will cause the screen to refresh
+  SDL_Event event = {};
+  event.type = SDL_USEREVENT;
+  SDL_PushEvent(&event);
+
+  return Status::kSuccess;
+}
+
+Status DisplayManager::ClearTile(int tile) {
+  FrameView dropped;
+  {
+    std::lock_guard<std::mutex> lock(frame_mutex_);
+    if (tile < 0 || static_cast<size_t>(tile) >= tiles_.size()) return Status::kError;
+    Tile &target = tiles_[tile];
+    dropped = std::move(target.queued);
+    target.queued = FrameView();
+    target.copied = FrameView();
+    target.buffer.clear();
+    target.dirty = false;
+    target.cleared = true;
+  }
+  if (dropped.release) dropped.release();
+
+  // Refresh the screen
+  SDL_Event event = {};
+  event.type = SDL_USEREVENT;
+  SDL_PushEvent(&event);
+
+  return Status::kSuccess;
+}
+
+FrameView DisplayManager::DrawBufferView() {
+  // The draw buffer is tightly packed RGB24
+  FrameView frame;
+  frame.format = PixelFormat::kRgb24;
+  frame.width = width_;
+  frame.height = height_;
+  frame.planes[0] = draw_buffer_.data();
+  frame.strides[0] = width_ * 3;
+  return frame;
+}
+
+void DisplayManager::Upload(TileTexture *texture, const FrameView &frame) {
+  // Recreate the texture if the pixel format or size has changed, YUV is converted on the GPU
+  Uint32 format = SdlFormat(frame.format);
+  if (!texture->texture || texture->format != format || texture->width != frame.width ||
+      texture->height != frame.height) {
+    if (texture->texture) SDL_DestroyTexture(texture->texture);
+    texture->format = format;
+    texture->width = frame.width;
+    texture->height = frame.height;
+    texture->texture = SDL_CreateTexture(renderer_, format, SDL_TEXTUREACCESS_STREAMING, frame.width, frame.height);
+    if (!texture->texture) {
+      std::cerr << "Could not create texture: " << SDL_GetError() << "\n";
+      return;
+    }
+    std::cerr << "Texture changed to " << frame.width << "x" << frame.height << "\n";
+  }
+
+  switch (frame.format) {
+    case PixelFormat::kI420:
+      SDL_UpdateYUVTexture(texture->texture, NULL, frame.planes[0], frame.strides[0], frame.planes[1],
+                           frame.strides[1], frame.planes[2], frame.strides[2]);
+      break;
+    case PixelFormat::kNv12:
+      SDL_UpdateNVTexture(texture->texture, NULL, frame.planes[0], frame.strides[0], frame.planes[1],
+                          frame.strides[1]);
+      break;
+    default:
+      SDL_UpdateTexture(texture->texture, NULL, frame.planes[0], frame.strides[0]);
+      break;
+  }
+}
@@ -25,6 +25,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <mutex>
+
 #include "display_manager_base.h"
 
 /// The display manager class
@@ -87,6 +89,27 @@ class DisplayManager : public DisplayManagerBase {
   ///
   Status DisplayBuffer(uint8_t *frame_buffer, Resolution resolution, std::string text) final;
 
+  ///
+  /// \brief Display a frame, RGB24, I420 and NV12 are uploaded to the texture without conversion
+  ///
+  /// Frames with a release callback are not copied, they are uploaded from the caller's memory by Run() and released
+  /// afterwards. Each tile has its own texture, tiles are laid out in a grid that fills the window.
+  ///
+  /// \param frame The frame to display
+  /// \param text The text to display
+  /// \param tile The tile to show the frame in, the grid grows to fit
+  /// \return Status
+  ///
+  Status DisplayFrame(const FrameView &frame, std::string text, int tile = 0) final;
+
+  ///
+  /// \brief Blank a tile, its texture is destroyed and any frame waiting for it is released
+  ///
+  /// \param tile The tile to clear
+  /// \return Status
+  ///
+  Status ClearTile(int tile) final;
+
   ///
   /// \brief Flush the framebuffer /dev/fb0
   ///
@@ -114,6 +137,47 @@ class DisplayManager : public DisplayManagerBase {
   static std::string text_;
 
  private:
+  /// \brief Frames waiting for a tile, shared with the producers
+  struct Tile {
+    /// \brief A zero copy frame waiting to be uploaded
+    FrameView queued;
+    /// \brief Backing store for frames without a release callback
+    std::vector<uint8_t> buffer;
+    /// \brief The copied frame, planes point into buffer
+    FrameView copied;
+    /// \brief The copied frame has not been uploaded yet
+    bool dirty = false;
+    /// \brief The texture is to be destroyed
+    bool cleared = false;
+  };
+
+  /// \brief A tile's texture, only touched by Run()
+  struct TileTexture {
+    /// \brief The SDL texture, created on the first frame
+    SDL_Texture *texture = nullptr;
+    /// \brief The SDL pixel format
+    Uint32 format = 0;
+    /// \brief The texture width
+    int width = 0;
+    /// \brief The texture height
+    int height = 0;
+  };
+
+  ///
+  /// \brief A view of the RGB24 draw buffer, shown in the first tile
+  ///
+  /// \return FrameView The tightly packed draw buffer
+  ///
+  FrameView DrawBufferView();
+
+  ///
+  /// \brief Update a tile texture from a frame, recreating it if the size or format has changed
+  ///
+  /// \param texture The tile texture
+  /// \param frame The frame
+  ///
+  void Upload(TileTexture *texture, const FrameView &frame);
+
   /// \brief Frame buffer device
   static std::vector<uint8_t> frame_buffer_;
   /// \brief The default width
@@ -124,18 +188,22 @@ class DisplayManager : public DisplayManagerBase {
   bool initaliased_ = false;
   /// \brief The draw buffer
   static std::vector<uint8_t> draw_buffer_;
+  /// \brief The draw buffer has changed since it was last uploaded
+  static bool draw_buffer_dirty_;
   /// \brief The SDL window
   SDL_Window *window_ = nullptr;
   /// \brief The SDL surface
   SDL_Surface *surface_ = nullptr;
   /// \brief The SDL renderer
   SDL_Renderer *renderer_ = nullptr;
-  /// \brief The SDL texture
-  static SDL_Texture *texture_;
   /// \brief The SDL texture rect
   SDL_Rect texr_ = {0, 0, 0, 0};
   /// \brief The SDL event loop
   static bool running_;
+  /// \brief Frames waiting for each tile, there is always at least one
+  std::vector<Tile> tiles_ = std::vector<Tile>(1);
+  /// \brief Protects tiles_ and the draw buffer
+  std::mutex frame_mutex_;
 };
 
 #endif  // HARDWARE_DISPLAY_MANAGER_SDL_H_
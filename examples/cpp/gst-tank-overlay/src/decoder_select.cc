@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Rank, probe and fall back between the H.264 decoders available on this platform
+///
+/// \file decoder_select.cc
+///
+
+#include "decoder_select.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+/// \brief Known decoders, best first. Hardware, then software.
+static const char *kPreferredDecoders[] = {
+    "vah264dec",       // VA-API (gst-plugins-bad)
+    "vaapih264dec",    // VA-API (gstreamer-vaapi)
+    "nvv4l2decoder",   // NVIDIA Jetson
+    "v4l2slh264dec",   // V4L2 stateless (Rockchip, Allwinner, i.MX8M)
+    "v4l2h264dec",     // V4L2 stateful (Raspberry Pi, Qualcomm)
+    "avdec_h264",      // FFmpeg, threaded
+    "openh264dec",     // Cisco OpenH264
+};
+
+DecoderSelector::DecoderSelector(const std::string &preferred, int threads)
+    : threads_(threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency())) {
+  if (preferred != "auto") {
+    candidates_.push_back(preferred);
+    return;
+  }
+
+  for (const char *name : kPreferredDecoders) candidates_.push_back(name);
+
+  // Then anything else in the registry that can decode H.264, highest rank first
+  GList *factories = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_DECODER, GST_RANK_MARGINAL);
+  factories = g_list_sort(factories, (GCompareFunc)gst_plugin_feature_rank_compare_func);
+  GstCaps *h264 = gst_caps_from_string("video/x-h264");
+  for (GList *item = factories; item != NULL; item = item->next) {
+    GstElementFactory *factory = GST_ELEMENT_FACTORY(item->data);
+    std::string name = GST_OBJECT_NAME(factory);
+    if (gst_element_factory_can_sink_any_caps(factory, h264) &&
+        std::find(candidates_.begin(), candidates_.end(), name) == candidates_.end()) {
+      candidates_.push_back(name);
+    }
+  }
+  gst_caps_unref(h264);
+  gst_plugin_feature_list_free(factories);
+}
+
+GstElement *DecoderSelector::Next() {
+  while (next_ < candidates_.size()) {
+    const std::string &name = candidates_[next_++];
+
+    GstElement *decoder = gst_element_factory_make(name.c_str(), "h264decoder");
+    if (!decoder) continue;
+
+    // Software decoding, one thread per core unless the cores are shared between streams
+    if (name == "avdec_h264") g_object_set(decoder, "max-threads", threads_, NULL);
+
+    // Opening the device is enough to tell if there is hardware behind the plugin
+    gst_object_ref_sink(decoder);
+    GstStateChangeReturn ret = gst_element_set_state(decoder, GST_STATE_READY);
+    gst_element_set_state(decoder, GST_STATE_NULL);
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+      std::cerr << "Decoder " << name << " is installed but could not be opened, skipping\n";
+      gst_object_unref(decoder);
+      continue;
+    }
+
+    name_ = name;
+    std::cout << "Using decoder " << name_ << "\n";
+
+    // Hand back a floating reference so gst_bin_add() takes ownership as usual
+    g_object_force_floating(G_OBJECT(decoder));
+    return decoder;
+  }
+
+  name_.clear();
+  return nullptr;
+}
+
+DecodeThroughput::DecodeThroughput(std::string name, int interval_seconds)
+    : name_(std::move(name)), interval_(static_cast<gint64>(interval_seconds) * G_USEC_PER_SEC) {}
+
+void DecodeThroughput::Attach(GstElement *decoder) {
+  GstPad *pad = gst_element_get_static_pad(decoder, "src");
+  if (!pad) return;
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, Count, this, NULL);
+  gst_object_unref(pad);
+}
+
+GstPadProbeReturn DecodeThroughput::Count(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+  DecodeThroughput *self = static_cast<DecodeThroughput *>(user_data);
+  uint64_t frames = ++self->frames_;
+  gint64 now = g_get_monotonic_time();
+
+  if (self->logged_time_ == 0) {
+    self->logged_time_ = now;
+    self->logged_frames_ = frames;
+    return GST_PAD_PROBE_OK;
+  }
+
+  if (now - self->logged_time_ >= self->interval_) {
+    double fps = (frames - self->logged_frames_) * static_cast<double>(G_USEC_PER_SEC) / (now - self->logged_time_);
+    printf("Decoder %s: %.1f frames/s (%llu frames)\n", self->name_.c_str(), fps,
+           static_cast<unsigned long long>(frames));
+    self->logged_time_ = now;
+    self->logged_frames_ = frames;
+  }
+  return GST_PAD_PROBE_OK;
+}
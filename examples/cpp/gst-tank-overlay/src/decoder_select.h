@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Rank, probe and fall back between the H.264 decoders available on this platform
+///
+/// \file decoder_select.h
+///
+
+#ifndef GST_TANK_OVERLAY_DECODER_SELECT_H_
+#define GST_TANK_OVERLAY_DECODER_SELECT_H_
+
+#include <gst/gst.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+///
+/// \brief Hands out H.264 decoders in order of preference, skipping any that cannot be used
+///
+/// Hardware decoders are preferred (VA-API, NVIDIA, V4L2 stateless then stateful), then the software decoders. Any
+/// other H.264 decoder in the registry is tried last, highest rank first. Each candidate is probed by taking it to
+/// READY, which opens the device, so a decoder that is installed but has no hardware behind it is skipped.
+///
+class DecoderSelector {
+ public:
+  ///
+  /// \brief Construct a new Decoder Selector object
+  ///
+  /// \param preferred "auto" to rank the decoders, or a factory name to only try that decoder
+  /// \param threads Threads for software decoders, 0 for one per core
+  ///
+  explicit DecoderSelector(const std::string &preferred, int threads = 0);
+
+  ///
+  /// \brief Create the next usable decoder
+  ///
+  /// \return GstElement* A floating reference to the decoder in the NULL state, nullptr if there are none left
+  ///
+  GstElement *Next();
+
+  ///
+  /// \brief The factory name of the decoder last returned by Next()
+  ///
+  /// \return const std::string& The factory name
+  ///
+  const std::string &Name() const { return name_; }
+
+  ///
+  /// \brief The factory names in the order they will be tried
+  ///
+  /// \return const std::vector<std::string>& The candidates
+  ///
+  const std::vector<std::string> &Candidates() const { return candidates_; }
+
+ private:
+  /// \brief Factory names in the order they will be tried
+  std::vector<std::string> candidates_;
+  /// \brief Index of the next candidate
+  size_t next_ = 0;
+  /// \brief Threads for software decoders
+  int threads_;
+  /// \brief The decoder last returned
+  std::string name_;
+};
+
+///
+/// \brief Counts decoded frames on the decoder source pad and logs the throughput periodically
+///
+class DecodeThroughput {
+ public:
+  ///
+  /// \brief Construct a new Decode Throughput object
+  ///
+  /// \param name The decoder name used in the log
+  /// \param interval_seconds Seconds between log lines
+  ///
+  explicit DecodeThroughput(std::string name, int interval_seconds = 5);
+
+  ///
+  /// \brief Start counting frames leaving a decoder
+  ///
+  /// \param decoder The decoder, the object must outlive it
+  ///
+  void Attach(GstElement *decoder);
+
+  ///
+  /// \brief Frames decoded so far
+  ///
+  /// \return uint64_t The frame count
+  ///
+  uint64_t Frames() const { return frames_; }
+
+ private:
+  ///
+  /// \brief Pad probe counting buffers
+  ///
+  /// \param pad The decoder source pad
+  /// \param info The probe info
+  /// \param user_data This object
+  /// \return GstPadProbeReturn Always GST_PAD_PROBE_OK
+  ///
+  static GstPadProbeReturn Count(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+
+  /// \brief The decoder name
+  std::string name_;
+  /// \brief Microseconds between log lines
+  gint64 interval_;
+  /// \brief Frames decoded so far
+  std::atomic<uint64_t> frames_{0};
+  /// \brief Frame count at the last log line
+  uint64_t logged_frames_ = 0;
+  /// \brief Monotonic time of the last log line, zero before the first frame
+  gint64 logged_time_ = 0;
+};
+
+#endif  // GST_TANK_OVERLAY_DECODER_SELECT_H_
@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Typed live data sources that HUD primitives bind to
+///
+/// \file hud_data_source.cc
+///
+
+#include "hud_data_source.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef ZENOH_SUPPORTED
+#include <optional>
+#include <zenoh/zenoh.hpp>
+#endif
+
+std::string FormatHudValue(const HudValue &value, int precision) {
+  char text[64];
+
+  if (std::holds_alternative<int64_t>(value)) {
+    snprintf(text, sizeof(text), "%lld", static_cast<long long>(std::get<int64_t>(value)));
+  } else if (std::holds_alternative<double>(value)) {
+    snprintf(text, sizeof(text), "%.*f", precision, std::get<double>(value));
+  } else {
+    return std::get<std::string>(value);
+  }
+  return text;
+}
+
+HudValueType ParseHudValueType(const std::string &name) {
+  if (name == "int") return HudValueType::kInteger;
+  if (name == "double") return HudValueType::kReal;
+  if (name == "string") return HudValueType::kText;
+  throw std::runtime_error("Unknown HUD value type: " + name);
+}
+
+void HudValueStore::Set(const std::string &name, const HudValue &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = values_.find(name);
+  if (it != values_.end() && it->second == value) return;
+  values_[name] = value;
+  if (std::find(changed_.begin(), changed_.end(), name) == changed_.end()) changed_.push_back(name);
+}
+
+std::map<std::string, HudValue> HudValueStore::TakeChanged() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::map<std::string, HudValue> changed;
+  for (const auto &name : changed_) changed[name] = values_[name];
+  changed_.clear();
+  return changed;
+}
+
+// HudValue alternatives are declared in HudValueType order
+HudConstantSource::HudConstantSource(const std::string &name, HudValue value)
+    : HudDataSource(name, static_cast<HudValueType>(value.index())), value_(std::move(value)) {}
+
+void HudConstantSource::Start(HudValueStore *store) { store->Set(name_, value_); }
+
+HudClockSource::HudClockSource(const std::string &name, std::string format)
+    : HudDataSource(name, HudValueType::kText), format_(std::move(format)) {}
+
+void HudClockSource::Start(HudValueStore *store) { Poll(store); }
+
+void HudClockSource::Poll(HudValueStore *store) {
+  time_t now = time(NULL);
+
+  // Only format the time once a second
+  if (now == last_second_) return;
+  last_second_ = now;
+
+  struct tm tm;
+  localtime_r(&now, &tm);
+  char text[64];
+  strftime(text, sizeof(text), format_.c_str(), &tm);
+  store->Set(name_, std::string(text));
+}
+
+#ifdef ZENOH_SUPPORTED
+struct HudZenohSource::Subscription {
+  /// \brief The zenoh session
+  zenoh::Session session;
+  /// \brief The subscriber, declared once the session is open
+  std::optional<zenoh::Subscriber<void>> subscriber;
+};
+
+HudZenohSource::HudZenohSource(const std::string &name, HudValueType type, std::string key)
+    : HudDataSource(name, type), key_(std::move(key)) {}
+
+HudZenohSource::~HudZenohSource() = default;
+
+void HudZenohSource::Start(HudValueStore *store) {
+  subscription_ = std::make_unique<Subscription>(Subscription{zenoh::Session::open(zenoh::Config::create_default())});
+
+  std::string name = name_;
+  HudValueType type = type_;
+  subscription_->subscriber.emplace(subscription_->session.declare_subscriber(
+      zenoh::KeyExpr(key_),
+      [store, name, type](const zenoh::Sample &sample) {
+        std::string text = sample.get_payload().as_string();
+        try {
+          switch (type) {
+            case HudValueType::kInteger:
+              store->Set(name, static_cast<int64_t>(std::stoll(text)));
+              break;
+            case HudValueType::kReal:
+              store->Set(name, std::stod(text));
+              break;
+            case HudValueType::kText:
+              store->Set(name, text);
+              break;
+          }
+        } catch (const std::exception &e) {
+          std::cerr << "HUD source " << name << " could not parse '" << text << "'\n";
+        }
+      },
+      zenoh::closures::none));
+}
+#endif
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Typed live data sources that HUD primitives bind to
+///
+/// \file hud_data_source.h
+///
+
+#ifndef GST_TANK_OVERLAY_HUD_DATA_SOURCE_H_
+#define GST_TANK_OVERLAY_HUD_DATA_SOURCE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/// \brief The type of a HUD value
+enum class HudValueType { kInteger, kReal, kText };
+
+/// \brief A typed HUD value
+using HudValue = std::variant<int64_t, double, std::string>;
+
+///
+/// \brief Format a value for display
+///
+/// \param value The value
+/// \param precision Number of decimal places for real values
+/// \return std::string The formatted value
+///
+std::string FormatHudValue(const HudValue &value, int precision);
+
+///
+/// \brief Parse a HUD value type name ("int", "double" or "string")
+///
+/// \param name The type name
+/// \return HudValueType The type, throws std::runtime_error if unknown
+///
+HudValueType ParseHudValueType(const std::string &name);
+
+///
+/// \brief Thread safe store of the latest value of every data source
+///
+/// Sources write from their own threads, the overlay reads on the streaming thread and only picks up values that have
+/// changed since it last looked.
+///
+class HudValueStore {
+ public:
+  ///
+  /// \brief Set a value
+  ///
+  /// \param name The source name
+  /// \param value The new value
+  ///
+  void Set(const std::string &name, const HudValue &value);
+
+  ///
+  /// \brief Collect the values that have changed since the last call
+  ///
+  /// \return std::map<std::string, HudValue> The changed values by source name
+  ///
+  std::map<std::string, HudValue> TakeChanged();
+
+ private:
+  /// \brief Protects values_ and changed_
+  std::mutex mutex_;
+  /// \brief The latest values by source name
+  std::map<std::string, HudValue> values_;
+  /// \brief Names of values changed since TakeChanged()
+  std::vector<std::string> changed_;
+};
+
+/// \brief A source of live HUD data
+class HudDataSource {
+ public:
+  ///
+  /// \brief Construct a new Hud Data Source object
+  ///
+  /// \param name The source name that primitives bind to
+  /// \param type The value type
+  ///
+  HudDataSource(std::string name, HudValueType type) : name_(std::move(name)), type_(type) {}
+
+  ///
+  /// \brief Destroy the Hud Data Source object
+  ///
+  ///
+  virtual ~HudDataSource() = default;
+
+  ///
+  /// \brief Start publishing values into the store
+  ///
+  /// \param store The value store
+  ///
+  virtual void Start(HudValueStore *store) = 0;
+
+  ///
+  /// \brief Called once per video frame on the streaming thread, for sources that are polled
+  ///
+  /// \param store The value store
+  ///
+  virtual void Poll(HudValueStore *store) {}
+
+  /// \brief The source name
+  const std::string &Name() const { return name_; }
+
+  /// \brief The value type
+  HudValueType Type() const { return type_; }
+
+ protected:
+  /// \brief The source name
+  std::string name_;
+  /// \brief The value type
+  HudValueType type_;
+};
+
+/// \brief A fixed value, set once from the layout
+class HudConstantSource : public HudDataSource {
+ public:
+  ///
+  /// \brief Construct a new Hud Constant Source object
+  ///
+  /// \param name The source name
+  /// \param value The value
+  ///
+  HudConstantSource(const std::string &name, HudValue value);
+
+  void Start(HudValueStore *store) final;
+
+ private:
+  /// \brief The value
+  HudValue value_;
+};
+
+/// \brief The local time of day, formatted with strftime
+class HudClockSource : public HudDataSource {
+ public:
+  ///
+  /// \brief Construct a new Hud Clock Source object
+  ///
+  /// \param name The source name
+  /// \param format The strftime format
+  ///
+  HudClockSource(const std::string &name, std::string format);
+
+  void Start(HudValueStore *store) final;
+  void Poll(HudValueStore *store) final;
+
+ private:
+  /// \brief The strftime format
+  std::string format_;
+  /// \brief The second last published
+  int64_t last_second_ = -1;
+};
+
+#ifdef ZENOH_SUPPORTED
+/// \brief A value received as text on a zenoh key expression
+class HudZenohSource : public HudDataSource {
+ public:
+  ///
+  /// \brief Construct a new Hud Zenoh Source object
+  ///
+  /// \param name The source name
+  /// \param type The value type the payload is parsed as
+  /// \param key The zenoh key expression to subscribe to
+  ///
+  HudZenohSource(const std::string &name, HudValueType type, std::string key);
+
+  ///
+  /// \brief Destroy the Hud Zenoh Source object
+  ///
+  ///
+  ~HudZenohSource();
+
+  void Start(HudValueStore *store) final;
+
+ private:
+  /// \brief The zenoh key expression
+  std::string key_;
+  /// \brief The zenoh session and subscriber, opaque so zenoh is not needed by includers
+  struct Subscription;
+  /// \brief The active subscription
+  std::unique_ptr<Subscription> subscription_;
+};
+#endif
+
+#endif  // GST_TANK_OVERLAY_HUD_DATA_SOURCE_H_
@@ -0,0 +1,329 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Declarative HUD layout, compiled from JSON into a display list
+///
+/// \file hud_layout.cc
+///
+
+#include "hud_layout.h"
+
+#include <json-glib/json-glib.h>
+#include <math.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Parse a two element [x, y] array
+std::pair<double, double> ParsePoint(JsonArray *array, const std::string &what) {
+  if (!array || json_array_get_length(array) != 2) {
+    throw std::runtime_error("HUD layout: " + what + " must be an [x, y] pair");
+  }
+  return {json_array_get_double_element(array, 0), json_array_get_double_element(array, 1)};
+}
+
+// Parse an optional [x, y] member
+std::pair<double, double> ParsePointMember(JsonObject *object, const char *member,
+                                           std::pair<double, double> fallback) {
+  if (!json_object_has_member(object, member)) return fallback;
+  return ParsePoint(json_object_get_array_member(object, member), member);
+}
+
+// Parse the style members of a primitive, falling back to the layout defaults
+HudStyle ParseStyle(JsonObject *object, const HudStyle &defaults) {
+  HudStyle style = defaults;
+
+  if (json_object_has_member(object, "colour")) {
+    JsonArray *colour = json_object_get_array_member(object, "colour");
+    guint length = colour ? json_array_get_length(colour) : 0;
+    if (length != 3 && length != 4) throw std::runtime_error("HUD layout: colour must be [r, g, b] or [r, g, b, a]");
+    for (guint i = 0; i < length; i++) style.colour[i] = json_array_get_double_element(colour, i);
+    if (length == 3) style.colour[3] = 1.0;
+  }
+  style.line_width = json_object_get_double_member_with_default(object, "line_width", style.line_width);
+  style.font = json_object_get_string_member_with_default(object, "font", style.font.c_str());
+  style.font_size = json_object_get_double_member_with_default(object, "font_size", style.font_size);
+  style.bold = json_object_get_boolean_member_with_default(object, "bold", style.bold);
+  return style;
+}
+
+// Parse a single display list entry
+HudPrimitive ParsePrimitive(JsonObject *object, const HudStyle &defaults) {
+  HudPrimitive primitive;
+  std::string type = json_object_get_string_member_with_default(object, "type", "");
+
+  primitive.style = ParseStyle(object, defaults);
+  primitive.bind = json_object_get_string_member_with_default(object, "bind", "");
+  primitive.precision = json_object_get_int_member_with_default(object, "precision", 0);
+
+  if (type == "line") {
+    primitive.type = HudPrimitiveType::kLine;
+    JsonArray *points = json_object_get_array_member(object, "points");
+    if (!points || json_array_get_length(points) < 2) {
+      throw std::runtime_error("HUD layout: line needs at least two points");
+    }
+    for (guint i = 0; i < json_array_get_length(points); i++) {
+      primitive.points.push_back(ParsePoint(json_array_get_array_element(points, i), "line point"));
+    }
+    primitive.closed = json_object_get_boolean_member_with_default(object, "closed", FALSE);
+  } else if (type == "circle") {
+    primitive.type = HudPrimitiveType::kCircle;
+    primitive.points.push_back(ParsePointMember(object, "centre", {0, 0}));
+    primitive.radius = json_object_get_double_member_with_default(object, "radius", 0);
+    primitive.fill = json_object_get_boolean_member_with_default(object, "fill", FALSE);
+    if (primitive.radius <= 0) throw std::runtime_error("HUD layout: circle needs a positive radius");
+  } else if (type == "text") {
+    primitive.type = HudPrimitiveType::kText;
+    primitive.points.push_back(ParsePointMember(object, "position", {0, 0}));
+    primitive.text = json_object_get_string_member_with_default(object, "text", primitive.bind.empty() ? "" : "{}");
+  } else if (type == "ticks") {
+    primitive.type = HudPrimitiveType::kTicks;
+    primitive.points.push_back(ParsePointMember(object, "start", {0, 0}));
+    primitive.tick_count = json_object_get_int_member_with_default(object, "count", 0);
+    primitive.tick_spacing = json_object_get_double_member_with_default(object, "spacing", 10);
+    primitive.tick_length = json_object_get_double_member_with_default(object, "length", 5);
+    primitive.major_extra = json_object_get_double_member_with_default(object, "major_extra", 0);
+    primitive.major_every = json_object_get_int_member_with_default(object, "major_every", 0);
+    primitive.major_phase = json_object_get_int_member_with_default(object, "major_phase", 0);
+    primitive.label_offset = ParsePointMember(object, "label_offset", {0, 0});
+    if (json_object_has_member(object, "labels")) {
+      JsonArray *labels = json_object_get_array_member(object, "labels");
+      for (guint i = 0; labels && i < json_array_get_length(labels); i++) {
+        primitive.labels.push_back(json_array_get_string_element(labels, i));
+      }
+    }
+    if (primitive.tick_count <= 0) throw std::runtime_error("HUD layout: ticks needs a positive count");
+  } else {
+    throw std::runtime_error("HUD layout: unknown primitive type '" + type + "'");
+  }
+
+  if (!primitive.bind.empty() && primitive.type != HudPrimitiveType::kText) {
+    throw std::runtime_error("HUD layout: only text primitives can be bound to a data source");
+  }
+  return primitive;
+}
+
+// Parse a data source declaration
+std::unique_ptr<HudDataSource> ParseSource(JsonObject *object) {
+  std::string name = json_object_get_string_member_with_default(object, "name", "");
+  std::string type = json_object_get_string_member_with_default(object, "type", "");
+
+  if (name.empty()) throw std::runtime_error("HUD layout: data source without a name");
+
+  if (type == "clock") {
+    return std::make_unique<HudClockSource>(name,
+                                            json_object_get_string_member_with_default(object, "format", "%H:%M:%S"));
+  }
+
+  HudValueType value_type =
+      ParseHudValueType(json_object_get_string_member_with_default(object, "value_type", "string"));
+  if (type == "constant") {
+    if (!json_object_has_member(object, "value")) {
+      throw std::runtime_error("HUD layout: constant '" + name + "' has no value");
+    }
+    switch (value_type) {
+      case HudValueType::kInteger:
+        return std::make_unique<HudConstantSource>(name,
+                                                   static_cast<int64_t>(json_object_get_int_member(object, "value")));
+      case HudValueType::kReal:
+        return std::make_unique<HudConstantSource>(name, json_object_get_double_member(object, "value"));
+      case HudValueType::kText:
+        return std::make_unique<HudConstantSource>(name, std::string(json_object_get_string_member(object, "value")));
+    }
+  }
+  if (type == "zenoh") {
+#ifdef ZENOH_SUPPORTED
+    return std::make_unique<HudZenohSource>(name, value_type,
+                                            json_object_get_string_member_with_default(object, "key", ""));
+#else
+    throw std::runtime_error("HUD layout: source '" + name + "' needs zenoh, rebuild with zenoh installed");
+#endif
+  }
+  throw std::runtime_error("HUD layout: unknown data source type '" + type + "'");
+}
+
+}  // namespace
+
+void HudLayout::Load(const std::string &path) {
+  GError *error = NULL;
+  JsonParser *parser = json_parser_new();
+
+  if (!json_parser_load_from_file(parser, path.c_str(), &error)) {
+    std::string message = "HUD layout: cannot load " + path + ": " + error->message;
+    g_error_free(error);
+    g_object_unref(parser);
+    throw std::runtime_error(message);
+  }
+
+  JsonNode *root_node = json_parser_get_root(parser);
+  if (!root_node || !JSON_NODE_HOLDS_OBJECT(root_node)) {
+    g_object_unref(parser);
+    throw std::runtime_error("HUD layout: " + path + " is not a JSON object");
+  }
+  JsonObject *root = json_node_get_object(root_node);
+
+  try {
+    primitives_.clear();
+    sources_.clear();
+    precision_.clear();
+
+    // Layout origin, as a fraction of the video size plus a pixel offset
+    if (json_object_has_member(root, "origin")) {
+      JsonObject *origin = json_object_get_object_member(root, "origin");
+      origin_x_ = json_object_get_double_member_with_default(origin, "x", 0.5);
+      origin_y_ = json_object_get_double_member_with_default(origin, "y", 0.5);
+      origin_offset_ = ParsePointMember(origin, "offset", {0, 0});
+    }
+
+    HudStyle defaults = {{1.0, 1.0, 1.0, 1.0}, 1.0, "", 14.0, false};
+    if (json_object_has_member(root, "defaults")) {
+      defaults = ParseStyle(json_object_get_object_member(root, "defaults"), defaults);
+    }
+
+    if (json_object_has_member(root, "sources")) {
+      JsonArray *sources = json_object_get_array_member(root, "sources");
+      for (guint i = 0; sources && i < json_array_get_length(sources); i++) {
+        sources_.push_back(ParseSource(json_array_get_object_element(sources, i)));
+      }
+    }
+
+    JsonArray *primitives = json_object_get_array_member(root, "primitives");
+    for (guint i = 0; primitives && i < json_array_get_length(primitives); i++) {
+      HudPrimitive primitive = ParsePrimitive(json_array_get_object_element(primitives, i), defaults);
+
+      if (!primitive.bind.empty()) {
+        auto source = std::find_if(sources_.begin(), sources_.end(),
+                                   [&primitive](const auto &s) { return s->Name() == primitive.bind; });
+        if (source == sources_.end()) {
+          throw std::runtime_error("HUD layout: primitive bound to unknown source '" + primitive.bind + "'");
+        }
+        precision_[primitive.bind] = std::max(precision_[primitive.bind], primitive.precision);
+      }
+      primitives_.push_back(std::move(primitive));
+    }
+  } catch (...) {
+    g_object_unref(parser);
+    throw;
+  }
+
+  g_object_unref(parser);
+}
+
+void HudLayout::Install(OverlayCompositor *overlay) {
+  overlay->AddStaticLayer("hud", [this](cairo_t *cr, int width, int height, const std::string &) {
+    Draw(cr, width, height, "");
+  });
+
+  // One dynamic layer per bound source, so a change only redraws the primitives that show it
+  for (const auto &source : sources_) {
+    std::string name = source->Name();
+    if (precision_.find(name) == precision_.end()) continue;
+    overlay->AddDynamicLayer(name, [this, name](cairo_t *cr, int width, int height, const std::string &) {
+      Draw(cr, width, height, name);
+    });
+  }
+}
+
+void HudLayout::Start() {
+  for (auto &source : sources_) source->Start(&store_);
+}
+
+void HudLayout::Update(OverlayCompositor *overlay) {
+  for (auto &source : sources_) source->Poll(&store_);
+
+  for (auto &[name, value] : store_.TakeChanged()) {
+    auto precision = precision_.find(name);
+    if (precision == precision_.end()) continue;
+    values_[name] = value;
+
+    // The compositor only redraws the layer if the displayed text actually changed
+    overlay->SetValue(name, FormatHudValue(value, precision->second));
+  }
+}
+
+void HudLayout::Draw(cairo_t *cr, int width, int height, const std::string &bind) {
+  cairo_translate(cr, width * origin_x_ + origin_offset_.first, height * origin_y_ + origin_offset_.second);
+
+  for (const auto &primitive : primitives_) {
+    if (primitive.bind != bind) continue;
+    cairo_save(cr);
+    DrawPrimitive(cr, primitive);
+    cairo_restore(cr);
+  }
+}
+
+void HudLayout::DrawPrimitive(cairo_t *cr, const HudPrimitive &primitive) {
+  const HudStyle &style = primitive.style;
+
+  cairo_set_source_rgba(cr, style.colour[0], style.colour[1], style.colour[2], style.colour[3]);
+  cairo_set_line_width(cr, style.line_width);
+  if (!style.font.empty()) {
+    cairo_select_font_face(cr, style.font.c_str(), CAIRO_FONT_SLANT_NORMAL,
+                           style.bold ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
+  }
+  cairo_set_font_size(cr, style.font_size);
+
+  switch (primitive.type) {
+    case HudPrimitiveType::kLine:
+      cairo_move_to(cr, primitive.points[0].first, primitive.points[0].second);
+      for (size_t i = 1; i < primitive.points.size(); i++) {
+        cairo_line_to(cr, primitive.points[i].first, primitive.points[i].second);
+      }
+      if (primitive.closed) cairo_close_path(cr);
+      if (primitive.fill) {
+        cairo_fill(cr);
+      } else {
+        cairo_stroke(cr);
+      }
+      break;
+
+    case HudPrimitiveType::kCircle:
+      cairo_arc(cr, primitive.points[0].first, primitive.points[0].second, primitive.radius, 0, 2 * M_PI);
+      if (primitive.fill) {
+        cairo_fill(cr);
+      } else {
+        cairo_stroke(cr);
+      }
+      break;
+
+    case HudPrimitiveType::kText: {
+      std::string text = primitive.text;
+      size_t placeholder = text.find("{}");
+      if (placeholder != std::string::npos) {
+        auto value = values_.find(primitive.bind);
+        std::string formatted = value != values_.end() ? FormatHudValue(value->second, primitive.precision) : "";
+        text.replace(placeholder, 2, formatted);
+      }
+      cairo_move_to(cr, primitive.points[0].first, primitive.points[0].second);
+      cairo_show_text(cr, text.c_str());
+    } break;
+
+    case HudPrimitiveType::kTicks: {
+      double x0 = primitive.points[0].first;
+      double y0 = primitive.points[0].second;
+      size_t label = 0;
+
+      for (int i = 0; i < primitive.tick_count; i++) {
+        double x = x0 + i * primitive.tick_spacing;
+        bool major = primitive.major_every > 0 && ((i - primitive.major_phase) % primitive.major_every) == 0;
+        cairo_move_to(cr, x, y0);
+        cairo_line_to(cr, x, y0 + primitive.tick_length + (major ? primitive.major_extra : 0));
+      }
+      cairo_stroke(cr);
+
+      for (int i = 0; i < primitive.tick_count && label < primitive.labels.size(); i++) {
+        if (primitive.major_every <= 0 || ((i - primitive.major_phase) % primitive.major_every) != 0) continue;
+        double x = x0 + i * primitive.tick_spacing;
+        cairo_move_to(cr, x + primitive.label_offset.first, y0 + primitive.label_offset.second);
+        cairo_show_text(cr, primitive.labels[label++].c_str());
+      }
+    } break;
+  }
+}
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Declarative HUD layout, compiled from JSON into a display list
+///
+/// \file hud_layout.h
+///
+
+#ifndef GST_TANK_OVERLAY_HUD_LAYOUT_H_
+#define GST_TANK_OVERLAY_HUD_LAYOUT_H_
+
+#include <cairo.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hud_data_source.h"
+#include "overlay_layers.h"
+
+/// \brief The kind of a display list primitive
+enum class HudPrimitiveType { kLine, kCircle, kText, kTicks };
+
+/// \brief How a primitive is drawn
+struct HudStyle {
+  /// \brief Red, green, blue and alpha, 0.0 to 1.0
+  double colour[4];
+  /// \brief Stroke width in pixels
+  double line_width;
+  /// \brief Font face, empty for the cairo default
+  std::string font;
+  /// \brief Font size in pixels
+  double font_size;
+  /// \brief Bold font weight
+  bool bold;
+};
+
+/// \brief A single entry in the display list
+struct HudPrimitive {
+  /// \brief The kind of primitive
+  HudPrimitiveType type;
+  /// \brief How it is drawn
+  HudStyle style;
+  /// \brief Polyline vertices, circle centre, text position or first tick, relative to the layout origin
+  std::vector<std::pair<double, double>> points;
+  /// \brief Close the polyline
+  bool closed = false;
+  /// \brief Fill rather than stroke
+  bool fill = false;
+  /// \brief Circle radius
+  double radius = 0;
+  /// \brief Text, "{}" is replaced by the bound value
+  std::string text;
+  /// \brief Name of the data source this primitive is bound to, empty if static
+  std::string bind;
+  /// \brief Decimal places for real values
+  int precision = 0;
+  /// \brief Number of ticks
+  int tick_count = 0;
+  /// \brief Horizontal distance between ticks
+  double tick_spacing = 0;
+  /// \brief Minor tick length
+  double tick_length = 0;
+  /// \brief Extra length of a major tick
+  double major_extra = 0;
+  /// \brief Every Nth tick is a major tick
+  int major_every = 0;
+  /// \brief Index of the first major tick
+  int major_phase = 0;
+  /// \brief Labels drawn at successive major ticks
+  std::vector<std::string> labels;
+  /// \brief Label offset from the top of a major tick
+  std::pair<double, double> label_offset = {0, 0};
+};
+
+///
+/// \brief A HUD layout loaded from a JSON description
+///
+/// The layout is compiled once into a display list. Unbound primitives are rasterised into a single static layer,
+/// primitives bound to a data source are grouped into one dynamic layer per source so only they are redrawn when the
+/// value changes. The compositor then tracks the damaged regions.
+///
+class HudLayout {
+ public:
+  ///
+  /// \brief Construct a new Hud Layout object
+  ///
+  ///
+  HudLayout() = default;
+
+  ///
+  /// \brief Construct a new Hud Layout object (deleted)
+  ///
+  ///
+  HudLayout(const HudLayout &) = delete;
+
+  ///
+  /// \brief Delete the copy operator
+  ///
+  /// \return HudLayout&
+  ///
+  HudLayout &operator=(const HudLayout &) = delete;
+
+  ///
+  /// \brief Load and compile a layout, throws std::runtime_error if the description is invalid
+  ///
+  /// \param path Path to the JSON layout
+  ///
+  void Load(const std::string &path);
+
+  ///
+  /// \brief Register the layout layers with a compositor
+  ///
+  /// \param overlay The compositor
+  ///
+  void Install(OverlayCompositor *overlay);
+
+  ///
+  /// \brief Start all data sources
+  ///
+  ///
+  void Start();
+
+  ///
+  /// \brief Poll the data sources and push any changed values into the compositor, called once per frame
+  ///
+  /// \param overlay The compositor
+  ///
+  void Update(OverlayCompositor *overlay);
+
+  ///
+  /// \brief Number of primitives in the display list
+  ///
+  /// \return size_t The display list size
+  ///
+  size_t Size() const { return primitives_.size(); }
+
+ private:
+  ///
+  /// \brief Draw every primitive bound to a source, or every unbound primitive if bind is empty
+  ///
+  /// \param cr The cairo context
+  /// \param width The overlay width
+  /// \param height The overlay height
+  /// \param bind The data source name
+  ///
+  void Draw(cairo_t *cr, int width, int height, const std::string &bind);
+
+  ///
+  /// \brief Draw a single primitive
+  ///
+  /// \param cr The cairo context, origin already moved to the layout origin
+  /// \param primitive The primitive
+  ///
+  void DrawPrimitive(cairo_t *cr, const HudPrimitive &primitive);
+
+  /// \brief Origin as a fraction of the overlay width
+  double origin_x_ = 0.5;
+  /// \brief Origin as a fraction of the overlay height
+  double origin_y_ = 0.5;
+  /// \brief Origin offset in pixels
+  std::pair<double, double> origin_offset_ = {0, 0};
+  /// \brief The compiled display list
+  std::vector<HudPrimitive> primitives_;
+  /// \brief The data sources
+  std::vector<std::unique_ptr<HudDataSource>> sources_;
+  /// \brief Latest values from the data sources
+  HudValueStore store_;
+  /// \brief The values currently drawn, by source name
+  std::map<std::string, HudValue> values_;
+  /// \brief Decimal places needed by the bound sources, only sources that are drawn appear here
+  std::map<std::string, int> precision_;
+};
+
+#endif  // GST_TANK_OVERLAY_HUD_LAYOUT_H_
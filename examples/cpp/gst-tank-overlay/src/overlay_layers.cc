@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Cached, pre-rasterised HUD overlay layers
+///
+/// \file overlay_layers.cc
+///
+
+#include "overlay_layers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+OverlayRect OverlayRect::Union(const OverlayRect &other) const {
+  if (Empty()) return other;
+  if (other.Empty()) return *this;
+  int x0 = std::min(x, other.x);
+  int y0 = std::min(y, other.y);
+  int x1 = std::max(x + width, other.x + other.width);
+  int y1 = std::max(y + height, other.y + other.height);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+OverlayRect OverlayRect::Clip(int max_width, int max_height) const {
+  int x0 = std::max(x, 0);
+  int y0 = std::max(y, 0);
+  int x1 = std::min(x + width, max_width);
+  int y1 = std::min(y + height, max_height);
+  if (x1 <= x0 || y1 <= y0) return {0, 0, 0, 0};
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+OverlayLayer::OverlayLayer(std::string name, DrawFunction draw, bool dynamic)
+    : name_(std::move(name)), draw_(std::move(draw)), dynamic_(dynamic) {}
+
+OverlayLayer::~OverlayLayer() {
+  if (surface_) cairo_surface_destroy(surface_);
+}
+
+OverlayRect OverlayLayer::Rasterise(int width, int height) {
+  OverlayRect damage = {0, 0, width, height};
+
+  // Reallocate only if the size has changed
+  if (surface_ && (cairo_image_surface_get_width(surface_) != width ||
+                   cairo_image_surface_get_height(surface_) != height)) {
+    cairo_surface_destroy(surface_);
+    surface_ = nullptr;
+  }
+  if (!surface_) {
+    surface_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    extents_ = {0, 0, width, height};
+  }
+
+  // Record the drawing so the ink extents are known before touching the surface
+  cairo_surface_t *recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+  cairo_t *rcr = cairo_create(recording);
+  draw_(rcr, width, height, value_);
+  cairo_destroy(rcr);
+
+  double ink_x, ink_y, ink_width, ink_height;
+  cairo_recording_surface_ink_extents(recording, &ink_x, &ink_y, &ink_width, &ink_height);
+  // Round out to whole pixels, anti-aliasing can touch one pixel either side
+  OverlayRect extents = {static_cast<int>(std::floor(ink_x)) - 1, static_cast<int>(std::floor(ink_y)) - 1,
+                         static_cast<int>(std::ceil(ink_width)) + 2, static_cast<int>(std::ceil(ink_height)) + 2};
+  extents = (ink_width > 0 && ink_height > 0) ? extents.Clip(width, height) : OverlayRect{0, 0, 0, 0};
+  if (dynamic_) damage = extents_.Union(extents).Clip(width, height);
+  extents_ = extents;
+
+  cairo_t *cr = cairo_create(surface_);
+  cairo_rectangle(cr, damage.x, damage.y, damage.width, damage.height);
+  cairo_clip(cr);
+
+  // Clear to fully transparent
+  cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+  cairo_set_source_surface(cr, recording, 0, 0);
+  cairo_paint(cr);
+
+  cairo_destroy(cr);
+  cairo_surface_destroy(recording);
+  cairo_surface_flush(surface_);
+
+  return damage;
+}
+
+bool OverlayLayer::SetValue(const std::string &value) {
+  if (value == value_) return false;
+  value_ = value;
+  return true;
+}
+
+OverlayCompositor::~OverlayCompositor() {
+  if (background_) cairo_surface_destroy(background_);
+  if (composite_) cairo_surface_destroy(composite_);
+}
+
+void OverlayCompositor::AddStaticLayer(const std::string &name, OverlayLayer::DrawFunction draw) {
+  layers_.push_back(std::make_unique<OverlayLayer>(name, std::move(draw), false));
+  // Force the background to be flattened again on the next resize
+  width_ = 0;
+  height_ = 0;
+}
+
+void OverlayCompositor::AddDynamicLayer(const std::string &name, OverlayLayer::DrawFunction draw) {
+  layers_.push_back(std::make_unique<OverlayLayer>(name, std::move(draw), true));
+  width_ = 0;
+  height_ = 0;
+}
+
+void OverlayCompositor::Resize(int width, int height) {
+  if (width == width_ && height == height_) return;
+  width_ = width;
+  height_ = height;
+
+  if (background_) cairo_surface_destroy(background_);
+  if (composite_) cairo_surface_destroy(composite_);
+  background_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width_, height_);
+  composite_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width_, height_);
+
+  for (auto &layer : layers_) layer->Rasterise(width_, height_);
+  FlattenStatic();
+  damage_.assign(1, {0, 0, width_, height_});
+}
+
+void OverlayCompositor::SetValue(const std::string &name, const std::string &value) {
+  for (auto &layer : layers_) {
+    if (layer->Dynamic() && layer->Name() == name && layer->SetValue(value)) {
+      // Layers are rasterised lazily until the overlay has a size
+      if (!width_ || !height_) continue;
+      OverlayRect damage = layer->Rasterise(width_, height_);
+      if (!damage.Empty()) damage_.push_back(damage);
+    }
+  }
+}
+
+void OverlayCompositor::FlattenStatic() {
+  cairo_t *cr = cairo_create(background_);
+  cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+  for (auto &layer : layers_) {
+    if (layer->Dynamic()) continue;
+    cairo_set_source_surface(cr, layer->Surface(), 0, 0);
+    cairo_paint(cr);
+  }
+  cairo_destroy(cr);
+  cairo_surface_flush(background_);
+}
+
+void OverlayCompositor::Compose() {
+  cairo_t *cr = cairo_create(composite_);
+
+  for (const auto &rect : damage_) {
+    cairo_save(cr);
+    cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+    cairo_clip(cr);
+
+    // Start from the flattened static layers, then put the dynamic layers on top
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, background_, 0, 0);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    for (auto &layer : layers_) {
+      if (!layer->Dynamic()) continue;
+      cairo_set_source_surface(cr, layer->Surface(), 0, 0);
+      cairo_paint(cr);
+    }
+    cairo_restore(cr);
+  }
+  cairo_destroy(cr);
+  cairo_surface_flush(composite_);
+
+  last_damage_.swap(damage_);
+  damage_.clear();
+  version_++;
+}
+
+cairo_surface_t *OverlayCompositor::Surface() {
+  if (!composite_) return nullptr;
+  if (!damage_.empty()) Compose();
+  return composite_;
+}
+
+void OverlayCompositor::Paint(cairo_t *cr) {
+  cairo_surface_t *surface = Surface();
+  if (!surface) return;
+
+  cairo_save(cr);
+  cairo_identity_matrix(cr);
+  cairo_set_source_surface(cr, surface, 0, 0);
+  cairo_paint(cr);
+  cairo_restore(cr);
+}
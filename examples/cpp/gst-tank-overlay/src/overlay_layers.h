@@ -0,0 +1,269 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Cached, pre-rasterised HUD overlay layers
+///
+/// \file overlay_layers.h
+///
+
+#ifndef GST_TANK_OVERLAY_OVERLAY_LAYERS_H_
+#define GST_TANK_OVERLAY_OVERLAY_LAYERS_H_
+
+#include <cairo.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// \brief A rectangle in overlay (device) coordinates
+struct OverlayRect {
+  /// \brief The left edge
+  int x;
+  /// \brief The top edge
+  int y;
+  /// \brief The width, zero if empty
+  int width;
+  /// \brief The height, zero if empty
+  int height;
+
+  ///
+  /// \brief Check if the rectangle covers no pixels
+  ///
+  /// \return true if empty
+  ///
+  bool Empty() const { return width <= 0 || height <= 0; }
+
+  ///
+  /// \brief The smallest rectangle containing both rectangles
+  ///
+  /// \param other The other rectangle
+  /// \return OverlayRect The union
+  ///
+  OverlayRect Union(const OverlayRect &other) const;
+
+  ///
+  /// \brief Clip the rectangle to the overlay size
+  ///
+  /// \param width The overlay width
+  /// \param height The overlay height
+  /// \return OverlayRect The clipped rectangle
+  ///
+  OverlayRect Clip(int width, int height) const;
+};
+
+/// \brief A single HUD layer rasterised into its own ARGB surface
+class OverlayLayer {
+ public:
+  ///
+  /// \brief The draw callback for a layer
+  ///
+  /// The context is cleared to transparent and the origin is the top-left of the overlay. Dynamic layers are passed
+  /// their current value, static layers an empty string.
+  ///
+  using DrawFunction = std::function<void(cairo_t *cr, int width, int height, const std::string &value)>;
+
+  ///
+  /// \brief Construct a new Overlay Layer object
+  ///
+  /// \param name The layer name, used to update dynamic values
+  /// \param draw The draw callback
+  /// \param dynamic True if the layer is redrawn when its value changes, false if it is rasterised once
+  ///
+  OverlayLayer(std::string name, DrawFunction draw, bool dynamic);
+
+  ///
+  /// \brief Destroy the Overlay Layer object
+  ///
+  ///
+  ~OverlayLayer();
+
+  ///
+  /// \brief Construct a new Overlay Layer object (deleted)
+  ///
+  ///
+  OverlayLayer(const OverlayLayer &) = delete;
+
+  ///
+  /// \brief Delete the copy operator
+  ///
+  /// \return OverlayLayer&
+  ///
+  OverlayLayer &operator=(const OverlayLayer &) = delete;
+
+  ///
+  /// \brief Rasterise the layer into its surface, (re)allocating it if the size has changed
+  ///
+  /// Dynamic layers are recorded first to find their ink extents, then only the area covered by the old and new
+  /// content is cleared and redrawn.
+  ///
+  /// \param width The overlay width
+  /// \param height The overlay height
+  /// \return OverlayRect The area of the surface that changed
+  ///
+  OverlayRect Rasterise(int width, int height);
+
+  ///
+  /// \brief Set the value of a dynamic layer
+  ///
+  /// \param value The new value
+  /// \return true if the value changed and the layer needs rasterising
+  ///
+  bool SetValue(const std::string &value);
+
+  /// \brief The layer name
+  const std::string &Name() const { return name_; }
+
+  /// \brief True if the layer is redrawn when its value changes
+  bool Dynamic() const { return dynamic_; }
+
+  /// \brief The rasterised surface, nullptr until the first Rasterise()
+  cairo_surface_t *Surface() const { return surface_; }
+
+ private:
+  /// \brief The layer name
+  std::string name_;
+  /// \brief The draw callback
+  DrawFunction draw_;
+  /// \brief True if the layer is redrawn when its value changes
+  bool dynamic_;
+  /// \brief The current value (dynamic layers only)
+  std::string value_;
+  /// \brief The rasterised ARGB surface
+  cairo_surface_t *surface_ = nullptr;
+  /// \brief The ink extents of the last rasterised content
+  OverlayRect extents_ = {0, 0, 0, 0};
+};
+
+///
+/// \brief Composes static and dynamic overlay layers into a single ARGB surface
+///
+/// Static layers are rasterised once per overlay size and flattened into a single background surface. Dynamic layers
+/// are only rasterised when their value changes. Only the damaged areas of the final composite are rebuilt, so each
+/// video frame costs one blit regardless of how complex the HUD is.
+///
+class OverlayCompositor {
+ public:
+  ///
+  /// \brief Construct a new Overlay Compositor object
+  ///
+  ///
+  OverlayCompositor() = default;
+
+  ///
+  /// \brief Destroy the Overlay Compositor object
+  ///
+  ///
+  ~OverlayCompositor();
+
+  ///
+  /// \brief Construct a new Overlay Compositor object (deleted)
+  ///
+  ///
+  OverlayCompositor(const OverlayCompositor &) = delete;
+
+  ///
+  /// \brief Delete the copy operator
+  ///
+  /// \return OverlayCompositor&
+  ///
+  OverlayCompositor &operator=(const OverlayCompositor &) = delete;
+
+  ///
+  /// \brief Add a layer that is rasterised once per overlay size
+  ///
+  /// \param name The layer name
+  /// \param draw The draw callback
+  ///
+  void AddStaticLayer(const std::string &name, OverlayLayer::DrawFunction draw);
+
+  ///
+  /// \brief Add a layer that is rasterised whenever its value changes
+  ///
+  /// \param name The layer name, used with SetValue()
+  /// \param draw The draw callback
+  ///
+  void AddDynamicLayer(const std::string &name, OverlayLayer::DrawFunction draw);
+
+  ///
+  /// \brief Set the overlay size, re-rasterising every layer if it changed
+  ///
+  /// \param width The overlay width
+  /// \param height The overlay height
+  ///
+  void Resize(int width, int height);
+
+  ///
+  /// \brief Update the value of a dynamic layer
+  ///
+  /// \param name The layer name
+  /// \param value The new value, the layer is only redrawn if this differs from the last value
+  ///
+  void SetValue(const std::string &name, const std::string &value);
+
+  ///
+  /// \brief Get the composite surface, recomposing it first if any layer changed
+  ///
+  /// \return cairo_surface_t* The ARGB32 (premultiplied) composite, nullptr before Resize()
+  ///
+  cairo_surface_t *Surface();
+
+  ///
+  /// \brief Blit the composite onto a cairo context
+  ///
+  /// \param cr The destination context, origin at the top-left of the video
+  ///
+  void Paint(cairo_t *cr);
+
+  ///
+  /// \brief The areas of the composite that changed in the last recompose
+  ///
+  /// \return const std::vector<OverlayRect>& The changed rectangles, the whole overlay after a resize
+  ///
+  const std::vector<OverlayRect> &Damage() const { return last_damage_; }
+
+  ///
+  /// \brief Incremented every time the composite changes
+  ///
+  /// \return uint64_t The composite version
+  ///
+  uint64_t Version() const { return version_; }
+
+ private:
+  ///
+  /// \brief Flatten all static layers into the background surface
+  ///
+  ///
+  void FlattenStatic();
+
+  ///
+  /// \brief Rebuild the damaged areas of the composite from the background and the dynamic layers
+  ///
+  ///
+  void Compose();
+
+  /// \brief All layers in draw order
+  std::vector<std::unique_ptr<OverlayLayer>> layers_;
+  /// \brief The flattened static layers
+  cairo_surface_t *background_ = nullptr;
+  /// \brief The final composite
+  cairo_surface_t *composite_ = nullptr;
+  /// \brief The overlay width
+  int width_ = 0;
+  /// \brief The overlay height
+  int height_ = 0;
+  /// \brief Areas of the composite waiting to be rebuilt
+  std::vector<OverlayRect> damage_;
+  /// \brief Areas of the composite rebuilt by the last Compose()
+  std::vector<OverlayRect> last_damage_;
+  /// \brief The composite version
+  uint64_t version_ = 0;
+};
+
+#endif  // GST_TANK_OVERLAY_OVERLAY_LAYERS_H_
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief RTP receive profiles trading latency against smoothness, and receive statistics
+///
+/// \file receive_profile.cc
+///
+
+#include "receive_profile.h"
+
+#include <gst/rtp/gstrtpbuffer.h>
+#include <stdio.h>
+
+#include <stdexcept>
+#include <utility>
+
+ReceiveProfile ParseReceiveProfile(const std::string &name) {
+  if (name == "ultra-low-latency") return ReceiveProfile::kUltraLowLatency;
+  if (name == "smooth") return ReceiveProfile::kSmooth;
+  if (name == "lossy-network") return ReceiveProfile::kLossyNetwork;
+  throw std::runtime_error("Unknown receive profile: " + name);
+}
+
+const char *ReceiveProfileName(ReceiveProfile profile) {
+  switch (profile) {
+    case ReceiveProfile::kUltraLowLatency:
+      return "ultra-low-latency";
+    case ReceiveProfile::kSmooth:
+      return "smooth";
+    case ReceiveProfile::kLossyNetwork:
+      return "lossy-network";
+  }
+  return "unknown";
+}
+
+ReceiveSettings DefaultReceiveSettings(ReceiveProfile profile) {
+  switch (profile) {
+    case ReceiveProfile::kUltraLowLatency:
+      // Straight from the socket to the decoder, a late frame is replaced by the next one
+      return {profile, false, 0, 512 * 1024, false, true, false, false};
+    case ReceiveProfile::kSmooth:
+      // Absorb network jitter and present frames evenly
+      return {profile, true, 100, 2 * 1024 * 1024, true, false, false, false};
+    case ReceiveProfile::kLossyNetwork:
+      // Enough latency for a retransmission round trip, and a large socket buffer for bursts
+      return {profile, true, 300, 8 * 1024 * 1024, true, false, true, true};
+  }
+  return DefaultReceiveSettings(ReceiveProfile::kUltraLowLatency);
+}
+
+RtpReceiveStats::RtpReceiveStats(std::string profile, int clock_rate, int interval_seconds)
+    : profile_(std::move(profile)),
+      clock_rate_(clock_rate),
+      interval_(static_cast<gint64>(interval_seconds) * G_USEC_PER_SEC) {}
+
+void RtpReceiveStats::Attach(GstElement *source, GstElement *jitter_buffer) {
+  jitter_buffer_ = jitter_buffer;
+
+  GstPad *pad = gst_element_get_static_pad(source, "src");
+  if (!pad) return;
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, Count, this, NULL);
+  gst_object_unref(pad);
+}
+
+int64_t RtpReceiveStats::Lost() const {
+  if (received_ == 0) return 0;
+  int64_t expected = (static_cast<int64_t>(cycles_) << 16) + max_seq_ - base_seq_ + 1;
+  return expected - static_cast<int64_t>(received_);
+}
+
+double RtpReceiveStats::JitterMs() const { return (jitter_ >> 4) * 1000.0 / clock_rate_; }
+
+GstPadProbeReturn RtpReceiveStats::Count(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+  RtpReceiveStats *self = static_cast<RtpReceiveStats *>(user_data);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  if (!gst_rtp_buffer_map(GST_PAD_PROBE_INFO_BUFFER(info), GST_MAP_READ, &rtp)) return GST_PAD_PROBE_OK;
+  uint16_t seq = gst_rtp_buffer_get_seq(&rtp);
+  uint32_t timestamp = gst_rtp_buffer_get_timestamp(&rtp);
+  gst_rtp_buffer_unmap(&rtp);
+
+  gint64 now = g_get_monotonic_time();
+  self->Packet(seq, timestamp, now);
+
+  if (now - self->logged_time_ >= self->interval_) {
+    if (self->logged_time_ != 0) self->Log();
+    self->logged_time_ = now;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void RtpReceiveStats::Packet(uint16_t seq, uint32_t timestamp, gint64 arrival) {
+  // Arrival time in RTP clock units, truncated to 32 bits like the timestamp so the transit wraps with it
+  uint32_t arrival_rtp = static_cast<uint32_t>(arrival * clock_rate_ / G_USEC_PER_SEC);
+
+  if (received_ == 0) {
+    base_seq_ = seq;
+    max_seq_ = seq;
+    transit_ = arrival_rtp - timestamp;
+    received_ = 1;
+    return;
+  }
+  received_++;
+
+  // Sequence numbers ahead of the highest, allowing for wrap around, extend the stream. Anything behind is reordered.
+  int16_t delta = static_cast<int16_t>(seq - max_seq_);
+  if (delta > 0) {
+    if (seq < max_seq_) cycles_++;
+    max_seq_ = seq;
+  } else if (delta < 0) {
+    reordered_++;
+  }
+
+  // RFC 3550 A.8, J += (|D| - J) / 16, with the transit difference taken modulo 2^32
+  uint32_t transit = arrival_rtp - timestamp;
+  int64_t d = static_cast<int32_t>(transit - transit_);
+  transit_ = transit;
+  if (d < 0) d = -d;
+  jitter_ += d - ((jitter_ + 8) >> 4);
+}
+
+void RtpReceiveStats::Log() {
+  int64_t lost = Lost();
+  double percent = received_ ? 100.0 * (lost > 0 ? lost : 0) / (received_ + (lost > 0 ? lost : 0)) : 0.0;
+  printf("RTP %s: received %llu, lost %lld (%.2f%%), reordered %llu, jitter %.2f ms", profile_.c_str(),
+         static_cast<unsigned long long>(received_), static_cast<long long>(lost), percent,
+         static_cast<unsigned long long>(reordered_), JitterMs());
+
+  // What the jitter buffer could not recover, or gave up waiting for
+  if (jitter_buffer_) {
+    GstStructure *stats = NULL;
+    g_object_get(jitter_buffer_, "stats", &stats, NULL);
+    if (stats) {
+      guint64 jb_lost = 0, jb_late = 0, rtx = 0;
+      gst_structure_get_uint64(stats, "num-lost", &jb_lost);
+      gst_structure_get_uint64(stats, "num-late", &jb_late);
+      gst_structure_get_uint64(stats, "rtx-count", &rtx);
+      printf(", jitter buffer lost %llu late %llu retransmission requests %llu",
+             static_cast<unsigned long long>(jb_lost), static_cast<unsigned long long>(jb_late),
+             static_cast<unsigned long long>(rtx));
+      gst_structure_free(stats);
+    }
+  }
+  printf("\n");
+}
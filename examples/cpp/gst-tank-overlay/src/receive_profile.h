@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief RTP receive profiles trading latency against smoothness, and receive statistics
+///
+/// \file receive_profile.h
+///
+
+#ifndef GST_TANK_OVERLAY_RECEIVE_PROFILE_H_
+#define GST_TANK_OVERLAY_RECEIVE_PROFILE_H_
+
+#include <gst/gst.h>
+#include <stdint.h>
+
+#include <string>
+
+/// \brief How the RTP stream is received
+enum class ReceiveProfile {
+  /// \brief No jitter buffer, late frames are dropped at the sink
+  kUltraLowLatency,
+  /// \brief Jitter buffer, frames are presented on their timestamps
+  kSmooth,
+  /// \brief Deep jitter buffer with retransmission requests, for lossy radio links
+  kLossyNetwork
+};
+
+/// \brief Receive path settings, filled in from a profile and then overridden from the command line
+struct ReceiveSettings {
+  /// \brief The profile the settings came from
+  ReceiveProfile profile;
+  /// \brief Insert an rtpjitterbuffer
+  bool jitter_buffer;
+  /// \brief Jitter buffer latency in milliseconds
+  int latency_ms;
+  /// \brief UDP socket receive buffer in bytes, zero for the system default
+  int socket_buffer;
+  /// \brief Present frames on their timestamps rather than as soon as they are decoded
+  bool sync;
+  /// \brief Only keep the latest frame at the sink
+  bool drop_late;
+  /// \brief Request retransmission of lost packets (RFC 4588), needs a sender that supports it
+  bool retransmit;
+  /// \brief Recover lost packets from ULP FEC (RFC 5109), needs a sender that sends it
+  bool fec;
+};
+
+///
+/// \brief Parse a profile name
+///
+/// \param name "ultra-low-latency", "smooth" or "lossy-network", throws std::runtime_error otherwise
+/// \return ReceiveProfile The profile
+///
+ReceiveProfile ParseReceiveProfile(const std::string &name);
+
+///
+/// \brief The name of a profile
+///
+/// \param profile The profile
+/// \return const char* The name accepted by ParseReceiveProfile()
+///
+const char *ReceiveProfileName(ReceiveProfile profile);
+
+///
+/// \brief The default settings for a profile
+///
+/// \param profile The profile
+/// \return ReceiveSettings The settings
+///
+ReceiveSettings DefaultReceiveSettings(ReceiveProfile profile);
+
+///
+/// \brief Packet loss, reordering and interarrival jitter of an RTP stream, as defined in RFC 3550
+///
+/// Counted on the packets as they leave the socket, before any jitter buffer, so the figures are comparable between
+/// profiles. When a jitter buffer is in the path its own lost and late counts are logged alongside.
+///
+class RtpReceiveStats {
+ public:
+  ///
+  /// \brief Construct a new Rtp Receive Stats object
+  ///
+  /// \param profile The profile name used in the log
+  /// \param clock_rate The RTP clock rate, 90kHz for video
+  /// \param interval_seconds Seconds between log lines
+  ///
+  RtpReceiveStats(std::string profile, int clock_rate = 90000, int interval_seconds = 5);
+
+  ///
+  /// \brief Start counting packets
+  ///
+  /// \param source The element producing the RTP packets, the object must outlive it
+  /// \param jitter_buffer The jitter buffer to report on, or nullptr
+  ///
+  void Attach(GstElement *source, GstElement *jitter_buffer);
+
+  ///
+  /// \brief Packets received
+  ///
+  /// \return uint64_t The packet count
+  ///
+  uint64_t Received() const { return received_; }
+
+  ///
+  /// \brief Packets lost, expected minus received
+  ///
+  /// \return int64_t The cumulative loss, negative if duplicates were received
+  ///
+  int64_t Lost() const;
+
+  ///
+  /// \brief Packets that arrived after a later sequence number
+  ///
+  /// \return uint64_t The packet count
+  ///
+  uint64_t Reordered() const { return reordered_; }
+
+  ///
+  /// \brief Interarrival jitter
+  ///
+  /// \return double The jitter in milliseconds
+  ///
+  double JitterMs() const;
+
+ private:
+  ///
+  /// \brief Pad probe counting packets
+  ///
+  /// \param pad The source pad
+  /// \param info The probe info
+  /// \param user_data This object
+  /// \return GstPadProbeReturn Always GST_PAD_PROBE_OK
+  ///
+  static GstPadProbeReturn Count(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+
+  ///
+  /// \brief Account for one packet
+  ///
+  /// \param seq The RTP sequence number
+  /// \param timestamp The RTP timestamp
+  /// \param arrival The arrival time in microseconds
+  ///
+  void Packet(uint16_t seq, uint32_t timestamp, gint64 arrival);
+
+  ///
+  /// \brief Log the statistics
+  ///
+  ///
+  void Log();
+
+  /// \brief The profile name
+  std::string profile_;
+  /// \brief The RTP clock rate
+  int clock_rate_;
+  /// \brief Microseconds between log lines
+  gint64 interval_;
+  /// \brief The jitter buffer, or nullptr
+  GstElement *jitter_buffer_ = nullptr;
+  /// \brief Packets received
+  uint64_t received_ = 0;
+  /// \brief First sequence number
+  uint16_t base_seq_ = 0;
+  /// \brief Highest sequence number seen
+  uint16_t max_seq_ = 0;
+  /// \brief Sequence number wrap arounds
+  uint32_t cycles_ = 0;
+  /// \brief Packets that arrived after a later sequence number
+  uint64_t reordered_ = 0;
+  /// \brief Transit time of the previous packet, in RTP clock units modulo 2^32
+  uint32_t transit_ = 0;
+  /// \brief Interarrival jitter in RTP clock units, scaled by 16
+  int64_t jitter_ = 0;
+  /// \brief Monotonic time of the last log line
+  gint64 logged_time_ = 0;
+};
+
+#endif  // GST_TANK_OVERLAY_RECEIVE_PROFILE_H_
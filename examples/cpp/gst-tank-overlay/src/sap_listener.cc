@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief SAP (RFC 2974) listener keeping a table of the SDP (RFC 4566) sessions being announced
+///
+/// \file sap_listener.cc
+///
+
+#include "sap_listener.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <glib-unix.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+bool ParseSdp(const std::string &sdp, SdpSession *session) {
+  std::istringstream lines(sdp);
+  std::string line;
+  bool video = false;
+  bool in_video = false;
+  std::string session_address;
+
+  *session = SdpSession();
+  session->sdp = sdp;
+
+  while (std::getline(lines, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.size() < 2 || line[1] != '=') continue;
+    std::string value = line.substr(2);
+
+    switch (line[0]) {
+      case 'o':
+        session->origin_id = SdpOriginId(line);
+        break;
+      case 's':
+        session->name = value;
+        break;
+      case 'c': {
+        // c=IN IP4 239.192.1.1/15, session level unless inside the video media section
+        std::istringstream fields(value);
+        std::string net, type, address;
+        fields >> net >> type >> address;
+        address = address.substr(0, address.find('/'));
+        if (in_video) {
+          session->address = address;
+        } else if (!video) {
+          session_address = address;
+        }
+        break;
+      }
+      case 'm': {
+        // m=video 5004 RTP/AVP 96, only the first video section is used
+        std::istringstream fields(value);
+        std::string media, proto;
+        int port = 0, payload = -1;
+        fields >> media >> port >> proto >> payload;
+        in_video = !video && media == "video" && payload >= 0;
+        if (in_video) {
+          video = true;
+          session->port = port;
+          session->payload = payload;
+        }
+        break;
+      }
+      case 'a': {
+        if (!in_video) break;
+        int payload = -1;
+        char encoding[64] = {};
+        int clock_rate = 0;
+        if (sscanf(value.c_str(), "rtpmap:%d %63[^/]/%d", &payload, encoding, &clock_rate) == 3 &&
+            payload == session->payload) {
+          session->encoding = encoding;
+          session->clock_rate = clock_rate;
+        } else if (value.compare(0, 10, "framerate:") == 0) {
+          session->framerate = atof(value.c_str() + 10);
+        } else if (value.compare(0, 5, "fmtp:") == 0) {
+          // a=fmtp:96 sampling=YCbCr-4:2:2; width=640; height=480; ...
+          size_t w = value.find("width=");
+          size_t h = value.find("height=");
+          if (w != std::string::npos) session->width = atoi(value.c_str() + w + 6);
+          if (h != std::string::npos) session->height = atoi(value.c_str() + h + 7);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  if (session->address.empty()) session->address = session_address;
+  return video && !session->address.empty() && session->port > 0;
+}
+
+std::string SdpOriginId(const std::string &sdp) {
+  // o=<username> <sess-id> <sess-version> <nettype> <addrtype> <unicast-address>, the version changes with the SDP
+  size_t start = sdp.compare(0, 2, "o=") == 0 ? 0 : sdp.find("\no=");
+  if (start == std::string::npos) return "";
+  if (start) start++;
+  std::istringstream fields(sdp.substr(start + 2, sdp.find('\n', start) - start - 2));
+  std::string username, id;
+  if (!(fields >> username >> id)) return "";
+  return username + " " + id;
+}
+
+SapListener::SapListener(int timeout_seconds) : timeout_seconds_(timeout_seconds) {}
+
+SapListener::~SapListener() { Stop(); }
+
+bool SapListener::Start(const std::string &multicast_iface) {
+  Stop();
+
+  socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) {
+    std::cerr << "SAP socket failed: " << strerror(errno) << "\n";
+    return false;
+  }
+
+  // Several listeners can share the SAP port on one host
+  int reuse = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(SAP_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(socket_, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0) {
+    std::cerr << "SAP bind failed: " << strerror(errno) << "\n";
+    Stop();
+    return false;
+  }
+
+  struct ip_mreqn group = {};
+  inet_pton(AF_INET, SAP_MULTICAST_ADDRESS, &group.imr_multiaddr);
+  group.imr_ifindex = multicast_iface.empty() ? 0 : if_nametoindex(multicast_iface.c_str());
+  if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) < 0) {
+    std::cerr << "SAP join " << SAP_MULTICAST_ADDRESS << " failed: " << strerror(errno) << "\n";
+    Stop();
+    return false;
+  }
+
+  watch_ = g_unix_fd_add(socket_, G_IO_IN, Readable, this);
+  timer_ = g_timeout_add_seconds(1, Expire, this);
+  std::cout << "Listening for SAP announcements on " << SAP_MULTICAST_ADDRESS << ":" << SAP_PORT << "\n";
+  return true;
+}
+
+void SapListener::Stop() {
+  if (watch_) g_source_remove(watch_);
+  if (timer_) g_source_remove(timer_);
+  watch_ = 0;
+  timer_ = 0;
+  if (socket_ >= 0) close(socket_);
+  socket_ = -1;
+}
+
+void SapListener::OnChange(AddedCallback added, RemovedCallback removed) {
+  added_ = std::move(added);
+  removed_ = std::move(removed);
+}
+
+gboolean SapListener::Readable(gint fd, GIOCondition condition, gpointer user_data) {
+  SapListener *self = static_cast<SapListener *>(user_data);
+  uint8_t buffer[2048];
+
+  ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+  if (size > 0) self->Packet(buffer, size);
+  return G_SOURCE_CONTINUE;
+}
+
+void SapListener::Packet(const uint8_t *data, size_t size) {
+  // RFC 2974 header, version 1
+  if (size < 8 || (data[0] >> 5) != 1) return;
+  bool ipv6 = data[0] & 0x10;
+  bool deletion = data[0] & 0x04;
+  bool encrypted = data[0] & 0x02;
+  bool compressed = data[0] & 0x01;
+  size_t auth_length = data[1] * 4;
+  uint16_t hash = (data[2] << 8) | data[3];
+  size_t origin_length = ipv6 ? 16 : 4;
+
+  if (encrypted || compressed) return;
+  size_t offset = 4 + origin_length + auth_length;
+  if (offset >= size) return;
+
+  // An optional MIME type, absent if the payload starts straight away with the SDP version or, for a deletion, origin
+  std::string payload(reinterpret_cast<const char *>(data + offset), size - offset);
+  if (payload.compare(0, 2, "v=") != 0 && payload.compare(0, 2, "o=") != 0) {
+    size_t end = payload.find('\0');
+    if (end == std::string::npos || payload.compare(0, end, "application/sdp") != 0) return;
+    payload = payload.substr(end + 1);
+  }
+
+  // The hash changes whenever the SDP does, the SDP origin's session id does not. The hash is only a fallback for
+  // announcements without an origin line
+  char origin[INET6_ADDRSTRLEN] = {};
+  inet_ntop(ipv6 ? AF_INET6 : AF_INET, data + 4, origin, sizeof(origin));
+  std::string origin_id = SdpOriginId(payload);
+  std::string key = std::string(origin) + "/" + (origin_id.empty() ? "#" + std::to_string(hash) : origin_id);
+
+  if (deletion) {
+    if (sessions_.count(key)) Remove(key);
+    return;
+  }
+
+  SdpSession session;
+  if (!ParseSdp(payload, &session)) return;
+  last_seen_[key] = g_get_monotonic_time();
+
+  auto it = sessions_.find(key);
+  if (it != sessions_.end()) {
+    if (it->second == session) return;
+    // The stream changed, for example its resolution, so its receiver is torn down and started again with the new SDP
+    SdpSession old = std::exchange(it->second, session);
+    std::cout << "SAP session " << session.name << " changed\n";
+    Log();
+    if (removed_) removed_(key, old);
+    if (added_) added_(key, session);
+    return;
+  }
+
+  sessions_[key] = session;
+  Log();
+  if (added_) added_(key, session);
+}
+
+gboolean SapListener::Expire(gpointer user_data) {
+  SapListener *self = static_cast<SapListener *>(user_data);
+  gint64 now = g_get_monotonic_time();
+  std::vector<std::string> expired;
+
+  for (const auto &seen : self->last_seen_) {
+    if (now - seen.second > static_cast<gint64>(self->timeout_seconds_) * G_USEC_PER_SEC) expired.push_back(seen.first);
+  }
+  for (const auto &key : expired) {
+    std::cout << "SAP session " << self->sessions_[key].name << " timed out\n";
+    self->Remove(key);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+void SapListener::Remove(const std::string &key) {
+  SdpSession session = sessions_[key];
+  sessions_.erase(key);
+  last_seen_.erase(key);
+  Log();
+  if (removed_) removed_(key, session);
+}
+
+void SapListener::Log() const {
+  std::cout << "SAP sessions:\n";
+  for (const auto &entry : sessions_) {
+    const SdpSession &session = entry.second;
+    std::cout << "  " << session.name << " " << session.encoding << " " << session.address << ":" << session.port
+              << " pt " << session.payload;
+    if (session.width && session.height) std::cout << " " << session.width << "x" << session.height;
+    if (session.framerate > 0) std::cout << " @" << session.framerate;
+    std::cout << "\n";
+  }
+}
@@ -0,0 +1,212 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief SAP (RFC 2974) listener keeping a table of the SDP (RFC 4566) sessions being announced
+///
+/// \file sap_listener.h
+///
+
+#ifndef GST_TANK_OVERLAY_SAP_LISTENER_H_
+#define GST_TANK_OVERLAY_SAP_LISTENER_H_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+
+/// \brief The SAP multicast group for global scope sessions
+#define SAP_MULTICAST_ADDRESS "224.2.127.254"
+/// \brief The SAP port
+#define SAP_PORT 9875
+
+/// \brief The parts of an SDP session description needed to receive the stream
+struct SdpSession {
+  /// \brief Session name (s=)
+  std::string name;
+  /// \brief Connection address (c=), without the TTL
+  std::string address;
+  /// \brief Media port (m=)
+  int port = 0;
+  /// \brief RTP payload type (m=)
+  int payload = 0;
+  /// \brief Encoding name (a=rtpmap), for example H264 or raw
+  std::string encoding;
+  /// \brief RTP clock rate (a=rtpmap)
+  int clock_rate = 90000;
+  /// \brief Frame width (a=fmtp width=), zero if not given
+  int width = 0;
+  /// \brief Frame height (a=fmtp height=), zero if not given
+  int height = 0;
+  /// \brief Frame rate (a=framerate), zero if not given
+  double framerate = 0;
+  /// \brief Username and session id from the origin (o=), the same for every version of the session
+  std::string origin_id;
+  /// \brief The SDP text, to spot an announcement that changed
+  std::string sdp;
+
+  ///
+  /// \brief Check if two announcements describe the same stream
+  ///
+  /// \param other The other session
+  /// \return true if the SDP is identical
+  ///
+  bool operator==(const SdpSession &other) const { return sdp == other.sdp; }
+};
+
+///
+/// \brief Parse the video media section of an SDP session description
+///
+/// \param sdp The SDP text
+/// \param session The parsed session
+/// \return true if the description has a video media line with a connection address
+///
+bool ParseSdp(const std::string &sdp, SdpSession *session);
+
+///
+/// \brief The part of the SDP origin (o=) that stays the same when the session is modified
+///
+/// \param sdp The SDP text, or just its o= line as in a SAP deletion
+/// \return std::string The username and session id, empty if there is no origin line
+///
+std::string SdpOriginId(const std::string &sdp);
+
+///
+/// \brief Listens for SAP announcements on the GLib main loop and maintains a cached session table
+///
+/// Sessions are added on their first announcement, replaced if the SDP changes, and removed on a SAP deletion or when
+/// they have not been announced for the timeout. The table is kept between changes so a stream can be subscribed to
+/// straight away without waiting for its next announcement.
+///
+/// A session is keyed on the SAP originating source and the username and session id of its SDP origin. The SAP message
+/// hash is not used, RFC 2974 has it change with every change to the SDP, so a modified announcement would otherwise
+/// look like a new session while the old one lingered until it timed out.
+///
+class SapListener {
+ public:
+  /// \brief Called when a session is announced for the first time, or its SDP changes
+  using AddedCallback = std::function<void(const std::string &key, const SdpSession &session)>;
+  /// \brief Called when a session is deleted or times out
+  using RemovedCallback = std::function<void(const std::string &key, const SdpSession &session)>;
+
+  ///
+  /// \brief Construct a new Sap Listener object
+  ///
+  /// \param timeout_seconds Seconds without an announcement before a session is removed
+  ///
+  explicit SapListener(int timeout_seconds = 15);
+
+  ///
+  /// \brief Destroy the Sap Listener object
+  ///
+  ///
+  ~SapListener();
+
+  ///
+  /// \brief Construct a new Sap Listener object (deleted)
+  ///
+  ///
+  SapListener(const SapListener &) = delete;
+
+  ///
+  /// \brief Delete the copy operator
+  ///
+  /// \return SapListener&
+  ///
+  SapListener &operator=(const SapListener &) = delete;
+
+  ///
+  /// \brief Join the SAP group and start listening on the default main context
+  ///
+  /// \param multicast_iface Network interface to join the group on, empty for the default
+  /// \return true if the socket is open
+  ///
+  bool Start(const std::string &multicast_iface);
+
+  ///
+  /// \brief Stop listening, the session table is kept
+  ///
+  ///
+  void Stop();
+
+  ///
+  /// \brief Set the callbacks
+  ///
+  /// \param added Called for new and changed sessions
+  /// \param removed Called for deleted and expired sessions, and for the old SDP of a changed session. For a change it
+  /// is called once the table already holds the new SDP, then added is called
+  ///
+  void OnChange(AddedCallback added, RemovedCallback removed);
+
+  ///
+  /// \brief The cached sessions
+  ///
+  /// \return const std::map<std::string, SdpSession>& Sessions by originating source and SDP origin
+  ///
+  const std::map<std::string, SdpSession> &Sessions() const { return sessions_; }
+
+  ///
+  /// \brief Handle one SAP packet, public so captured packets can be replayed
+  ///
+  /// \param data The UDP payload
+  /// \param size The payload size
+  ///
+  void Packet(const uint8_t *data, size_t size);
+
+ private:
+  ///
+  /// \brief Socket readable callback
+  ///
+  /// \param fd The socket
+  /// \param condition The IO condition
+  /// \param user_data This object
+  /// \return gboolean G_SOURCE_CONTINUE
+  ///
+  static gboolean Readable(gint fd, GIOCondition condition, gpointer user_data);
+
+  ///
+  /// \brief Periodic expiry of sessions that are no longer announced
+  ///
+  /// \param user_data This object
+  /// \return gboolean G_SOURCE_CONTINUE
+  ///
+  static gboolean Expire(gpointer user_data);
+
+  ///
+  /// \brief Remove a session and tell the callback
+  ///
+  /// \param key The session key
+  ///
+  void Remove(const std::string &key);
+
+  ///
+  /// \brief Log the session table
+  ///
+  ///
+  void Log() const;
+
+  /// \brief Seconds without an announcement before a session is removed
+  int timeout_seconds_;
+  /// \brief The UDP socket, -1 when closed
+  int socket_ = -1;
+  /// \brief The socket watch
+  guint watch_ = 0;
+  /// \brief The expiry timer
+  guint timer_ = 0;
+  /// \brief The cached sessions by originating source and SDP origin
+  std::map<std::string, SdpSession> sessions_;
+  /// \brief Monotonic time each session was last announced
+  std::map<std::string, gint64> last_seen_;
+  /// \brief New and changed session callback
+  AddedCallback added_;
+  /// \brief Removed session callback
+  RemovedCallback removed_;
+};
+
+#endif  // GST_TANK_OVERLAY_SAP_LISTENER_H_
@@ -0,0 +1,382 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief One RTP H.264 receive and decode pipeline, feeding a tile of a shared display
+///
+/// \file stream_receiver.cc
+///
+
+#include "stream_receiver.h"
+
+#include <gst/app/gstappsink.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+// Map a negotiated video format to the layouts the blender supports
+static bool yuv_layout(GstVideoFormat format, YuvLayout *layout) {
+  switch (format) {
+    case GST_VIDEO_FORMAT_I420:
+      *layout = YuvLayout::kI420;
+      return true;
+    case GST_VIDEO_FORMAT_NV12:
+      *layout = YuvLayout::kNv12;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Resize the overlay when the decoder caps arrive, and again if the stream resolution changes mid-stream
+static void prepare_overlay(OverlayState *state, GstCaps *caps) {
+  // Extract video information from caps
+  YuvLayout layout;
+  state->valid =
+      gst_video_info_from_caps(&state->vinfo, caps) && yuv_layout(GST_VIDEO_INFO_FORMAT(&state->vinfo), &layout);
+
+  // Rasterise the static layers once for this video size
+  if (state->valid) {
+    state->overlay.Resize(GST_VIDEO_INFO_WIDTH(&state->vinfo), GST_VIDEO_INFO_HEIGHT(&state->vinfo));
+  }
+}
+
+// A decoded sample kept mapped while the display uploads from it
+typedef struct {
+  GstSample *sample;    // Holds the buffer out of the decoder pool
+  GstVideoFrame frame;  // The mapped planes
+} MappedSample;
+
+std::vector<StreamConfig> ParseStreamList(const std::string &list) {
+  std::vector<StreamConfig> streams;
+  std::stringstream items(list);
+  std::string item;
+
+  while (std::getline(items, item, ',')) {
+    if (item.empty()) continue;
+
+    StreamConfig config;
+    size_t colon = item.rfind(':');
+    try {
+      if (colon == std::string::npos) {
+        config.port = std::stoi(item);
+      } else {
+        config.address = item.substr(0, colon);
+        config.port = std::stoi(item.substr(colon + 1));
+      }
+    } catch (const std::exception &e) {
+      throw std::runtime_error("Invalid stream '" + item + "', expected [address:]port");
+    }
+    if (config.port <= 0 || config.port > 65535) throw std::runtime_error("Invalid port in stream '" + item + "'");
+    config.tile = static_cast<int>(streams.size());
+    streams.push_back(config);
+  }
+  return streams;
+}
+
+StreamReceiver::StreamReceiver(StreamConfig config, ReceiveSettings settings, const std::string &decoder,
+                               int decoder_threads, OverlayState *overlay, DisplayManagerBase *display)
+    : config_(std::move(config)),
+      settings_(settings),
+      name_((config_.address.empty() ? std::string("*") : config_.address) + ":" + std::to_string(config_.port)),
+      decoders_(decoder, decoder_threads),
+      overlay_(overlay),
+      display_(display) {}
+
+StreamReceiver::~StreamReceiver() {
+  if (idle_) g_source_remove(idle_);
+  Stop();
+}
+
+bool StreamReceiver::Start() {
+  Stop();
+
+  // Try the decoders best first until one links and starts
+  while (GstElement *decoder = decoders_.Next()) {
+    if (!Build(decoder)) continue;
+
+    if (gst_element_set_state(pipeline_, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE) return true;
+    std::cerr << name_ << ": decoder " << decoders_.Name() << " failed to start, falling back\n";
+    Stop();
+  }
+
+  std::cerr << "Error: " << name_ << ": no usable H.264 decoder, tried";
+  for (const auto &name : decoders_.Candidates()) std::cerr << " " << name;
+  std::cerr << std::endl;
+  return false;
+}
+
+void StreamReceiver::Stop() {
+  if (!pipeline_) return;
+
+  gst_element_set_state(pipeline_, GST_STATE_NULL);
+  if (bus_watch_) g_source_remove(bus_watch_);
+  bus_watch_ = 0;
+  gst_object_unref(pipeline_);
+  pipeline_ = nullptr;
+  decoder_ = nullptr;
+  throughput_.reset();
+  stats_.reset();
+}
+
+bool StreamReceiver::Build(GstElement *h264decoder) {
+  // Create pipeline and elements
+  auto *pipeline = gst_pipeline_new(("receive-" + name_).c_str());
+  // RTP H.264 source
+  auto *source = gst_element_factory_make("udpsrc", "source");
+  g_object_set(source, "port", config_.port, NULL);  // Set the UDP port for receiving RTP packets
+  // Join the multicast group, udpsrc does this automatically for a multicast address
+  if (!config_.address.empty()) g_object_set(source, "address", config_.address.c_str(), NULL);
+  if (!config_.multicast_iface.empty()) g_object_set(source, "multicast-iface", config_.multicast_iface.c_str(), NULL);
+  // Size the socket buffer so a burst of packets is not dropped by the kernel, capped by net.core.rmem_max
+  if (settings_.socket_buffer > 0) g_object_set(source, "buffer-size", settings_.socket_buffer, NULL);
+
+  // Define caps for RTP H.264
+  auto *capabilities = gst_element_factory_make("capsfilter", "capsfilter");
+  GstCaps *caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "video", "clock-rate", G_TYPE_INT,
+                                      config_.clock_rate, "encoding-name", G_TYPE_STRING, "H264", "payload",
+                                      G_TYPE_INT, config_.payload, NULL);
+  g_object_set(capabilities, "caps", caps, NULL);
+  gst_caps_unref(caps);
+
+  // Reorder packets and absorb network jitter
+  GstElement *jitter_buffer = NULL;
+  if (settings_.jitter_buffer) {
+    jitter_buffer = gst_element_factory_make("rtpjitterbuffer", "jitterbuffer");
+    g_assert(jitter_buffer);
+    g_object_set(jitter_buffer, "latency", settings_.latency_ms, NULL);
+    // Retransmission requests are sent upstream as events, the sender needs rtprtxsend to act on them
+    if (settings_.retransmit) g_object_set(jitter_buffer, "do-retransmission", TRUE, "do-lost", TRUE, NULL);
+  }
+  if (settings_.fec) {
+    // Placeholder, the sender does not yet emit ULP FEC (RFC 5109). Once it does, rtpulpfecdec goes after the jitter
+    // buffer.
+    std::cerr << name_ << ": FEC requested, no FEC stream is negotiated yet\n";
+  }
+
+  // Add RTP depayloader, the H.264 decoder has already been picked
+  auto *rtph264depay = gst_element_factory_make("rtph264depay", "rtph264depay");
+  auto *capabilities2 = gst_element_factory_make("capsfilter", "capsfilter2");
+  // Keep the decoder output in system memory as 4:2:0, the HUD is blended onto it directly
+  GstCaps *caps2 = gst_caps_from_string("video/x-raw,format=(string){NV12,I420}");
+  g_object_set(capabilities2, "caps", caps2, NULL);
+  gst_caps_unref(caps2);
+
+  auto *sink = gst_element_factory_make("appsink", "sink");
+
+  // Ensure all elements are created
+  g_assert(source);
+  g_assert(rtph264depay);
+  g_assert(h264decoder);
+  g_assert(capabilities2);
+  g_assert(sink);
+
+  // Configure appsink to output YUV data, either on time or as soon as it is decoded
+  g_object_set(sink, "emit-signals", TRUE, "sync", settings_.sync ? TRUE : FALSE, NULL);
+  // Keep only the newest frame, a late frame is dropped rather than delaying the next
+  if (settings_.drop_late) g_object_set(sink, "max-buffers", 1, "drop", TRUE, NULL);
+  g_signal_connect(sink, "new-sample", G_CALLBACK(OnNewSample), this);
+
+  // Blend the HUD onto each frame as it reaches the appsink
+  if (overlay_) {
+    GstPad *sink_pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(sink_pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                      BlendOverlay, overlay_, NULL);
+    gst_object_unref(sink_pad);
+  }
+
+  // Add elements to the pipeline and link them
+  gst_bin_add_many(GST_BIN(pipeline), source, capabilities, rtph264depay, h264decoder, capabilities2, sink, NULL);
+  if (jitter_buffer) gst_bin_add(GST_BIN(pipeline), jitter_buffer);
+
+  // Some decoders only output to device memory, they cannot feed the blender
+  gboolean linked = jitter_buffer ? gst_element_link_many(source, capabilities, jitter_buffer, rtph264depay, NULL)
+                                  : gst_element_link_many(source, capabilities, rtph264depay, NULL);
+  if (!linked || !gst_element_link_many(rtph264depay, h264decoder, capabilities2, sink, NULL)) {
+    g_warning("%s: Failed to link elements!", name_.c_str());
+    gst_object_unref(pipeline);
+    return false;
+  }
+
+  pipeline_ = pipeline;
+  decoder_ = h264decoder;
+
+  // Count decoded frames, and loss, reordering and jitter as packets leave the socket
+  throughput_ = std::make_unique<DecodeThroughput>(decoders_.Name() + " " + name_);
+  throughput_->Attach(decoder_);
+  stats_ = std::make_unique<RtpReceiveStats>(std::string(ReceiveProfileName(settings_.profile)) + " " + name_,
+                                             config_.clock_rate);
+  stats_->Attach(capabilities, jitter_buffer);
+
+  // Set up the bus to handle messages on the shared main loop
+  GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
+  bus_watch_ = gst_bus_add_watch(bus, OnMessage, this);
+  gst_object_unref(bus);
+
+  return true;
+}
+
+gboolean StreamReceiver::OnMessage(GstBus *bus, GstMessage *message, gpointer user_data) {
+  StreamReceiver *self = static_cast<StreamReceiver *>(user_data);
+
+  switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_ERROR: {
+      // Handle error messages
+      GError *err = NULL;
+      gchar *debug;
+
+      gst_message_parse_error(message, &err, &debug);
+      g_critical("%s: Got ERROR: %s (%s)", self->name_.c_str(), err->message, GST_STR_NULL(debug));
+
+      // A decoder that fails, or cannot negotiate, before its first frame is replaced by the next candidate
+      bool retry = self->throughput_->Frames() == 0 &&
+                   (GST_MESSAGE_SRC(message) == GST_OBJECT(self->decoder_) ||
+                    g_error_matches(err, GST_STREAM_ERROR, GST_STREAM_ERROR_FORMAT) ||
+                    g_error_matches(err, GST_STREAM_ERROR, GST_STREAM_ERROR_DECODE) ||
+                    g_error_matches(err, GST_CORE_ERROR, GST_CORE_ERROR_NEGOTIATION));
+      g_error_free(err);
+      g_free(debug);
+
+      // The pipeline is torn down from an idle callback, not from inside its own bus watch
+      self->bus_watch_ = 0;
+      if (retry) std::cerr << self->name_ << ": decoder " << self->decoders_.Name() << " failed, falling back\n";
+      if (!self->idle_) self->idle_ = g_idle_add(retry ? Restart : Stopped, self);
+      return G_SOURCE_REMOVE;
+    }
+    case GST_MESSAGE_WARNING: {
+      // Handle warning messages
+      GError *err = NULL;
+      gchar *debug;
+
+      gst_message_parse_warning(message, &err, &debug);
+      g_warning("%s: Got WARNING: %s (%s)", self->name_.c_str(), err->message, GST_STR_NULL(debug));
+      g_error_free(err);
+      g_free(debug);
+      break;
+    }
+    case GST_MESSAGE_EOS:
+      // Handle end-of-stream messages
+      self->bus_watch_ = 0;
+      if (!self->idle_) self->idle_ = g_idle_add(Stopped, self);
+      return G_SOURCE_REMOVE;
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+gboolean StreamReceiver::Restart(gpointer user_data) {
+  StreamReceiver *self = static_cast<StreamReceiver *>(user_data);
+  self->idle_ = 0;
+
+  // Start() carries on from the next decoder candidate
+  if (!self->Start() && self->on_stopped_) self->on_stopped_(self);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean StreamReceiver::Stopped(gpointer user_data) {
+  StreamReceiver *self = static_cast<StreamReceiver *>(user_data);
+  self->idle_ = 0;
+
+  self->Stop();
+  if (self->on_stopped_) self->on_stopped_(self);
+  return G_SOURCE_REMOVE;
+}
+
+GstPadProbeReturn StreamReceiver::BlendOverlay(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+  OverlayState *s = static_cast<OverlayState *>(user_data);
+
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+      GstCaps *caps;
+      gst_event_parse_caps(event, &caps);
+      prepare_overlay(s, caps);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  if (!s->valid) return GST_PAD_PROBE_OK;
+
+  // Only layers bound to a value that has changed are re-rendered
+  s->layout.Update(&s->overlay);
+
+  // Only the damaged part of the composite is converted to YUV
+  cairo_surface_t *surface = s->overlay.Surface();
+  if (s->overlay.Version() != s->yuv_version) {
+    YuvLayout layout;
+    yuv_layout(GST_VIDEO_INFO_FORMAT(&s->vinfo), &layout);
+    s->yuv_overlay.Update(surface, s->overlay.Damage(), layout);
+    s->yuv_version = s->overlay.Version();
+  }
+
+  // Only copies if the decoder still holds a reference to the buffer
+  GstBuffer *buffer = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+  GST_PAD_PROBE_INFO_DATA(info) = buffer;
+
+  GstVideoFrame frame;
+  if (gst_video_frame_map(&frame, &s->vinfo, buffer, GST_MAP_READWRITE)) {
+    uint8_t *planes[3] = {};
+    int strides[3] = {};
+    for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES(&frame); plane++) {
+      planes[plane] = static_cast<uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&frame, plane));
+      strides[plane] = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, plane);
+    }
+    s->yuv_overlay.Blend(planes, strides);
+    gst_video_frame_unmap(&frame);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+GstFlowReturn StreamReceiver::OnNewSample(GstElement *sink, gpointer user_data) {
+  StreamReceiver *self = static_cast<StreamReceiver *>(user_data);
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstVideoInfo vinfo;
+  YuvLayout layout;
+
+  // Pull the sample from appsink
+  sample = gst_app_sink_pull_sample(GST_APP_SINK(sink));
+  if (!sample) return GST_FLOW_ERROR;
+
+  // Get the buffer from the sample
+  buffer = gst_sample_get_buffer(sample);
+  if (!buffer || !gst_video_info_from_caps(&vinfo, gst_sample_get_caps(sample)) ||
+      !yuv_layout(GST_VIDEO_INFO_FORMAT(&vinfo), &layout)) {
+    gst_sample_unref(sample);
+    return GST_FLOW_ERROR;
+  }
+
+  // Map the frame to access its planes, the display takes the decoded YUV as is
+  MappedSample *mapped = new MappedSample{sample};
+  if (!gst_video_frame_map(&mapped->frame, &vinfo, buffer, GST_MAP_READ)) {
+    gst_sample_unref(sample);
+    delete mapped;
+    return GST_FLOW_OK;
+  }
+
+  FrameView view = {layout == YuvLayout::kNv12 ? PixelFormat::kNv12 : PixelFormat::kI420,
+                    GST_VIDEO_FRAME_WIDTH(&mapped->frame), GST_VIDEO_FRAME_HEIGHT(&mapped->frame)};
+  for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES(&mapped->frame); plane++) {
+    view.planes[plane] = static_cast<uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&mapped->frame, plane));
+    view.strides[plane] = GST_VIDEO_FRAME_PLANE_STRIDE(&mapped->frame, plane);
+  }
+
+  // The display uploads straight from the mapped memory, the buffer goes back to the pool once it is done
+  view.release = [mapped]() {
+    gst_video_frame_unmap(&mapped->frame);
+    gst_sample_unref(mapped->sample);
+    delete mapped;
+  };
+  self->display_->DisplayFrame(view, self->name_, self->config_.tile);
+
+  return GST_FLOW_OK;
+}
@@ -0,0 +1,232 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief One RTP H.264 receive and decode pipeline, feeding a tile of a shared display
+///
+/// \file stream_receiver.h
+///
+
+#ifndef GST_TANK_OVERLAY_STREAM_RECEIVER_H_
+#define GST_TANK_OVERLAY_STREAM_RECEIVER_H_
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/display_manager_base.h"
+#include "decoder_select.h"
+#include "hud_layout.h"
+#include "overlay_layers.h"
+#include "receive_profile.h"
+#include "yuv_blend.h"
+
+/// \brief The HUD blended onto a stream, shared between the blend probe and the layout
+struct OverlayState {
+  /// \brief Indicates if the video info is valid
+  gboolean valid = FALSE;
+  /// \brief The negotiated video information
+  GstVideoInfo vinfo;
+  /// \brief The HUD display list and its data sources
+  HudLayout layout;
+  /// \brief The cached HUD layers
+  OverlayCompositor overlay;
+  /// \brief The HUD composite converted to YUV
+  YuvOverlay yuv_overlay;
+  /// \brief Compositor version last converted to YUV
+  uint64_t yuv_version = 0;
+};
+
+/// \brief Where a stream is received from and where it is shown
+struct StreamConfig {
+  /// \brief Multicast group or unicast address to listen on, empty for any
+  std::string address;
+  /// \brief UDP port
+  int port = 5006;
+  /// \brief RTP payload type
+  int payload = 96;
+  /// \brief RTP clock rate
+  int clock_rate = 90000;
+  /// \brief Network interface to join the multicast group on, empty for the default
+  std::string multicast_iface;
+  /// \brief The display tile
+  int tile = 0;
+};
+
+///
+/// \brief Parse a comma separated list of [address:]port pairs
+///
+/// \param list For example "239.192.1.1:5004,239.192.1.2:5004", throws std::runtime_error if malformed
+/// \return std::vector<StreamConfig> One entry per stream, tiles numbered in order
+///
+std::vector<StreamConfig> ParseStreamList(const std::string &list);
+
+///
+/// \brief Receives, decodes and displays one RTP H.264 stream
+///
+/// Each stream has its own pipeline and bus watch on the default main context, so any number of streams share one
+/// GMainLoop and one display. If the decoder fails before its first frame the pipeline is rebuilt with the next
+/// candidate.
+///
+class StreamReceiver {
+ public:
+  ///
+  /// \brief Construct a new Stream Receiver object
+  ///
+  /// \param config The stream address, port and tile
+  /// \param settings The receive profile settings
+  /// \param decoder "auto" or a decoder factory name
+  /// \param decoder_threads Threads for software decoders, 0 for one per core
+  /// \param overlay The HUD to blend onto this stream, or nullptr
+  /// \param display The display to show the decoded frames on
+  ///
+  StreamReceiver(StreamConfig config, ReceiveSettings settings, const std::string &decoder, int decoder_threads,
+                 OverlayState *overlay, DisplayManagerBase *display);
+
+  ///
+  /// \brief Destroy the Stream Receiver object, stops the pipeline
+  ///
+  ///
+  ~StreamReceiver();
+
+  ///
+  /// \brief Construct a new Stream Receiver object (deleted)
+  ///
+  ///
+  StreamReceiver(const StreamReceiver &) = delete;
+
+  ///
+  /// \brief Delete the copy operator
+  ///
+  /// \return StreamReceiver&
+  ///
+  StreamReceiver &operator=(const StreamReceiver &) = delete;
+
+  ///
+  /// \brief Build the pipeline with the best working decoder and start it
+  ///
+  /// Called again after a failure, carries on from the next decoder candidate.
+  ///
+  /// \return true if a pipeline is playing
+  ///
+  bool Start();
+
+  ///
+  /// \brief Stop and destroy the pipeline
+  ///
+  ///
+  void Stop();
+
+  ///
+  /// \brief Check if the pipeline is playing
+  ///
+  /// \return true if running
+  ///
+  bool Running() const { return pipeline_ != nullptr; }
+
+  ///
+  /// \brief The stream name used in logs, address:port
+  ///
+  /// \return const std::string& The name
+  ///
+  const std::string &Name() const { return name_; }
+
+  ///
+  /// \brief Set a callback for when the stream stops on an error or end of stream
+  ///
+  /// \param callback Called from the main loop
+  ///
+  void OnStopped(std::function<void(StreamReceiver *)> callback) { on_stopped_ = std::move(callback); }
+
+ private:
+  ///
+  /// \brief Build the pipeline around a decoder
+  ///
+  /// \param decoder A floating reference to the decoder
+  /// \return true if the elements linked
+  ///
+  bool Build(GstElement *decoder);
+
+  ///
+  /// \brief Bus watch
+  ///
+  /// \param bus The pipeline bus
+  /// \param message The message
+  /// \param user_data This object
+  /// \return gboolean TRUE to keep watching
+  ///
+  static gboolean OnMessage(GstBus *bus, GstMessage *message, gpointer user_data);
+
+  ///
+  /// \brief Restart with the next decoder, from an idle callback so the bus watch has returned
+  ///
+  /// \param user_data This object
+  /// \return gboolean G_SOURCE_REMOVE
+  ///
+  static gboolean Restart(gpointer user_data);
+
+  ///
+  /// \brief Tear down after an error or end of stream, from an idle callback
+  ///
+  /// \param user_data This object
+  /// \return gboolean G_SOURCE_REMOVE
+  ///
+  static gboolean Stopped(gpointer user_data);
+
+  ///
+  /// \brief Pad probe on the appsink, blends the HUD onto the decoded frame in place
+  ///
+  /// \param pad The appsink pad
+  /// \param info The probe info
+  /// \param user_data The OverlayState
+  /// \return GstPadProbeReturn Always GST_PAD_PROBE_OK
+  ///
+  static GstPadProbeReturn BlendOverlay(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+
+  ///
+  /// \brief Appsink callback, hands the decoded frame to the display without copying
+  ///
+  /// \param sink The appsink
+  /// \param user_data This object
+  /// \return GstFlowReturn GST_FLOW_OK unless the sample is unusable
+  ///
+  static GstFlowReturn OnNewSample(GstElement *sink, gpointer user_data);
+
+  /// \brief The stream address, port and tile
+  StreamConfig config_;
+  /// \brief The receive profile settings
+  ReceiveSettings settings_;
+  /// \brief The stream name used in logs
+  std::string name_;
+  /// \brief The decoder candidates
+  DecoderSelector decoders_;
+  /// \brief The HUD, or nullptr
+  OverlayState *overlay_;
+  /// \brief The shared display
+  DisplayManagerBase *display_;
+  /// \brief The pipeline, nullptr when stopped
+  GstElement *pipeline_ = nullptr;
+  /// \brief The decoder in the pipeline
+  GstElement *decoder_ = nullptr;
+  /// \brief The bus watch source
+  guint bus_watch_ = 0;
+  /// \brief Pending Restart() or Stopped() idle source
+  guint idle_ = 0;
+  /// \brief Frames decoded by the current decoder
+  std::unique_ptr<DecodeThroughput> throughput_;
+  /// \brief Loss, reorder and jitter statistics
+  std::unique_ptr<RtpReceiveStats> stats_;
+  /// \brief Called when the stream stops on its own
+  std::function<void(StreamReceiver *)> on_stopped_;
+};
+
+#endif  // GST_TANK_OVERLAY_STREAM_RECEIVER_H_
@@ -7,317 +7,114 @@
 // License. See the LICENSE file in the project root for full license details.
 //
 
-#include <cairo-gobject.h>
-#include <cairo.h>
 #include <gflags/gflags.h>
 #include <glib.h>
-#include <gst/app/gstappsink.h>
 #include <gst/gst.h>
-#include <gst/video/video.h>
 #include <stdio.h>
-#include <time.h>
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "common/display_manager_sdl.h"
-
-#define HEIGHT 576
-#define WIDTH 720
+#include "receive_profile.h"
+#include "sap_listener.h"
+#include "stream_receiver.h"
 
 // Fullscreen gflag bool
 DEFINE_bool(fullscreen, false, "Enable fullscreen mode");
-// Define an integer flag for setting the width
-DEFINE_int32(width, 720, "Set the width of the display");
-// Define an integer flag for setting the height
-DEFINE_int32(height, 576, "Set the height of the display");
+// Define an integer flag for setting the window width, the video is scaled to fit
+DEFINE_int32(width, 720, "Set the width of the display window");
+// Define an integer flag for setting the window height, the video is scaled to fit
+DEFINE_int32(height, 576, "Set the height of the display window");
 // Port for the UDP source
 DEFINE_int32(port, 5006, "Set the port for the UDP source");
-
-DisplayManager *dm_ptr;
-// Callback function to handle messages from the GStreamer bus
-static gboolean on_message(GstBus *bus, GstMessage *message, gpointer user_data) {
-  GMainLoop *loop = (GMainLoop *)user_data;
-
-  switch (GST_MESSAGE_TYPE(message)) {
-    case GST_MESSAGE_ERROR: {
-      // Handle error messages
-      GError *err = NULL;
-      gchar *debug;
-
-      gst_message_parse_error(message, &err, &debug);
-      g_critical("Got ERROR: %s (%s)", err->message, GST_STR_NULL(debug));
-      g_main_loop_quit(loop);
-      break;
-    }
-    case GST_MESSAGE_WARNING: {
-      // Handle warning messages
-      GError *err = NULL;
-      gchar *debug;
-
-      gst_message_parse_warning(message, &err, &debug);
-      g_warning("Got WARNING: %s (%s)", err->message, GST_STR_NULL(debug));
-      g_main_loop_quit(loop);
-      break;
-    }
-    case GST_MESSAGE_EOS:
-      // Handle end-of-stream messages
-      g_main_loop_quit(loop);
-      break;
-    default:
-      break;
-  }
-
-  return TRUE;
-}
-
-// Data structure to share state between prepare and render functions
-typedef struct {
-  gboolean valid;      // Indicates if the video info is valid
-  GstVideoInfo vinfo;  // Stores video information
-} CairoOverlayState;
-
-// Callback to prepare overlay with video information from caps
-static void prepare_overlay(GstElement *overlay, GstCaps *caps, gpointer user_data) {
-  CairoOverlayState *state = (CairoOverlayState *)user_data;
-
-  // Extract video information from caps
-  state->valid = gst_video_info_from_caps(&state->vinfo, caps);
-}
-
-static void camera_mode(cairo_t *cr, const std::string &mode) {
-  // Set the text color to gray
-  cairo_set_source_rgb(cr, 0.6, 0.6, 0.6);
-
-  // Set the font size for the text
-  cairo_set_font_size(cr, 14);
-
-  // Display the mode text
-  cairo_show_text(cr, mode.c_str());
-}
-
-void redicle1(cairo_t *cr) {
-  // Draw the reticle
-  int y_offset = -28;
-
-  // Set the color to black for the outer circle with 50% transparency
-  cairo_set_source_rgba(cr, 1, 1, 1, 0.5);          // Black with 50% transparency
-  cairo_arc(cr, 0, 0 - y_offset, 50, 0, 2 * M_PI);  // Outer circle
-  cairo_stroke(cr);
-
-  // Set the color to black for the inner circle with 50% transparency
-  cairo_arc(cr, 0, 0 - y_offset, 10, 0, 2 * M_PI);  // Inner circle
-  cairo_stroke(cr);
-
-  // Draw horizontal and vertical lines for the crosshair
-  cairo_move_to(cr, -60, 0 - y_offset);  // Left horizontal line
-  cairo_line_to(cr, -15, 0 - y_offset);
-  cairo_move_to(cr, 15, 0 - y_offset);  // Right horizontal line
-  cairo_line_to(cr, 60, 0 - y_offset);
-  cairo_move_to(cr, 0, -60 - y_offset);  // Top vertical line
-  cairo_line_to(cr, 0, -15 - y_offset);
-  cairo_move_to(cr, 0, 15 - y_offset);  // Bottom vertical line
-  cairo_line_to(cr, 0, 60 - y_offset);
-  cairo_stroke(cr);
-
-  // Set the color to red for the center dot with 50% transparency
-  cairo_set_source_rgba(cr, 1, 0, 0, 0.5);         // Red with 50% transparency
-  cairo_arc(cr, 0, 0 - y_offset, 3, 0, 2 * M_PI);  // Center dot
-  cairo_fill(cr);
-}
-
-// Callback to draw the overlay using Cairo
-static void draw_overlay(GstElement *overlay, cairo_t *cr, guint64 timestamp, guint64 duration, gpointer user_data) {
-  char *labels[] = {"270", "215", " 0 ", " 45"};
-  char *current_label = 0;
-  int label_count = 0;
-  CairoOverlayState *s = (CairoOverlayState *)user_data;
-  double scale = 1;
-  int width, height;
-
-  // Get the current time
-  time_t T = time(NULL);
-  struct tm tm = *localtime(&T);
-
-  if (!s->valid) return;
-
-  // Get video dimensions
-  width = GST_VIDEO_INFO_WIDTH(&s->vinfo);
-  height = GST_VIDEO_INFO_HEIGHT(&s->vinfo);
-
-  // Translate and scale the drawing context
-  cairo_translate(cr, width / 2, (height / 2) - 30);
-  cairo_scale(cr, scale, scale);
-  cairo_set_line_width(cr, 1);
-  cairo_set_source_rgb(cr, 1, 1, 1);
-
-  // Set the color to black for the outline
-  cairo_set_source_rgb(cr, 0, 0, 0);
-
-  redicle1(cr);
-
-  // Set draw colour back to white
-  cairo_set_source_rgb(cr, 1, 1, 1);
-
-  // Draw degree markers and labels
-  for (int i = 0; i < 40; i++) {
-    int ii = i - 4;
-    int offset = 0;
-    if (!(ii % 10)) {
-      offset = 3;
-      current_label = labels[label_count++];
-      cairo_set_font_size(cr, 14);
-      cairo_move_to(cr, -200 + (i * 10) - 10, -160);
-      cairo_show_text(cr, current_label);
-    }
-    cairo_move_to(cr, -200 + (i * 10), -190);
-    cairo_line_to(cr, -200 + (i * 10), -185 + offset);
-  }
-
-  // Draw crosshair and other elements
-  cairo_move_to(cr, -5, -200);
-  cairo_line_to(cr, 0, -195);
-  cairo_line_to(cr, 5, -200);
-
-  cairo_stroke(cr);
-
-  // Draw text such as time and telemetry data
-  cairo_select_font_face(cr, "Ubuntu Thin", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-  cairo_set_font_size(cr, 24);
-  cairo_move_to(cr, -20, 250);
-  cairo_show_text(cr, "0025");
-
-  char tstring[200];
-  snprintf(tstring, 200, "%02d:%02d:%02d", tm.tm_hour, tm.tm_min, tm.tm_sec);
-
-  cairo_set_font_size(cr, 14);
-  cairo_move_to(cr, -300, -180);
-  cairo_show_text(cr, tstring);
-
-  // Telemetry left
-  cairo_move_to(cr, -300, -120);
-  cairo_show_text(cr, "15°");
-  cairo_move_to(cr, -300, -40);
-  cairo_show_text(cr, "HORAS - READY");
-  cairo_move_to(cr, -300, -20);
-  cairo_show_text(cr, "S60");
-
-  // Telemetry right
-  cairo_move_to(cr, 270, -120);
-  cairo_show_text(cr, "0 KPH");
-  cairo_move_to(cr, 270, -40);
-  cairo_show_text(cr, "1X");
-  cairo_move_to(cr, 270, -20);
-  camera_mode(cr, "DAY");
-}
-
-// Callback to handle new sample from appsink
-static GstFlowReturn on_new_sample(GstElement *sink, gpointer user_data) {
-  GstSample *sample;
-  GstBuffer *buffer;
-  GstMapInfo map;
-  static int count = 0;
-
-  // Pull the sample from appsink
-  sample = gst_app_sink_pull_sample(GST_APP_SINK(sink));
-  if (!sample) return GST_FLOW_ERROR;
-
-  // Get the buffer from the sample
-  buffer = gst_sample_get_buffer(sample);
-  if (!buffer) {
-    gst_sample_unref(sample);
-    return GST_FLOW_ERROR;
-  }
-
-  // Map the buffer to access its data
-  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-    // Process the RGB data in `map.data` with size `map.size`
-    // Example: Print the size of the buffer
-    dm_ptr->DisplayBuffer(map.data, {WIDTH, HEIGHT, 3}, "Tank Overlay");
-
-    // Unmap the buffer after processing
-    gst_buffer_unmap(buffer, &map);
-  }
-
-  // Unref the sample after processing
-  gst_sample_unref(sample);
-
-  return GST_FLOW_OK;
-}
-
-// Function to set up the GStreamer pipeline
-static GstElement *setup_gst_pipeline(CairoOverlayState *overlay_state) {
-  int width = FLAGS_width;
-  int height = FLAGS_height;
-  int framerate = 30;
-
-  // Create pipeline and elements
-  auto *pipeline = gst_pipeline_new("cairo-overlay-example");
-  // RTP H.264 source
-  auto *source = gst_element_factory_make("udpsrc", "source");
-  g_object_set(source, "port", FLAGS_port, NULL);  // Set the UDP port for receiving RTP packets
-
-  // Define caps for RTP H.264
-  auto *capabilities = gst_element_factory_make("capsfilter", "capsfilter");
-  GstCaps *caps = gst_caps_new_simple("application/x-rtp", "media", G_TYPE_STRING, "video", "encoding-name",
-                                      G_TYPE_STRING, "H264", "payload", G_TYPE_INT, 96, NULL);
-  // Add RTP depayloader and H.264 decoder
-  auto *rtph264depay = gst_element_factory_make("rtph264depay", "rtph264depay");
-  auto *h264decoder = gst_element_factory_make("vaapih264dec", "h264decoder");
-  auto *adaptor1 = gst_element_factory_make("videoconvert", "adaptor1");
-  auto *cairo_overlay = gst_element_factory_make("cairooverlay", "overlay");
-  auto *adaptor2 = gst_element_factory_make("videoconvert", "adaptor2");
-  auto *capabilities2 = gst_element_factory_make("capsfilter", "capsfilter2");
-  // Capabilities for the adaptor2 RBG raw output
-  GstCaps *caps2 = gst_caps_new_simple("video/x-raw", "format", G_TYPE_STRING, "RGB", NULL);
-  g_object_set(capabilities2, "caps", caps2, NULL);
-
-  auto *sink = gst_element_factory_make("appsink", "sink");
-
-  // Ensure all elements are created
-  g_assert(source);
-  g_assert(rtph264depay);
-  g_assert(h264decoder);
-  g_assert(adaptor1);
-  g_assert(cairo_overlay);
-  g_assert(adaptor2);
-  g_assert(capabilities2);
-  g_assert(sink);
-
-  // Configure appsink to output RGB data
-  g_object_set(sink, "emit-signals", TRUE, "sync", FALSE, NULL);
-  g_signal_connect(sink, "new-sample", G_CALLBACK(on_new_sample), NULL);
-
-  // Connect signals for cairo overlay
-  g_signal_connect(cairo_overlay, "draw", G_CALLBACK(draw_overlay), overlay_state);
-  g_signal_connect(cairo_overlay, "caps-changed", G_CALLBACK(prepare_overlay), overlay_state);
-
-  // Add elements to the pipeline and link them
-  gst_bin_add_many(GST_BIN(pipeline), source, capabilities, rtph264depay, h264decoder, adaptor1, cairo_overlay,
-                   adaptor2, capabilities2, sink, NULL);
-
-  if (!gst_element_link_many(source, capabilities, rtph264depay, h264decoder, adaptor1, cairo_overlay, adaptor2,
-                             capabilities2, sink, NULL)) {
-    g_warning("Failed to link elements!");
-  }
-
-  return pipeline;
+// Multicast streams, each gets its own pipeline and display tile
+DEFINE_string(streams, "", "Comma separated [group:]port list, for example 239.192.1.1:5004,239.192.1.2:5004");
+// Multicast interface
+DEFINE_string(multicast_iface, "", "Network interface to join the multicast groups on");
+// Stream with the HUD
+DEFINE_int32(hud_stream, 0, "Index of the stream to overlay the HUD on, -1 for none");
+// HUD layout description
+DEFINE_string(hud_layout, TANK_HUD_LAYOUT, "JSON HUD layout to overlay on the video");
+// H.264 decoder
+DEFINE_string(decoder, "auto", "H.264 decoder factory name, or auto to pick the best one that works");
+// RTP receive profile
+DEFINE_string(receive_profile, "ultra-low-latency", "RTP receive profile, ultra-low-latency, smooth or lossy-network");
+// Jitter buffer latency override
+DEFINE_int32(jitter_latency, -1, "Jitter buffer latency in milliseconds, -1 for the profile default");
+// Socket buffer override
+DEFINE_int32(socket_buffer, -1, "UDP receive buffer in bytes, -1 for the profile default, 0 for the system default");
+// SAP discovery
+DEFINE_bool(sap, false, "Subscribe to the H.264 streams announced by SAP as they come and go");
+// SAP session name filter
+DEFINE_string(sap_filter, "", "Only subscribe to SAP sessions whose name contains this text");
+// SAP tiles
+DEFINE_int32(sap_max_streams, 4, "Most SAP streams shown at once, the rest are cached until a tile is free");
+// SAP expiry
+DEFINE_int32(sap_timeout, 15, "Seconds without an announcement before a SAP session is dropped");
+
+// A stream subscribed to from a SAP announcement
+struct SapStream {
+  std::unique_ptr<StreamReceiver> receiver;
+  int tile;
+};
+
+// Check if an announced session is one this receiver can show
+static bool sap_wanted(const SdpSession &session) {
+  return g_ascii_strcasecmp(session.encoding.c_str(), "H264") == 0 &&
+         session.name.find(FLAGS_sap_filter) != std::string::npos;
 }
 
 // Main function
 int main(int argc, char **argv) {
   GMainLoop *loop;
-  GstElement *pipeline;
-  GstBus *bus;
-  CairoOverlayState *overlay_state;
+  OverlayState *overlay_state;
+  std::vector<StreamConfig> configs;
 
   DisplayManager dm;
-  dm_ptr = &dm;
 
   // Init gflags
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
+  // Allocate overlay state and compile the HUD layout
+  overlay_state = new OverlayState();
+  try {
+    overlay_state->layout.Load(FLAGS_hud_layout);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    delete overlay_state;
+    return EXIT_FAILURE;
+  }
+  overlay_state->layout.Install(&overlay_state->overlay);
+  overlay_state->layout.Start();
+
+  // Receive profile, with any command line overrides
+  ReceiveSettings settings;
+  try {
+    settings = DefaultReceiveSettings(ParseReceiveProfile(FLAGS_receive_profile));
+    // A single unicast port unless a stream list is given or the streams are discovered
+    if (!FLAGS_streams.empty()) {
+      configs = ParseStreamList(FLAGS_streams);
+    } else if (!FLAGS_sap) {
+      configs = ParseStreamList(std::to_string(FLAGS_port));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    delete overlay_state;
+    return EXIT_FAILURE;
+  }
+  if (FLAGS_jitter_latency >= 0) {
+    settings.jitter_buffer = true;
+    settings.latency_ms = FLAGS_jitter_latency;
+  }
+  if (FLAGS_socket_buffer >= 0) settings.socket_buffer = FLAGS_socket_buffer;
+
   // Initalise Display Manager
   dm.Initalise(FLAGS_width, FLAGS_height, "Sight overlay");
   std::thread display_thread(&DisplayManager::Run, &dm);
@@ -332,26 +129,93 @@ int main(int argc, char **argv) {
   gst_init(&argc, &argv);
   loop = g_main_loop_new(NULL, FALSE);
 
-  // Allocate overlay state
-  overlay_state = g_new0(CairoOverlayState, 1);
-
-  // Set up the pipeline
-  pipeline = setup_gst_pipeline(overlay_state);
-
-  // Set up the bus to handle messages
-  bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
-  gst_bus_add_signal_watch(bus);
-  g_signal_connect(G_OBJECT(bus), "message", G_CALLBACK(on_message), loop);
-  gst_object_unref(GST_OBJECT(bus));
+  // One pipeline per stream on the shared main loop, software decoders share the cores between them
+  size_t most_streams = configs.size() + (FLAGS_sap ? std::max(0, FLAGS_sap_max_streams) : 0);
+  int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency() / std::max<size_t>(1, most_streams)));
+  std::vector<std::unique_ptr<StreamReceiver>> receivers;
+  int running = 0;
+  int started = 0;
+  for (auto &config : configs) {
+    config.multicast_iface = FLAGS_multicast_iface;
+    OverlayState *hud = config.tile == FLAGS_hud_stream ? overlay_state : nullptr;
+    receivers.push_back(std::make_unique<StreamReceiver>(config, settings, FLAGS_decoder, threads, hud, &dm));
+
+    // Quit once every stream has stopped
+    receivers.back()->OnStopped([&running, loop](StreamReceiver *receiver) {
+      std::cerr << receiver->Name() << " stopped\n";
+      if (--running == 0 && !FLAGS_sap) g_main_loop_quit(loop);
+    });
+    if (receivers.back()->Start()) running++;
+  }
+  started = running;
+
+  // Streams announced by SAP take the tiles after the fixed streams. Sessions are kept in the listener's table, so
+  // when a stream goes the next cached one is subscribed straight away rather than on its next announcement.
+  SapListener sap(FLAGS_sap_timeout);
+  std::map<std::string, SapStream> subscribed;
+  auto subscribe_one = [&](const std::string &key, const SdpSession &session, int tile) {
+    // Receive with the payload type and clock rate from the SDP
+    StreamConfig config;
+    config.address = session.address;
+    config.port = session.port;
+    config.payload = session.payload;
+    config.clock_rate = session.clock_rate;
+    config.multicast_iface = FLAGS_multicast_iface;
+    config.tile = tile;
+    OverlayState *hud = tile == FLAGS_hud_stream ? overlay_state : nullptr;
+    auto receiver = std::make_unique<StreamReceiver>(config, settings, FLAGS_decoder, threads, hud, &dm);
+    receiver->OnStopped([](StreamReceiver *receiver) {
+      std::cerr << receiver->Name() << " stopped, waiting for the session to change or go\n";
+    });
+    std::cout << "Subscribing to " << session.name << " on " << receiver->Name() << ", tile " << tile << "\n";
+    receiver->Start();
+    subscribed[key] = {std::move(receiver), tile};
+  };
+  std::function<void()> subscribe = [&]() {
+    for (const auto &entry : sap.Sessions()) {
+      if (subscribed.size() >= static_cast<size_t>(std::max(0, FLAGS_sap_max_streams))) break;
+      if (subscribed.count(entry.first) || !sap_wanted(entry.second)) continue;
+
+      // The first free tile
+      int tile = static_cast<int>(configs.size());
+      while (std::any_of(subscribed.begin(), subscribed.end(), [tile](const auto &s) { return s.second.tile == tile; }))
+        tile++;
+      subscribe_one(entry.first, entry.second, tile);
+    }
+  };
+
+  if (FLAGS_sap) {
+    sap.OnChange(
+        [&](const std::string &key, const SdpSession &session) {
+          if (g_ascii_strcasecmp(session.encoding.c_str(), "H264") != 0) {
+            std::cout << "Ignoring " << session.name << ", " << session.encoding << " is not H.264\n";
+          }
+          subscribe();
+        },
+        [&](const std::string &key, const SdpSession &session) {
+          auto it = subscribed.find(key);
+          if (it == subscribed.end()) return;
+          std::cout << "Unsubscribing from " << session.name << "\n";
+          // Stop the pipeline before blanking its tile so no frame lands after it
+          int tile = it->second.tile;
+          subscribed.erase(it);
+          dm.ClearTile(tile);
+          // A session whose SDP changed is still in the table, its new receiver keeps the tile
+          auto changed = sap.Sessions().find(key);
+          if (changed != sap.Sessions().end() && sap_wanted(changed->second)) subscribe_one(key, changed->second, tile);
+          subscribe();
+        });
+    if (sap.Start(FLAGS_multicast_iface)) started++;
+  }
 
-  // Start the pipeline
-  gst_element_set_state(pipeline, GST_STATE_PLAYING);
-  g_main_loop_run(loop);
+  if (started > 0) g_main_loop_run(loop);
 
   // Clean up
-  gst_element_set_state(pipeline, GST_STATE_NULL);
-  gst_object_unref(pipeline);
-  g_free(overlay_state);
+  sap.Stop();
+  subscribed.clear();
+  receivers.clear();
+  g_main_loop_unref(loop);
+  delete overlay_state;
 
-  return 0;
-}
\ No newline at end of file
+  return started > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
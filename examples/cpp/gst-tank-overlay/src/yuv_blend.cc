@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Alpha blend a premultiplied ARGB overlay directly onto planar YUV video
+///
+/// \file yuv_blend.cc
+///
+
+#include "yuv_blend.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void BlendRow(uint8_t *dst, const uint8_t *overlay, const uint8_t *inverse_alpha, int count) {
+  int i = 0;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i half = _mm_set1_epi16(128);
+  for (; i + 16 <= count; i += 16) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inverse_alpha + i));
+    __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i *>(overlay + i));
+
+    // dst * inverse_alpha / 255, as (x + 128 + ((x + 128) >> 8)) >> 8 in 16 bit lanes
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(a, zero)), half);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(a, zero)), half);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), o));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 16 <= count; i += 16) {
+    uint8x16_t d = vld1q_u8(dst + i);
+    uint8x16_t a = vld1q_u8(inverse_alpha + i);
+    uint8x16_t o = vld1q_u8(overlay + i);
+
+    // dst * inverse_alpha / 255, rounded
+    uint16x8_t lo = vmull_u8(vget_low_u8(d), vget_low_u8(a));
+    uint16x8_t hi = vmull_u8(vget_high_u8(d), vget_high_u8(a));
+    uint8x16_t scaled = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+
+    vst1q_u8(dst + i, vqaddq_u8(scaled, o));
+  }
+#endif
+
+  // Remainder, and the whole row on other architectures
+  for (; i < count; i++) {
+    unsigned int scaled = dst[i] * inverse_alpha[i] + 128;
+    scaled = (scaled + (scaled >> 8)) >> 8;
+    dst[i] = static_cast<uint8_t>(std::min(scaled + overlay[i], 255u));
+  }
+}
+
+void YuvOverlay::Update(cairo_surface_t *surface, const std::vector<OverlayRect> &damage, YuvLayout layout) {
+  if (!surface) return;
+
+  int width = cairo_image_surface_get_width(surface);
+  int height = cairo_image_surface_get_height(surface);
+  const uint8_t *pixels = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+
+  if (width != width_ || height != height_ || layout != layout_) {
+    width_ = width;
+    height_ = height;
+    layout_ = layout;
+
+    int chroma_width = (width_ + 1) / 2;
+    int chroma_height = (height_ + 1) / 2;
+    chroma_stride_ = layout_ == YuvLayout::kNv12 ? chroma_width * 2 : chroma_width;
+
+    luma_.assign(width_ * height_, 0);
+    luma_alpha_.assign(width_ * height_, 255);
+    for (int plane = 0; plane < 2; plane++) {
+      bool used = plane == 0 || layout_ == YuvLayout::kI420;
+      chroma_[plane].assign(used ? chroma_stride_ * chroma_height : 0, 0);
+      chroma_alpha_[plane].assign(used ? chroma_stride_ * chroma_height : 0, 255);
+    }
+    luma_spans_.assign(height_, {0, 0});
+    chroma_spans_.assign(chroma_height, {0, 0});
+
+    Convert(pixels, stride, {0, 0, width_, height_});
+    UpdateSpans(0, height_);
+    return;
+  }
+
+  for (const auto &rect : damage) {
+    // Grow to whole 2x2 chroma blocks
+    int x0 = rect.x & ~1;
+    int y0 = rect.y & ~1;
+    OverlayRect aligned = OverlayRect{x0, y0, rect.x + rect.width - x0 + 1, rect.y + rect.height - y0 + 1};
+    aligned.width &= ~1;
+    aligned.height &= ~1;
+    aligned = aligned.Clip(width_, height_);
+    if (aligned.Empty()) continue;
+
+    Convert(pixels, stride, aligned);
+    UpdateSpans(aligned.y, aligned.y + aligned.height);
+  }
+}
+
+void YuvOverlay::Convert(const uint8_t *pixels, int stride, const OverlayRect &rect) {
+  // BT.601 limited range, applied to premultiplied colour so the results are already scaled by alpha
+  for (int y = rect.y; y < rect.y + rect.height; y++) {
+    const uint32_t *row = reinterpret_cast<const uint32_t *>(pixels + y * stride);
+    for (int x = rect.x; x < rect.x + rect.width; x++) {
+      uint32_t argb = row[x];
+      int a = argb >> 24;
+      int r = (argb >> 16) & 0xff;
+      int g = (argb >> 8) & 0xff;
+      int b = argb & 0xff;
+      luma_[y * width_ + x] = std::clamp(((66 * r + 129 * g + 25 * b + 128) >> 8) + (16 * a + 127) / 255, 0, 255);
+      luma_alpha_[y * width_ + x] = 255 - a;
+    }
+  }
+
+  for (int cy = rect.y / 2; cy < (rect.y + rect.height + 1) / 2; cy++) {
+    for (int cx = rect.x / 2; cx < (rect.x + rect.width + 1) / 2; cx++) {
+      // Average the 2x2 block, clamped at the right and bottom edges
+      int a = 0, r = 0, g = 0, b = 0;
+      for (int dy = 0; dy < 2; dy++) {
+        const uint32_t *row =
+            reinterpret_cast<const uint32_t *>(pixels + std::min(cy * 2 + dy, height_ - 1) * stride);
+        for (int dx = 0; dx < 2; dx++) {
+          uint32_t argb = row[std::min(cx * 2 + dx, width_ - 1)];
+          a += argb >> 24;
+          r += (argb >> 16) & 0xff;
+          g += (argb >> 8) & 0xff;
+          b += argb & 0xff;
+        }
+      }
+      a = (a + 2) / 4;
+      // Sums of four samples, so shift by 10 rather than 8
+      int u = std::clamp(((-38 * r - 74 * g + 112 * b + 512) >> 10) + (128 * a + 127) / 255, 0, 255);
+      int v = std::clamp(((112 * r - 94 * g - 18 * b + 512) >> 10) + (128 * a + 127) / 255, 0, 255);
+
+      if (layout_ == YuvLayout::kNv12) {
+        int index = cy * chroma_stride_ + cx * 2;
+        chroma_[0][index] = u;
+        chroma_[0][index + 1] = v;
+        chroma_alpha_[0][index] = 255 - a;
+        chroma_alpha_[0][index + 1] = 255 - a;
+      } else {
+        int index = cy * chroma_stride_ + cx;
+        chroma_[0][index] = u;
+        chroma_[1][index] = v;
+        chroma_alpha_[0][index] = 255 - a;
+        chroma_alpha_[1][index] = 255 - a;
+      }
+    }
+  }
+}
+
+void YuvOverlay::UpdateSpans(int first, int last) {
+  auto find_span = [](const uint8_t *inverse_alpha, int count) {
+    int begin = 0;
+    int end = count;
+    while (begin < count && inverse_alpha[begin] == 255) begin++;
+    while (end > begin && inverse_alpha[end - 1] == 255) end--;
+    return Span{begin, end};
+  };
+
+  for (int y = first; y < last; y++) {
+    luma_spans_[y] = find_span(&luma_alpha_[y * width_], width_);
+  }
+  for (int cy = first / 2; cy < (last + 1) / 2; cy++) {
+    // U and V share an alpha so the first chroma plane decides the span
+    chroma_spans_[cy] = find_span(&chroma_alpha_[0][cy * chroma_stride_], chroma_stride_);
+  }
+}
+
+void YuvOverlay::Blend(uint8_t *const planes[3], const int strides[3]) const {
+  for (int y = 0; y < height_; y++) {
+    const Span &span = luma_spans_[y];
+    if (span.begin == span.end) continue;
+    int offset = y * width_ + span.begin;
+    BlendRow(planes[0] + y * strides[0] + span.begin, &luma_[offset], &luma_alpha_[offset], span.end - span.begin);
+  }
+
+  int chroma_planes = layout_ == YuvLayout::kNv12 ? 1 : 2;
+  for (int cy = 0; cy < static_cast<int>(chroma_spans_.size()); cy++) {
+    const Span &span = chroma_spans_[cy];
+    if (span.begin == span.end) continue;
+    int offset = cy * chroma_stride_ + span.begin;
+    for (int plane = 0; plane < chroma_planes; plane++) {
+      BlendRow(planes[plane + 1] + cy * strides[plane + 1] + span.begin, &chroma_[plane][offset],
+               &chroma_alpha_[plane][offset], span.end - span.begin);
+    }
+  }
+}
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Alpha blend a premultiplied ARGB overlay directly onto planar YUV video
+///
+/// \file yuv_blend.h
+///
+
+#ifndef GST_TANK_OVERLAY_YUV_BLEND_H_
+#define GST_TANK_OVERLAY_YUV_BLEND_H_
+
+#include <cairo.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "overlay_layers.h"
+
+/// \brief The 4:2:0 layouts the blender can write to
+enum class YuvLayout {
+  /// \brief Three planes, Y then U then V
+  kI420,
+  /// \brief Two planes, Y then interleaved UV
+  kNv12
+};
+
+///
+/// \brief Blend one row of premultiplied overlay samples onto video samples
+///
+/// dst = overlay + dst * inverse_alpha / 255, vectorised with SSE2 or NEON where available. The same kernel is used for
+/// luma, planar chroma and interleaved chroma rows.
+///
+/// \param dst The video samples, blended in place
+/// \param overlay The premultiplied overlay samples
+/// \param inverse_alpha 255 minus the overlay alpha for each sample
+/// \param count The number of samples
+///
+void BlendRow(uint8_t *dst, const uint8_t *overlay, const uint8_t *inverse_alpha, int count);
+
+///
+/// \brief An overlay converted to premultiplied YUV, ready to blend onto decoded 4:2:0 frames
+///
+/// The ARGB composite is only converted where it was damaged. Rows the overlay does not touch are skipped entirely when
+/// blending, and touched rows only blend the span between the first and last visible pixel.
+///
+class YuvOverlay {
+ public:
+  ///
+  /// \brief Construct a new Yuv Overlay object
+  ///
+  ///
+  YuvOverlay() = default;
+
+  ///
+  /// \brief Convert the damaged areas of the ARGB composite
+  ///
+  /// The whole overlay is converted if the size or layout has changed.
+  ///
+  /// \param surface The premultiplied ARGB32 composite
+  /// \param damage The areas of the composite that changed
+  /// \param layout The layout of the frames that will be blended onto
+  ///
+  void Update(cairo_surface_t *surface, const std::vector<OverlayRect> &damage, YuvLayout layout);
+
+  ///
+  /// \brief Blend the overlay onto a frame in place
+  ///
+  /// \param planes The Y and chroma planes, two for NV12 and three for I420
+  /// \param strides The stride of each plane in bytes
+  ///
+  void Blend(uint8_t *const planes[3], const int strides[3]) const;
+
+  ///
+  /// \brief The overlay width
+  ///
+  /// \return int The width, zero before the first Update()
+  ///
+  int Width() const { return width_; }
+
+  ///
+  /// \brief The overlay height
+  ///
+  /// \return int The height, zero before the first Update()
+  ///
+  int Height() const { return height_; }
+
+ private:
+  /// \brief First and last+1 sample in a row that the overlay covers, empty if begin == end
+  struct Span {
+    /// \brief The first covered sample
+    int begin;
+    /// \brief One past the last covered sample
+    int end;
+  };
+
+  ///
+  /// \brief Convert a rectangle of the composite, rectangle must be on even coordinates
+  ///
+  /// \param pixels The ARGB32 pixels
+  /// \param stride The ARGB32 stride in bytes
+  /// \param rect The rectangle to convert
+  ///
+  void Convert(const uint8_t *pixels, int stride, const OverlayRect &rect);
+
+  ///
+  /// \brief Recalculate the spans for a range of luma rows and their chroma rows
+  ///
+  /// \param first The first luma row, even
+  /// \param last One past the last luma row, even
+  ///
+  void UpdateSpans(int first, int last);
+
+  /// \brief The overlay width
+  int width_ = 0;
+  /// \brief The overlay height
+  int height_ = 0;
+  /// \brief The layout being blended onto
+  YuvLayout layout_ = YuvLayout::kI420;
+  /// \brief Premultiplied luma, width_ x height_
+  std::vector<uint8_t> luma_;
+  /// \brief 255 minus alpha for each luma sample
+  std::vector<uint8_t> luma_alpha_;
+  /// \brief Premultiplied chroma, U and V planes for I420, interleaved UV in [0] for NV12
+  std::vector<uint8_t> chroma_[2];
+  /// \brief 255 minus alpha for each chroma sample, laid out as chroma_
+  std::vector<uint8_t> chroma_alpha_[2];
+  /// \brief Bytes per chroma row, half the width (rounded up) for I420 and twice that for NV12
+  int chroma_stride_ = 0;
+  /// \brief Covered span of each luma row
+  std::vector<Span> luma_spans_;
+  /// \brief Covered span of each chroma row, in bytes of chroma_
+  std::vector<Span> chroma_spans_;
+};
+
+#endif  // GST_TANK_OVERLAY_YUV_BLEND_H_
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Makes full frames from alternate fields, on packed 4:2:2 before any RGB conversion
+///
+/// \file deinterlacer.cc
+///
+
+#include "deinterlacer.h"
+
+#include <linux/videodev2.h>
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// A motion block, 16 pixels of 4:2:2 by 4 field lines
+static constexpr int kBlockBytes = 32;
+static constexpr int kBlockLines = 4;
+
+DeinterlaceMode ParseDeinterlaceMode(const std::string &name) {
+  if (name == "bob") return DeinterlaceMode::kBob;
+  if (name == "weave") return DeinterlaceMode::kWeave;
+  if (name == "adaptive") return DeinterlaceMode::kAdaptive;
+  throw std::runtime_error("Unknown deinterlace mode '" + name + "', expected bob, weave or adaptive");
+}
+
+void AverageRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int count) {
+  int i = 0;
+
+#if defined(__SSE2__)
+  for (; i + 16 <= count; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_avg_epu8(x, y));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 16 <= count; i += 16) {
+    vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+  }
+#endif
+
+  // Remainder, and the whole row on other architectures
+  for (; i < count; i++) dst[i] = static_cast<uint8_t>((a[i] + b[i] + 1) >> 1);
+}
+
+uint32_t RowDifference(const uint8_t *a, const uint8_t *b, int count) {
+  uint32_t sum = 0;
+  int i = 0;
+
+#if defined(__SSE2__)
+  __m128i total = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    // Two 16 bit sums, one per eight bytes, in the low halves of the 64 bit lanes
+    total = _mm_add_epi64(total, _mm_sad_epu8(x, y));
+  }
+  sum = _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+#elif defined(__ARM_NEON)
+  uint32x4_t total = vdupq_n_u32(0);
+  for (; i + 16 <= count; i += 16) {
+    total = vpadalq_u16(total, vpaddlq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+  }
+  uint64x2_t pairs = vpaddlq_u32(total);
+  sum = static_cast<uint32_t>(vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1));
+#endif
+
+  for (; i < count; i++) sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+  return sum;
+}
+
+Deinterlacer::Deinterlacer(DeinterlaceMode mode, int width, int height, int64_t field_period_ns, int motion_threshold)
+    : mode_(mode),
+      row_bytes_(width * 2),
+      field_lines_(height / 2),
+      field_period_ns_(field_period_ns),
+      block_threshold_(motion_threshold * kBlockBytes * kBlockLines),
+      blocks_across_((row_bytes_ + kBlockBytes - 1) / kBlockBytes),
+      blocks_down_((field_lines_ + kBlockLines - 1) / kBlockLines) {
+  for (Kept &kept : kept_) kept.lines.resize(static_cast<size_t>(row_bytes_) * field_lines_);
+  frame_.resize(static_cast<size_t>(row_bytes_) * field_lines_ * 2);
+  motion_.resize(blocks_across_ * blocks_down_);
+  grown_.resize(blocks_across_ * blocks_down_);
+  sums_.resize(blocks_across_);
+}
+
+void Deinterlacer::DetectMotion(const uint8_t *field, const uint8_t *previous) {
+  for (int by = 0; by < blocks_down_; by++) {
+    std::fill(sums_.begin(), sums_.end(), 0);
+    int last = std::min((by + 1) * kBlockLines, field_lines_);
+    for (int line = by * kBlockLines; line < last; line++) {
+      const uint8_t *a = field + line * row_bytes_;
+      const uint8_t *b = previous + line * row_bytes_;
+      for (int bx = 0; bx < blocks_across_; bx++) {
+        int start = bx * kBlockBytes;
+        sums_[bx] += RowDifference(a + start, b + start, std::min(kBlockBytes, row_bytes_ - start));
+      }
+    }
+    for (int bx = 0; bx < blocks_across_; bx++) motion_[by * blocks_across_ + bx] = sums_[bx] > block_threshold_;
+  }
+
+  // Grown by a block each way, so the edges of moving objects are bobbed too rather than combing
+  int moving = 0;
+  for (int by = 0; by < blocks_down_; by++) {
+    for (int bx = 0; bx < blocks_across_; bx++) {
+      uint8_t any = 0;
+      for (int y = std::max(by - 1, 0); y <= std::min(by + 1, blocks_down_ - 1) && !any; y++) {
+        for (int x = std::max(bx - 1, 0); x <= std::min(bx + 1, blocks_across_ - 1); x++) {
+          any |= motion_[y * blocks_across_ + x];
+        }
+      }
+      grown_[by * blocks_across_ + bx] = any;
+      moving += any;
+    }
+  }
+  motion_fraction_ = static_cast<double>(moving) / grown_.size();
+}
+
+const uint8_t *Deinterlacer::Field(const uint8_t *field, int parity, int64_t timestamp_ns) {
+  int own = parity == V4L2_FIELD_BOTTOM ? 1 : 0;
+  Kept &opposite = kept_[1 - own];
+  Kept &same = kept_[own];
+
+  // Only woven with the field captured just before, and motion only measured against a field a frame before
+  int64_t since_opposite = timestamp_ns - opposite.timestamp_ns;
+  int64_t since_same = timestamp_ns - same.timestamp_ns;
+  bool paired = opposite.timestamp_ns && since_opposite > 0 && since_opposite < field_period_ns_ * 3 / 2;
+  bool comparable = same.timestamp_ns && since_same > 0 && since_same < field_period_ns_ * 5 / 2;
+  if (mode_ != DeinterlaceMode::kBob && !paired) unpaired_++;
+
+  bool weave = paired && mode_ == DeinterlaceMode::kWeave;
+  bool adaptive = paired && mode_ == DeinterlaceMode::kAdaptive;
+  if (adaptive && comparable) {
+    DetectMotion(field, same.lines.data());
+  } else if (adaptive) {
+    // Nothing to measure motion against, so all of it is treated as moving
+    std::fill(grown_.begin(), grown_.end(), 1);
+    motion_fraction_ = 1;
+  }
+
+  for (int line = 0; line < field_lines_; line++) {
+    memcpy(&frame_[(2 * line + own) * row_bytes_], field + line * row_bytes_, row_bytes_);
+  }
+
+  for (int line = 0; line < field_lines_; line++) {
+    uint8_t *out = &frame_[(2 * line + 1 - own) * row_bytes_];
+    // The field's lines either side of the missing one, the edge line repeated at the top or bottom
+    const uint8_t *above = field + (own ? std::max(line - 1, 0) : line) * row_bytes_;
+    const uint8_t *below = field + (own ? line : std::min(line + 1, field_lines_ - 1)) * row_bytes_;
+    const uint8_t *woven = opposite.lines.data() + line * row_bytes_;
+
+    if (weave) {
+      memcpy(out, woven, row_bytes_);
+    } else if (!adaptive) {
+      AverageRows(out, above, below, row_bytes_);
+    } else {
+      // Runs of blocks with the same decision, so still areas are one copy and moving ones one average
+      const uint8_t *moving = &grown_[(line / kBlockLines) * blocks_across_];
+      for (int bx = 0; bx < blocks_across_;) {
+        int end = bx + 1;
+        while (end < blocks_across_ && moving[end] == moving[bx]) end++;
+        int start = bx * kBlockBytes;
+        int bytes = std::min(end * kBlockBytes, row_bytes_) - start;
+        if (moving[bx]) {
+          AverageRows(out + start, above + start, below + start, bytes);
+        } else {
+          memcpy(out + start, woven + start, bytes);
+        }
+        bx = end;
+      }
+    }
+  }
+
+  // Kept for the next field to weave with and the one after to compare against
+  memcpy(same.lines.data(), field, same.lines.size());
+  same.timestamp_ns = timestamp_ns;
+  return frame_.data();
+}
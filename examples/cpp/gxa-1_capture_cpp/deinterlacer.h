@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Makes full frames from alternate fields, on packed 4:2:2 before any RGB conversion
+///
+/// \file deinterlacer.h
+///
+
+#ifndef DEINTERLACER_H
+#define DEINTERLACER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \brief How the lines missing from a field are made
+enum class DeinterlaceMode {
+  /// \brief Interpolated from the lines above and below, no combing but half the vertical detail
+  kBob,
+  /// \brief Taken from the field before, full detail when still but combs on motion
+  kWeave,
+  /// \brief Weave where the picture is still and bob where it moves, decided per block
+  kAdaptive
+};
+
+///
+/// \brief Parse a deinterlace mode name
+///
+/// \param name bob, weave or adaptive, throws std::runtime_error otherwise
+/// \return DeinterlaceMode The mode
+///
+DeinterlaceMode ParseDeinterlaceMode(const std::string &name);
+
+///
+/// \brief Average two rows of bytes, rounding up, the bob interpolation
+///
+/// \param dst The result, count bytes
+/// \param a One row
+/// \param b The other row
+/// \param count Bytes in a row
+///
+void AverageRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int count);
+
+///
+/// \brief Sum of absolute differences between two rows of bytes, the motion measure
+///
+/// \param a One row
+/// \param b The other row
+/// \param count Bytes in a row
+/// \return uint32_t The sum
+///
+uint32_t RowDifference(const uint8_t *a, const uint8_t *b, int count);
+
+///
+/// \brief Turns each field of a V4L2_FIELD_ALTERNATE capture into a full frame, so the output runs at the field rate
+///
+/// Works on YUYV or UYVY as captured, so each output frame is converted to RGB once, at full size. The field's own
+/// lines are copied and the others made according to the mode. Weave takes them from the opposite field only when
+/// it is the one captured just before, judged by the capture timestamps, so a dropped field is bobbed rather than
+/// woven with a stale one. The adaptive mode compares each field with the last field of the same parity, a frame
+/// earlier, in blocks of 16 pixels by 4 field lines, and bobs blocks that have changed and their neighbours.
+///
+class Deinterlacer {
+ public:
+  ///
+  /// \brief Construct a new Deinterlacer object
+  ///
+  /// \param mode How the missing lines are made
+  /// \param width Width in pixels
+  /// \param height Frame height in lines, twice the field height
+  /// \param field_period_ns Time between fields, 20 ms for PAL
+  /// \param motion_threshold Mean byte difference over a block above which it is taken to be moving
+  ///
+  Deinterlacer(DeinterlaceMode mode, int width, int height, int64_t field_period_ns, int motion_threshold = 6);
+
+  ///
+  /// \brief Make a frame from a field
+  ///
+  /// \param field The field, width * 2 bytes per line, height / 2 lines
+  /// \param parity V4L2_FIELD_TOP, the frame's even lines, or V4L2_FIELD_BOTTOM, the odd lines
+  /// \param timestamp_ns When the field was captured
+  /// \return const uint8_t* The frame, width * 2 bytes per line, valid until the next call
+  ///
+  const uint8_t *Field(const uint8_t *field, int parity, int64_t timestamp_ns);
+
+  ///
+  /// \brief The mode
+  ///
+  /// \return DeinterlaceMode How the missing lines are made
+  ///
+  DeinterlaceMode Mode() const { return mode_; }
+
+  ///
+  /// \brief Fields that had no opposite field just before them and were bobbed, since the last call
+  ///
+  /// \return uint64_t The count
+  ///
+  uint64_t TakeUnpaired() { return std::exchange(unpaired_, 0); }
+
+  ///
+  /// \brief Fraction of the last field's blocks that were bobbed as moving, in the adaptive mode
+  ///
+  /// \return double 0 to 1
+  ///
+  double Motion() const { return motion_fraction_; }
+
+ private:
+  /// \brief A field kept for the next ones
+  struct Kept {
+    /// \brief The lines
+    std::vector<uint8_t> lines;
+    /// \brief When it was captured, 0 if there has not been one
+    int64_t timestamp_ns = 0;
+  };
+
+  ///
+  /// \brief Mark moving blocks in motion_, comparing the field with the last of its parity
+  ///
+  /// \param field The new field
+  /// \param previous The last field of the same parity
+  ///
+  void DetectMotion(const uint8_t *field, const uint8_t *previous);
+
+  /// \brief How the missing lines are made
+  DeinterlaceMode mode_;
+  /// \brief Bytes per line
+  int row_bytes_;
+  /// \brief Lines in a field
+  int field_lines_;
+  /// \brief Time between fields
+  int64_t field_period_ns_;
+  /// \brief Block difference above which it is moving
+  uint32_t block_threshold_;
+  /// \brief Blocks across
+  int blocks_across_;
+  /// \brief Blocks down
+  int blocks_down_;
+  /// \brief The last top and bottom fields
+  Kept kept_[2];
+  /// \brief The output frame
+  std::vector<uint8_t> frame_;
+  /// \brief One per block, non zero if moving
+  std::vector<uint8_t> motion_;
+  /// \brief motion_ grown by a block each way
+  std::vector<uint8_t> grown_;
+  /// \brief Difference of each block across a row of blocks, sized once
+  std::vector<uint32_t> sums_;
+  /// \brief Fields bobbed for want of an opposite field
+  uint64_t unpaired_ = 0;
+  /// \brief Fraction of blocks moving in the last field
+  double motion_fraction_ = 0;
+};
+
+#endif  // DEINTERLACER_H
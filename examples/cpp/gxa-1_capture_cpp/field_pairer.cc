@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Weaves the two fields of each frame of a V4L2_FIELD_ALTERNATE capture into one full frame
+///
+/// \file field_pairer.cc
+///
+
+#include "field_pairer.h"
+
+#include <linux/videodev2.h>
+#include <string.h>
+
+#include <algorithm>
+
+FieldPairer::FieldPairer(int width, int height, int bytes_per_pixel, int64_t field_period_ns, bool top_first,
+                         int pool)
+    : stride_(width * bytes_per_pixel),
+      field_lines_(height / 2),
+      field_period_ns_(field_period_ns),
+      first_parity_(top_first ? V4L2_FIELD_TOP : V4L2_FIELD_BOTTOM),
+      frames_(std::max(pool, 2), std::vector<uint8_t>(static_cast<size_t>(stride_) * field_lines_ * 2)) {}
+
+const uint8_t *FieldPairer::Field(const uint8_t *field, int parity, int64_t timestamp_ns) {
+  bool first = parity == first_parity_;
+  if (!first && !have_first_) {
+    stats_.unpaired++;
+    return nullptr;
+  }
+  int64_t since_first = timestamp_ns - first_timestamp_ns_;
+  if (!first && (since_first <= 0 || since_first >= field_period_ns_ * 3 / 2)) {
+    // A field was lost between them, so they are from different frames
+    stats_.unpaired += 2;
+    have_first_ = false;
+    return nullptr;
+  }
+  if (first && have_first_) stats_.unpaired++;
+
+  // Every other line of the frame, top on the even lines
+  uint8_t *frame = frames_[next_].data();
+  uint8_t *line = frame + (parity == V4L2_FIELD_BOTTOM ? stride_ : 0);
+  for (int i = 0; i < field_lines_; i++, line += stride_ * 2) memcpy(line, field + i * stride_, stride_);
+
+  if (first) {
+    have_first_ = true;
+    first_timestamp_ns_ = timestamp_ns;
+    return nullptr;
+  }
+  have_first_ = false;
+  next_ = (next_ + 1) % frames_.size();
+  stats_.frames++;
+  return frame;
+}
+
+FieldPairStats FieldPairer::TakeStats() {
+  FieldPairStats stats = stats_;
+  stats_ = {};
+  return stats;
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Weaves the two fields of each frame of a V4L2_FIELD_ALTERNATE capture into one full frame
+///
+/// \file field_pairer.h
+///
+
+#ifndef FIELD_PAIRER_H
+#define FIELD_PAIRER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/// \brief Fields paired and lost since the last TakeStats()
+struct FieldPairStats {
+  /// \brief Frames woven
+  uint64_t frames = 0;
+  /// \brief Fields dropped because the other field of their frame never came
+  uint64_t unpaired = 0;
+};
+
+///
+/// \brief Turns alternate fields back into frames, at the frame rate
+///
+/// The first field of a frame is copied straight into the even or odd lines of a frame from a small pool, and the
+/// second into the others, so each line is copied once and nothing downstream sees a field. The second field must
+/// follow the first by a field period, judged by the capture timestamps. A first field with no second, or a second
+/// with no first, is dropped rather than woven with a field from another frame. The frames are used in turn, so a
+/// frame stays valid while the next is being filled.
+///
+class FieldPairer {
+ public:
+  ///
+  /// \brief Construct a new Field Pairer object
+  ///
+  /// \param width Width in pixels
+  /// \param height Frame height in lines, twice the field height
+  /// \param bytes_per_pixel 2 for YUYV or UYVY
+  /// \param field_period_ns Time between fields, 20 ms for PAL
+  /// \param top_first The top field is captured first, as in PAL, false for NTSC where the bottom is
+  /// \param pool Frames used in turn, at least 2
+  ///
+  FieldPairer(int width, int height, int bytes_per_pixel, int64_t field_period_ns, bool top_first = true,
+              int pool = 2);
+
+  ///
+  /// \brief Add a field
+  ///
+  /// \param field The field, height / 2 lines
+  /// \param parity V4L2_FIELD_TOP, the frame's even lines, or V4L2_FIELD_BOTTOM, the odd lines
+  /// \param timestamp_ns When the field was captured
+  /// \return const uint8_t* The frame when this field completes it, valid until the frame after next completes,
+  /// otherwise nullptr
+  ///
+  const uint8_t *Field(const uint8_t *field, int parity, int64_t timestamp_ns);
+
+  ///
+  /// \brief When the first field of the last frame was captured, the frame's timestamp
+  ///
+  /// \return int64_t CLOCK_MONOTONIC nanoseconds
+  ///
+  int64_t TimestampNs() const { return first_timestamp_ns_; }
+
+  ///
+  /// \brief Bytes in a frame
+  ///
+  /// \return size_t stride * height
+  ///
+  size_t Bytes() const { return frames_[0].size(); }
+
+  ///
+  /// \brief Frames woven and fields dropped since the last call
+  ///
+  /// \return FieldPairStats The counts, which are then reset
+  ///
+  FieldPairStats TakeStats();
+
+ private:
+  /// \brief Bytes per line
+  int stride_;
+  /// \brief Lines in a field
+  int field_lines_;
+  /// \brief Time between fields
+  int64_t field_period_ns_;
+  /// \brief Parity of the first field of a frame
+  int first_parity_;
+  /// \brief The frames, used in turn
+  std::vector<std::vector<uint8_t>> frames_;
+  /// \brief The frame being filled
+  size_t next_ = 0;
+  /// \brief The first field is in frames_[next_]
+  bool have_first_ = false;
+  /// \brief When that first field was captured
+  int64_t first_timestamp_ns_ = 0;
+  /// \brief Counts since TakeStats()
+  FieldPairStats stats_;
+};
+
+#endif  // FIELD_PAIRER_H
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Where captured frames go, other than the display
+///
+/// \file frame_sink.h
+///
+
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// \brief A captured frame, in the driver's buffer
+struct CapturedFrame {
+  /// \brief The frame, or field when interlaced, valid only for the duration of Consume()
+  const uint8_t *data;
+  /// \brief Bytes of image data
+  size_t bytes;
+  /// \brief Width in pixels
+  int width;
+  /// \brief Height in lines, half the frame height for a field
+  int height;
+  /// \brief Bytes per line
+  int stride;
+  /// \brief The V4L2 fourcc, V4L2_PIX_FMT_YUYV or V4L2_PIX_FMT_UYVY
+  uint32_t pixelformat;
+  /// \brief V4L2_FIELD_TOP, V4L2_FIELD_BOTTOM, V4L2_FIELD_ANY for a whole frame, or V4L2_FIELD_INTERLACED for
+  /// two fields woven into one
+  int field;
+  /// \brief The driver's frame sequence number
+  uint32_t sequence;
+  /// \brief When the frame was captured, CLOCK_MONOTONIC nanoseconds
+  int64_t timestamp_ns;
+  /// \brief The V4L2 buffer index, -1 for read() i/o or a frame not in the driver's buffer
+  int buffer_index;
+};
+
+///
+/// \brief Receives each captured frame straight from the driver's buffer
+///
+class FrameSink {
+ public:
+  ///
+  /// \brief Destroy the Frame Sink object
+  ///
+  ///
+  virtual ~FrameSink() = default;
+
+  ///
+  /// \brief Handle a frame, called on the capture thread before the buffer is given back to the driver
+  ///
+  /// \param frame The frame
+  ///
+  virtual void Consume(const CapturedFrame &frame) = 0;
+};
+
+#endif  // FRAME_SINK_H
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Groups frames from several channels that were captured at the same time
+///
+/// \file frame_synchroniser.cc
+///
+
+#include "frame_synchroniser.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+FrameSynchroniser::FrameSynchroniser(int channels, int64_t tolerance_ns, size_t queue_bundles, size_t pending_frames)
+    : tolerance_ns_(tolerance_ns),
+      queue_bundles_(std::max<size_t>(queue_bundles, 1)),
+      pending_frames_(std::max<size_t>(pending_frames, 1)),
+      pool_(std::make_shared<Pool>()),
+      pending_(channels) {
+  for (int channel = 0; channel < channels; channel++) {
+    sinks_.push_back(std::make_unique<ChannelSink>(this, channel));
+  }
+  stats_.channels.resize(channels);
+}
+
+std::shared_ptr<std::vector<uint8_t>> FrameSynchroniser::Buffer(size_t bytes) {
+  std::vector<uint8_t> *buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(pool_->mutex);
+    if (!pool_->free.empty()) {
+      buffer = pool_->free.back();
+      pool_->free.pop_back();
+    }
+  }
+  if (!buffer) buffer = new std::vector<uint8_t>();
+  // Only grows, so a reused buffer is not reallocated
+  if (buffer->size() < bytes) buffer->resize(bytes);
+
+  std::shared_ptr<Pool> pool = pool_;
+  return std::shared_ptr<std::vector<uint8_t>>(buffer, [pool](std::vector<uint8_t> *released) {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->free.push_back(released);
+  });
+}
+
+void FrameSynchroniser::Push(int channel, const CapturedFrame &frame) {
+  // Copied before taking the lock, so the channels copy in parallel
+  SyncedFrame synced;
+  synced.image = Buffer(frame.bytes);
+  memcpy(synced.image->data(), frame.data, frame.bytes);
+  synced.frame = frame;
+  synced.frame.data = synced.image->data();
+  synced.frame.buffer_index = -1;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::deque<SyncedFrame> &pending = pending_[channel];
+  stats_.channels[channel].frames++;
+  // The other channels are not keeping up, or have stopped
+  if (pending.size() >= pending_frames_) {
+    pending.pop_front();
+    stats_.channels[channel].dropped++;
+  }
+  pending.push_back(std::move(synced));
+  Match();
+}
+
+void FrameSynchroniser::Match() {
+  for (;;) {
+    int64_t newest = 0;
+    for (const std::deque<SyncedFrame> &pending : pending_) {
+      if (pending.empty()) return;
+      newest = std::max(newest, pending.front().frame.timestamp_ns);
+    }
+
+    // Frames too far behind the newest can never be matched
+    bool dropped = false;
+    for (size_t channel = 0; channel < pending_.size(); channel++) {
+      if (newest - pending_[channel].front().frame.timestamp_ns > tolerance_ns_) {
+        pending_[channel].pop_front();
+        stats_.channels[channel].dropped++;
+        dropped = true;
+      }
+    }
+    if (dropped) continue;
+
+    FrameBundle bundle;
+    bundle.index = index_++;
+    bundle.timestamp_ns = newest;
+    for (std::deque<SyncedFrame> &pending : pending_) {
+      bundle.timestamp_ns = std::min(bundle.timestamp_ns, pending.front().frame.timestamp_ns);
+    }
+    bundle.skew_ns = newest - bundle.timestamp_ns;
+    bundle.frames.reserve(pending_.size());
+    for (size_t channel = 0; channel < pending_.size(); channel++) {
+      ChannelSyncStats &stats = stats_.channels[channel];
+      int64_t offset = pending_[channel].front().frame.timestamp_ns - bundle.timestamp_ns;
+      stats.bundled++;
+      stats.offset_sum_ns += offset;
+      stats.offset_max_ns = std::max(stats.offset_max_ns, offset);
+      bundle.frames.push_back(std::move(pending_[channel].front()));
+      pending_[channel].pop_front();
+    }
+    stats_.bundles++;
+    stats_.skew_sum_ns += bundle.skew_ns;
+    stats_.skew_max_ns = std::max(stats_.skew_max_ns, bundle.skew_ns);
+
+    if (queue_.size() >= queue_bundles_) {
+      queue_.pop_front();
+      stats_.queue_dropped++;
+    }
+    queue_.push_back(std::move(bundle));
+    ready_.notify_one();
+  }
+}
+
+bool FrameSynchroniser::Pop(FrameBundle *bundle, int timeout_ms) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return !queue_.empty(); })) {
+    return false;
+  }
+  *bundle = std::move(queue_.front());
+  queue_.pop_front();
+  return true;
+}
+
+SyncStats FrameSynchroniser::TakeStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SyncStats stats = std::move(stats_);
+  stats_ = SyncStats();
+  stats_.channels.resize(stats.channels.size());
+  return stats;
+}
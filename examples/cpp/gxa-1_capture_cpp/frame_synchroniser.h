@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Groups frames from several channels that were captured at the same time
+///
+/// \file frame_synchroniser.h
+///
+
+#ifndef FRAME_SYNCHRONISER_H
+#define FRAME_SYNCHRONISER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "frame_sink.h"
+
+///
+/// \brief A frame copied out of the driver's buffer, kept for as long as a bundle holds it
+///
+///
+struct SyncedFrame {
+  /// \brief The frame, data points into image
+  CapturedFrame frame;
+  /// \brief The copy, returned to the synchroniser's pool when the last holder lets it go
+  std::shared_ptr<std::vector<uint8_t>> image;
+};
+
+///
+/// \brief One frame from every channel, captured within the tolerance of each other
+///
+///
+struct FrameBundle {
+  /// \brief Counts the bundles made, a gap means the queue was full
+  uint64_t index = 0;
+  /// \brief Capture time of the earliest frame, CLOCK_MONOTONIC nanoseconds
+  int64_t timestamp_ns = 0;
+  /// \brief Latest capture time less the earliest
+  int64_t skew_ns = 0;
+  /// \brief The frames, in channel order
+  std::vector<SyncedFrame> frames;
+};
+
+///
+/// \brief Statistics for one channel
+///
+///
+struct ChannelSyncStats {
+  /// \brief Frames received from the capture
+  uint64_t frames = 0;
+  /// \brief Frames put in a bundle
+  uint64_t bundled = 0;
+  /// \brief Frames with no match in the other channels, or that waited too long for one
+  uint64_t dropped = 0;
+  /// \brief Sum over bundles of this channel's capture time less the bundle's
+  int64_t offset_sum_ns = 0;
+  /// \brief The largest capture time less the bundle's
+  int64_t offset_max_ns = 0;
+};
+
+///
+/// \brief Statistics since the last call to FrameSynchroniser::TakeStats()
+///
+///
+struct SyncStats {
+  /// \brief One per channel
+  std::vector<ChannelSyncStats> channels;
+  /// \brief Bundles made
+  uint64_t bundles = 0;
+  /// \brief Bundles dropped because the consumer did not take them in time
+  uint64_t queue_dropped = 0;
+  /// \brief Sum of the bundles' skew
+  int64_t skew_sum_ns = 0;
+  /// \brief The largest skew
+  int64_t skew_max_ns = 0;
+};
+
+///
+/// \brief Takes frames from N captures, each through its own sink, and bundles those captured together
+///
+/// Frames are matched on the driver's capture timestamp, CLOCK_MONOTONIC on every channel of the card. When every
+/// channel has a frame waiting, the oldest waiting frames are bundled if they are all within the tolerance of the
+/// newest of them; a frame further back than that can never be matched, since later frames only get later, and is
+/// dropped. A channel that stops delivering holds up the others for at most pending_frames frames. Bundles go to a
+/// bounded queue, and when the consumer falls behind the oldest bundle is dropped so the captures never wait.
+///
+/// Each frame is copied once, into a pooled buffer, so the driver gets its buffer straight back.
+///
+class FrameSynchroniser {
+ public:
+  ///
+  /// \brief Construct a new Frame Synchroniser object
+  ///
+  /// \param channels Number of channels
+  /// \param tolerance_ns Most a bundle's capture times may differ by, under half a frame period to avoid pairing
+  /// neighbouring frames
+  /// \param queue_bundles Bundles waiting for the consumer before the oldest is dropped
+  /// \param pending_frames Frames a channel holds while waiting for the others
+  ///
+  FrameSynchroniser(int channels, int64_t tolerance_ns, size_t queue_bundles = 4, size_t pending_frames = 4);
+
+  ///
+  /// \brief The sink to add to a channel's capture, called on that capture's thread
+  ///
+  /// \param channel 0 to channels - 1
+  /// \return FrameSink* The sink, owned by the synchroniser
+  ///
+  FrameSink *Channel(int channel) { return sinks_.at(channel).get(); }
+
+  ///
+  /// \brief Wait for the next bundle
+  ///
+  /// \param bundle Replaced by the bundle
+  /// \param timeout_ms Longest wait
+  /// \return true if there was a bundle
+  ///
+  bool Pop(FrameBundle *bundle, int timeout_ms);
+
+  ///
+  /// \brief The statistics since the last call, and reset them
+  ///
+  /// \return SyncStats The statistics
+  ///
+  SyncStats TakeStats();
+
+ private:
+  ///
+  /// \brief Feeds one channel's frames to the synchroniser
+  ///
+  class ChannelSink : public FrameSink {
+   public:
+    ///
+    /// \brief Construct a new Channel Sink object
+    ///
+    /// \param synchroniser The synchroniser
+    /// \param channel The channel
+    ///
+    ChannelSink(FrameSynchroniser *synchroniser, int channel) : synchroniser_(synchroniser), channel_(channel) {}
+
+    ///
+    /// \brief Pass the frame on
+    ///
+    /// \param frame The captured frame
+    ///
+    void Consume(const CapturedFrame &frame) final { synchroniser_->Push(channel_, frame); }
+
+   private:
+    /// \brief The synchroniser
+    FrameSynchroniser *synchroniser_;
+    /// \brief The channel
+    int channel_;
+  };
+
+  ///
+  /// \brief Pooled buffers, shared with the frames so a bundle can outlive the synchroniser
+  ///
+  struct Pool {
+    /// \brief Buffers not in use
+    std::vector<std::vector<uint8_t> *> free;
+    /// \brief Protects free
+    std::mutex mutex;
+    ///
+    /// \brief Destroy the Pool object and the free buffers
+    ///
+    ///
+    ~Pool() {
+      for (std::vector<uint8_t> *buffer : free) delete buffer;
+    }
+  };
+
+  ///
+  /// \brief Copy a frame in and bundle what can be
+  ///
+  /// \param channel The channel
+  /// \param frame The captured frame
+  ///
+  void Push(int channel, const CapturedFrame &frame);
+
+  ///
+  /// \brief Make every bundle the waiting frames allow, with mutex_ held
+  ///
+  ///
+  void Match();
+
+  ///
+  /// \brief A buffer from the pool
+  ///
+  /// \param bytes The size needed
+  /// \return std::shared_ptr<std::vector<uint8_t>> The buffer, back to the pool when released
+  ///
+  std::shared_ptr<std::vector<uint8_t>> Buffer(size_t bytes);
+
+  /// \brief One sink per channel
+  std::vector<std::unique_ptr<ChannelSink>> sinks_;
+  /// \brief Most a bundle's capture times may differ by
+  int64_t tolerance_ns_;
+  /// \brief Bundles waiting before the oldest is dropped
+  size_t queue_bundles_;
+  /// \brief Frames a channel holds while waiting for the others
+  size_t pending_frames_;
+  /// \brief Buffers for the copies
+  std::shared_ptr<Pool> pool_;
+  /// \brief Protects everything below
+  std::mutex mutex_;
+  /// \brief Signalled when a bundle is queued
+  std::condition_variable ready_;
+  /// \brief Frames waiting for a match, oldest first, per channel
+  std::vector<std::deque<SyncedFrame>> pending_;
+  /// \brief Bundles waiting for the consumer
+  std::deque<FrameBundle> queue_;
+  /// \brief Index of the next bundle
+  uint64_t index_ = 0;
+  /// \brief The statistics so far
+  SyncStats stats_;
+};
+
+#endif  // FRAME_SYNCHRONISER_H
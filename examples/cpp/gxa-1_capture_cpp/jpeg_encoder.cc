@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief JPEG encoding of packed 4:2:2 frames through libjpeg-turbo's raw data interface, and a pool of encoders
+///
+/// \file jpeg_encoder.cc
+///
+
+#include "jpeg_encoder.h"
+
+#include <linux/videodev2.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// First size of the output buffer, a typical PAL frame at quality 85 fits
+static constexpr size_t kInitialJpegBytes = 128 * 1024;
+
+void SplitYuv422(uint8_t *y, uint8_t *cb, uint8_t *cr, const uint8_t *src, int width, bool uyvy) {
+  int i = 0;
+
+#if defined(__SSE2__)
+  // Sixteen pixels at a time, the luma bytes and the chroma bytes each packed together, then the chroma split
+  const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+  for (; i + 16 <= width; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2 + 16));
+    __m128i even = _mm_packus_epi16(_mm_and_si128(a, low_bytes), _mm_and_si128(b, low_bytes));
+    __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    __m128i chroma = uyvy ? even : odd;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(y + i), uyvy ? odd : even);
+    __m128i c = _mm_packus_epi16(_mm_and_si128(chroma, low_bytes), _mm_srli_epi16(chroma, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(cb + i / 2), c);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(cr + i / 2), _mm_srli_si128(c, 8));
+  }
+#elif defined(__ARM_NEON)
+  // Thirty two pixels at a time, split into the four bytes of each macropixel by the load
+  for (; i + 32 <= width; i += 32) {
+    uint8x16x4_t pixels = vld4q_u8(src + i * 2);
+    uint8x16x2_t luma;
+    luma.val[0] = pixels.val[uyvy ? 1 : 0];
+    luma.val[1] = pixels.val[uyvy ? 3 : 2];
+    vst2q_u8(y + i, luma);
+    vst1q_u8(cb + i / 2, pixels.val[uyvy ? 0 : 1]);
+    vst1q_u8(cr + i / 2, pixels.val[uyvy ? 2 : 3]);
+  }
+#endif
+
+  // Remainder, and the whole line on other architectures
+  const int y0 = uyvy ? 1 : 0;
+  const int u = uyvy ? 0 : 1;
+  for (; i + 2 <= width; i += 2) {
+    const uint8_t *pixel = src + i * 2;
+    y[i] = pixel[y0];
+    y[i + 1] = pixel[y0 + 2];
+    cb[i / 2] = pixel[u];
+    cr[i / 2] = pixel[u + 2];
+  }
+}
+
+JpegEncoder::JpegEncoder(int quality) : quality_(std::clamp(quality, 1, 100)) {
+  compress_.err = jpeg_std_error(&error_.manager);
+  error_.manager.error_exit = [](j_common_ptr info) { longjmp(reinterpret_cast<Error *>(info->err)->jump, 1); };
+  jpeg_create_compress(&compress_);
+
+  destination_.out = nullptr;
+  destination_.manager.init_destination = [](j_compress_ptr compress) {
+    Destination *destination = reinterpret_cast<Destination *>(compress->dest);
+    destination->out->resize(std::max(destination->out->capacity(), kInitialJpegBytes));
+    destination->manager.next_output_byte = destination->out->data();
+    destination->manager.free_in_buffer = destination->out->size();
+  };
+  destination_.manager.empty_output_buffer = [](j_compress_ptr compress) -> boolean {
+    // Called only when the buffer is full, so all of it is used
+    Destination *destination = reinterpret_cast<Destination *>(compress->dest);
+    size_t used = destination->out->size();
+    destination->out->resize(used * 2);
+    destination->manager.next_output_byte = destination->out->data() + used;
+    destination->manager.free_in_buffer = destination->out->size() - used;
+    return TRUE;
+  };
+  destination_.manager.term_destination = [](j_compress_ptr compress) {
+    Destination *destination = reinterpret_cast<Destination *>(compress->dest);
+    destination->out->resize(destination->out->size() - destination->manager.free_in_buffer);
+  };
+  compress_.dest = &destination_.manager;
+}
+
+JpegEncoder::~JpegEncoder() { jpeg_destroy_compress(&compress_); }
+
+void JpegEncoder::Encode(const CapturedFrame &frame, std::vector<uint8_t> *jpeg) {
+  // Whole MCUs of 16x8 luma and 8x8 of each chroma, the right edge repeated into the padding
+  int width = frame.width & ~1;
+  int luma_stride = (width + 15) & ~15;
+  int chroma_stride = luma_stride / 2;
+  y_.resize(luma_stride * DCTSIZE);
+  cb_.resize(chroma_stride * DCTSIZE);
+  cr_.resize(chroma_stride * DCTSIZE);
+  JSAMPROW y_rows[DCTSIZE];
+  JSAMPROW cb_rows[DCTSIZE];
+  JSAMPROW cr_rows[DCTSIZE];
+  for (int i = 0; i < DCTSIZE; i++) {
+    y_rows[i] = &y_[i * luma_stride];
+    cb_rows[i] = &cb_[i * chroma_stride];
+    cr_rows[i] = &cr_[i * chroma_stride];
+  }
+  JSAMPARRAY planes[3] = {y_rows, cb_rows, cr_rows};
+  bool uyvy = frame.pixelformat == V4L2_PIX_FMT_UYVY;
+  destination_.out = jpeg;
+
+  if (setjmp(error_.jump)) {
+    char message[JMSG_LENGTH_MAX];
+    (*compress_.err->format_message)(reinterpret_cast<j_common_ptr>(&compress_), message);
+    jpeg_abort_compress(&compress_);
+    throw std::runtime_error(std::string("JPEG encode: ") + message);
+  }
+
+  compress_.image_width = width;
+  compress_.image_height = frame.height;
+  compress_.input_components = 3;
+  compress_.in_color_space = JCS_YCbCr;
+  jpeg_set_defaults(&compress_);
+  jpeg_set_quality(&compress_, quality_, TRUE);
+  // The planes as they are, luma at twice the horizontal rate of chroma and the same vertical rate
+  compress_.raw_data_in = TRUE;
+  compress_.comp_info[0].h_samp_factor = 2;
+  compress_.comp_info[0].v_samp_factor = 1;
+  for (int component = 1; component < 3; component++) {
+    compress_.comp_info[component].h_samp_factor = 1;
+    compress_.comp_info[component].v_samp_factor = 1;
+  }
+  jpeg_start_compress(&compress_, TRUE);
+
+  for (int line = 0; line < frame.height; line += DCTSIZE) {
+    for (int i = 0; i < DCTSIZE; i++) {
+      // The last line repeated to fill the last strip
+      const uint8_t *src = frame.data + static_cast<size_t>(std::min(line + i, frame.height - 1)) * frame.stride;
+      SplitYuv422(y_rows[i], cb_rows[i], cr_rows[i], src, width, uyvy);
+      memset(y_rows[i] + width, y_rows[i][width - 1], luma_stride - width);
+      memset(cb_rows[i] + width / 2, cb_rows[i][width / 2 - 1], chroma_stride - width / 2);
+      memset(cr_rows[i] + width / 2, cr_rows[i][width / 2 - 1], chroma_stride - width / 2);
+    }
+    jpeg_write_raw_data(&compress_, planes, DCTSIZE);
+  }
+  jpeg_finish_compress(&compress_);
+}
+
+JpegWorkers::JpegWorkers(int threads, int quality) : quality_(quality) {
+  if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 0; i < threads; i++) threads_.emplace_back(&JpegWorkers::Run, this);
+}
+
+JpegWorkers::~JpegWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread &thread : threads_) thread.join();
+}
+
+void JpegWorkers::Submit(const CapturedFrame &frame, std::shared_ptr<const std::vector<uint8_t>> image, Done done) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back({frame, std::move(image), std::move(done)});
+  }
+  ready_.notify_one();
+}
+
+void JpegWorkers::Run() {
+  JpegEncoder encoder(quality_);
+  std::vector<uint8_t> jpeg;
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    try {
+      encoder.Encode(job.frame, &jpeg);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << "\n";
+      jpeg.clear();
+    }
+    // The frame is let go first, so a sink waiting for its last frame can go once it has the JPEG
+    job.image.reset();
+    job.done(jpeg);
+  }
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief JPEG encoding of packed 4:2:2 frames through libjpeg-turbo's raw data interface, and a pool of encoders
+///
+/// \file jpeg_encoder.h
+///
+
+#ifndef JPEG_ENCODER_H
+#define JPEG_ENCODER_H
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>  // for jpeglib.h
+
+#include <jpeglib.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "frame_sink.h"
+
+///
+/// \brief Split a line of YUYV or UYVY into its Y, Cb and Cr planes
+///
+/// \param y Luma, width bytes
+/// \param cb Blue difference, width / 2 bytes
+/// \param cr Red difference, width / 2 bytes
+/// \param src The packed line
+/// \param width Pixels, even
+/// \param uyvy The bytes are U Y0 V Y1, otherwise Y0 U Y1 V
+///
+void SplitYuv422(uint8_t *y, uint8_t *cb, uint8_t *cr, const uint8_t *src, int width, bool uyvy);
+
+///
+/// \brief Encodes frames as baseline 4:2:2 JPEG straight from the captured YCbCr
+///
+/// The frame is split into planes eight lines at a time and handed to libjpeg-turbo as raw downsampled data, so
+/// there is no conversion to RGB and back, and no chroma resampling, 4:2:2 in and 4:2:2 out. One encoder is used
+/// by one thread at a time, and keeps its compressor and buffers from frame to frame.
+///
+class JpegEncoder {
+ public:
+  ///
+  /// \brief Construct a new Jpeg Encoder object
+  ///
+  /// \param quality 1 to 100
+  ///
+  explicit JpegEncoder(int quality = 85);
+
+  ///
+  /// \brief Destroy the Jpeg Encoder object
+  ///
+  ///
+  ~JpegEncoder();
+
+  JpegEncoder(const JpegEncoder &) = delete;
+  JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+  ///
+  /// \brief Encode a frame
+  ///
+  /// \param frame A YUYV or UYVY frame or field
+  /// \param jpeg Replaced by the JPEG file, throws std::runtime_error if libjpeg fails
+  ///
+  void Encode(const CapturedFrame &frame, std::vector<uint8_t> *jpeg);
+
+ private:
+  /// \brief libjpeg's error handling, jumping back to Encode() rather than exiting
+  struct Error {
+    /// \brief The libjpeg error manager, first so libjpeg's pointer to it is a pointer to this
+    struct jpeg_error_mgr manager;
+    /// \brief Where to jump back to
+    jmp_buf jump;
+  };
+
+  /// \brief A libjpeg destination growing a vector
+  struct Destination {
+    /// \brief The libjpeg destination manager, first so libjpeg's pointer to it is a pointer to this
+    struct jpeg_destination_mgr manager;
+    /// \brief The JPEG being written
+    std::vector<uint8_t> *out;
+  };
+
+  /// \brief The quality
+  int quality_;
+  /// \brief The compressor
+  struct jpeg_compress_struct compress_;
+  /// \brief Its error handler
+  Error error_;
+  /// \brief Its destination
+  Destination destination_;
+  /// \brief Eight lines of luma, each padded to a whole number of 16 pixel MCUs
+  std::vector<uint8_t> y_;
+  /// \brief Eight lines of Cb, padded to match
+  std::vector<uint8_t> cb_;
+  /// \brief Eight lines of Cr
+  std::vector<uint8_t> cr_;
+};
+
+///
+/// \brief A pool of threads, each with its own JpegEncoder, shared by the JPEG sinks of all channels
+///
+class JpegWorkers {
+ public:
+  /// \brief Called on a worker with the JPEG, empty if encoding failed
+  using Done = std::function<void(const std::vector<uint8_t> &jpeg)>;
+
+  ///
+  /// \brief Construct a new Jpeg Workers object and start the threads
+  ///
+  /// \param threads Threads, 0 for one per core
+  /// \param quality 1 to 100
+  ///
+  JpegWorkers(int threads, int quality);
+
+  ///
+  /// \brief Finish the queued frames and stop the threads
+  ///
+  ///
+  ~JpegWorkers();
+
+  ///
+  /// \brief Queue a frame to encode
+  ///
+  /// \param frame The frame, its data in image
+  /// \param image Holds the frame's data until it has been encoded, released before done is called
+  /// \param done Called with the JPEG
+  ///
+  void Submit(const CapturedFrame &frame, std::shared_ptr<const std::vector<uint8_t>> image, Done done);
+
+  ///
+  /// \brief Number of threads
+  ///
+  /// \return int The threads encoding
+  ///
+  int Threads() const { return static_cast<int>(threads_.size()); }
+
+ private:
+  /// \brief A frame waiting to be encoded
+  struct Job {
+    /// \brief The frame
+    CapturedFrame frame;
+    /// \brief Its data
+    std::shared_ptr<const std::vector<uint8_t>> image;
+    /// \brief Given the JPEG
+    Done done;
+  };
+
+  ///
+  /// \brief A worker thread
+  ///
+  ///
+  void Run();
+
+  /// \brief The quality
+  int quality_;
+  /// \brief Guards the queue
+  std::mutex mutex_;
+  /// \brief Signalled when a job is queued or the workers are stopping
+  std::condition_variable ready_;
+  /// \brief Jobs waiting for a worker
+  std::deque<Job> jobs_;
+  /// \brief Set by the destructor
+  bool stopping_ = false;
+  /// \brief The workers
+  std::vector<std::thread> threads_;
+};
+
+#endif  // JPEG_ENCODER_H
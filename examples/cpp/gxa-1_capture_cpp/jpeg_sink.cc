@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Saves JPEG snapshots on request, and a continuous MJPEG stream, of one channel
+///
+/// \file jpeg_sink.cc
+///
+
+#include "jpeg_sink.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+JpegSink::JpegSink(JpegWorkers *workers, std::string name, std::string snapshot_dir, const std::string &mjpeg_path,
+                   int queue)
+    : workers_(workers), name_(std::move(name)), snapshot_dir_(std::move(snapshot_dir)), queue_(std::max(queue, 1)) {
+  if (!mjpeg_path.empty()) {
+    mjpeg_ = fopen(mjpeg_path.c_str(), "wb");
+    if (!mjpeg_) throw std::runtime_error("MJPEG file " + mjpeg_path + ": " + strerror(errno));
+    std::cout << "Writing MJPEG to " << mjpeg_path << "\n";
+  }
+}
+
+JpegSink::~JpegSink() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  finished_.wait(lock, [this] { return in_flight_ == 0; });
+  if (mjpeg_) fclose(mjpeg_);
+  for (std::vector<uint8_t> *buffer : free_) delete buffer;
+}
+
+std::shared_ptr<std::vector<uint8_t>> JpegSink::Buffer(size_t bytes) {
+  std::vector<uint8_t> *buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_.empty()) {
+      buffer = free_.back();
+      free_.pop_back();
+    }
+  }
+  if (!buffer) buffer = new std::vector<uint8_t>();
+  if (buffer->size() < bytes) buffer->resize(bytes);
+
+  return std::shared_ptr<std::vector<uint8_t>>(buffer, [this](std::vector<uint8_t> *released) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(released);
+  });
+}
+
+void JpegSink::Consume(const CapturedFrame &frame) {
+  bool snapshot = snapshot_requests_ > 0 && !snapshot_dir_.empty();
+  if (!snapshot && !mjpeg_) return;
+
+  uint64_t order;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (in_flight_ >= queue_) {
+      stats_.dropped++;
+      return;
+    }
+    in_flight_++;
+    order = mjpeg_ ? next_order_++ : 0;
+  }
+  // Taken only once the frame is queued, so a dropped frame leaves the snapshot for the next
+  if (snapshot) snapshot_requests_ = 0;
+
+  // The one copy, so the driver gets its buffer back while the frame is encoded
+  std::shared_ptr<std::vector<uint8_t>> image = Buffer(frame.bytes);
+  memcpy(image->data(), frame.data, frame.bytes);
+  CapturedFrame copy = frame;
+  copy.data = image->data();
+  copy.buffer_index = -1;
+  int64_t timestamp_ns = frame.timestamp_ns;
+  workers_->Submit(copy, std::move(image), [this, order, snapshot, timestamp_ns](const std::vector<uint8_t> &jpeg) {
+    Finished(order, snapshot, timestamp_ns, jpeg);
+  });
+}
+
+void JpegSink::Finished(uint64_t order, bool snapshot, int64_t timestamp_ns, const std::vector<uint8_t> &jpeg) {
+  if (snapshot && !jpeg.empty()) WriteSnapshot(timestamp_ns, jpeg);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.frames += !jpeg.empty();
+  stats_.bytes += jpeg.size();
+  stats_.snapshots += snapshot && !jpeg.empty();
+  if (mjpeg_) {
+    // Held until the frames before it are written, a failed frame leaves a gap rather than stopping the file
+    waiting_.emplace(order, jpeg);
+    for (auto next = waiting_.find(next_write_); next != waiting_.end(); next = waiting_.find(++next_write_)) {
+      fwrite(next->second.data(), 1, next->second.size(), mjpeg_);
+      waiting_.erase(next);
+    }
+  }
+  in_flight_--;
+  finished_.notify_all();
+}
+
+void JpegSink::WriteSnapshot(int64_t timestamp_ns, const std::vector<uint8_t> &jpeg) {
+  // The wall clock time it was written, and the capture time to tell frames in the same millisecond apart
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  struct tm local;
+  localtime_r(&now.tv_sec, &local);
+  char time[32];
+  strftime(time, sizeof(time), "%Y%m%d-%H%M%S", &local);
+  std::string path = snapshot_dir_ + "/" + name_ + "-" + time + "-" + std::to_string(timestamp_ns / 1000000) + ".jpg";
+
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file || fwrite(jpeg.data(), 1, jpeg.size(), file) != jpeg.size()) {
+    std::cerr << "Snapshot " << path << ": " << strerror(errno) << "\n";
+  } else {
+    std::cout << "Snapshot " << path << ", " << jpeg.size() / 1024 << " KB\n";
+  }
+  if (file) fclose(file);
+}
+
+JpegSinkStats JpegSink::TakeStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  JpegSinkStats stats = stats_;
+  stats_ = {};
+  return stats;
+}
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Saves JPEG snapshots on request, and a continuous MJPEG stream, of one channel
+///
+/// \file jpeg_sink.h
+///
+
+#ifndef JPEG_SINK_H
+#define JPEG_SINK_H
+
+#include <stdio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "frame_sink.h"
+#include "jpeg_encoder.h"
+
+/// \brief Counts since the last TakeStats()
+struct JpegSinkStats {
+  /// \brief Frames encoded
+  uint64_t frames = 0;
+  /// \brief Frames not encoded because the workers were behind
+  uint64_t dropped = 0;
+  /// \brief Bytes of JPEG
+  uint64_t bytes = 0;
+  /// \brief Snapshots written
+  uint64_t snapshots = 0;
+};
+
+///
+/// \brief Encodes frames on a shared JpegWorkers pool, for snapshots when asked and for an MJPEG file
+///
+/// A frame to encode is copied out of the driver's buffer into a pooled buffer and queued, so the capture only
+/// waits for the copy. If the channel already has as many frames queued as it is allowed, the frame is dropped
+/// rather than the capture stalling, and a snapshot waits for the next frame that is taken. The workers finish
+/// frames in any order, and the MJPEG file, plain JPEGs one after another as ffmpeg's mjpeg format reads, is
+/// written in capture order.
+///
+class JpegSink : public FrameSink {
+ public:
+  ///
+  /// \brief Construct a new Jpeg Sink object
+  ///
+  /// \param workers The encoders, which must outlive the sink
+  /// \param name Starts the snapshot file names, for example the device, video0
+  /// \param snapshot_dir Where snapshots are written, empty for none
+  /// \param mjpeg_path The MJPEG file, empty for none, throws std::runtime_error if it cannot be created
+  /// \param queue Frames of this channel queued or being encoded at once
+  ///
+  JpegSink(JpegWorkers *workers, std::string name, std::string snapshot_dir, const std::string &mjpeg_path,
+           int queue = 4);
+
+  ///
+  /// \brief Wait for the frames queued and close the MJPEG file
+  ///
+  ///
+  ~JpegSink();
+
+  ///
+  /// \brief Save the next frame as a JPEG, safe to call from a signal handler
+  ///
+  ///
+  void Snapshot() { snapshot_requests_++; }
+
+  ///
+  /// \brief Queue the frame if it is wanted
+  ///
+  /// \param frame The captured frame
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+  ///
+  /// \brief Counts since the last call
+  ///
+  /// \return JpegSinkStats The counts, which are then reset
+  ///
+  JpegSinkStats TakeStats();
+
+ private:
+  ///
+  /// \brief A frame has been encoded, called on a worker
+  ///
+  /// \param order Its place in the MJPEG file
+  /// \param snapshot Write it as a snapshot too
+  /// \param timestamp_ns When it was captured
+  /// \param jpeg The JPEG, empty if it failed
+  ///
+  void Finished(uint64_t order, bool snapshot, int64_t timestamp_ns, const std::vector<uint8_t> &jpeg);
+
+  ///
+  /// \brief Write a snapshot file
+  ///
+  /// \param timestamp_ns When the frame was captured, in the name
+  /// \param jpeg The JPEG
+  ///
+  void WriteSnapshot(int64_t timestamp_ns, const std::vector<uint8_t> &jpeg);
+
+  ///
+  /// \brief A buffer from the pool
+  ///
+  /// \param bytes Size needed
+  /// \return std::shared_ptr<std::vector<uint8_t>> The buffer, back to the pool when released
+  ///
+  std::shared_ptr<std::vector<uint8_t>> Buffer(size_t bytes);
+
+  /// \brief The encoders
+  JpegWorkers *workers_;
+  /// \brief Starts the snapshot names
+  std::string name_;
+  /// \brief Where snapshots go
+  std::string snapshot_dir_;
+  /// \brief The MJPEG file, nullptr for none
+  FILE *mjpeg_ = nullptr;
+  /// \brief Most frames queued at once
+  int queue_;
+  /// \brief Snapshots asked for and not yet queued
+  std::atomic<int> snapshot_requests_{0};
+  /// \brief Guards what follows
+  std::mutex mutex_;
+  /// \brief Signalled when a frame is finished
+  std::condition_variable finished_;
+  /// \brief Frames queued or being encoded
+  int in_flight_ = 0;
+  /// \brief Place of the next frame queued for the MJPEG file
+  uint64_t next_order_ = 0;
+  /// \brief Place of the next frame to write to the MJPEG file
+  uint64_t next_write_ = 0;
+  /// \brief Frames finished ahead of one before them, by place
+  std::map<uint64_t, std::vector<uint8_t>> waiting_;
+  /// \brief Free buffers
+  std::vector<std::vector<uint8_t> *> free_;
+  /// \brief Counts since TakeStats()
+  JpegSinkStats stats_;
+};
+
+#endif  // JPEG_SINK_H
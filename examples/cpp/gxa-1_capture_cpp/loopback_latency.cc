@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Measures capture to network latency by receiving our own RTP stream on the same host
+///
+/// \file loopback_latency.cc
+///
+
+#include "loopback_latency.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+// Frames sent without their marker packet coming back are forgotten after this many
+static constexpr size_t kMaxPending = 64;
+// Timestamps of received frames remembered, to ignore their stragglers
+static constexpr size_t kMaxReceived = 16;
+
+static int64_t monotonic_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+LoopbackLatency::LoopbackLatency(std::string address, int port, int report_seconds)
+    : address_(std::move(address)), port_(port), report_ns_(report_seconds * 1000000000LL) {}
+
+LoopbackLatency::~LoopbackLatency() {
+  running_ = false;
+  if (thread_.joinable()) thread_.join();
+  if (socket_ >= 0) close(socket_);
+}
+
+bool LoopbackLatency::Start() {
+  socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) {
+    std::cerr << "Latency socket failed: " << strerror(errno) << "\n";
+    return false;
+  }
+
+  // Share the port with any other receiver on this host, and wake regularly to check for shutdown
+  int reuse = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  struct timeval timeout = {0, 200000};
+  setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(port_);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(socket_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0) {
+    std::cerr << "Latency bind to port " << port_ << " failed: " << strerror(errno) << "\n";
+    return false;
+  }
+
+  struct in_addr group;
+  if (inet_pton(AF_INET, address_.c_str(), &group) == 1 && IN_MULTICAST(ntohl(group.s_addr))) {
+    struct ip_mreqn membership = {};
+    membership.imr_multiaddr = group;
+    if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+      std::cerr << "Latency join " << address_ << " failed: " << strerror(errno) << "\n";
+      return false;
+    }
+  }
+
+  running_ = true;
+  thread_ = std::thread(&LoopbackLatency::Receive, this);
+  return true;
+}
+
+void LoopbackLatency::Sent(uint32_t rtp_timestamp, int64_t capture_ns) { Add({rtp_timestamp, true, capture_ns}); }
+
+void LoopbackLatency::Sent(int64_t capture_ns) { Add({0, false, capture_ns}); }
+
+void LoopbackLatency::Add(const Pending &frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.push_back(frame);
+  if (pending_.size() > kMaxPending) pending_.pop_front();
+}
+
+void LoopbackLatency::Receive() {
+  uint8_t packet[2048];
+  int64_t report_start = monotonic_ns();
+  int64_t sum = 0, worst = 0, best = INT64_MAX;
+  uint64_t frames = 0, lost = 0, unmatched = 0;
+
+  while (running_) {
+    ssize_t size = recv(socket_, packet, sizeof(packet), 0);
+    int64_t now = monotonic_ns();
+
+    // RTP version 2, every packet of a frame carries its timestamp and the marker bit ends it
+    if (size >= 12 && (packet[0] >> 6) == 2) {
+      uint32_t rtp_timestamp = (packet[4] << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+      bool marker = packet[1] & 0x80;
+      int64_t capture_ns = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto frame = std::find_if(pending_.begin(), pending_.end(), [rtp_timestamp](const Pending &p) {
+          return p.bound && p.rtp_timestamp == rtp_timestamp;
+        });
+
+        // The first packet seen of a new frame from a payloader that stamps its own frames
+        bool received = std::find(received_.begin(), received_.end(), rtp_timestamp) != received_.end();
+        if (frame == pending_.end() && !received) {
+          frame = std::find_if(pending_.begin(), pending_.end(), [](const Pending &p) { return !p.bound; });
+          if (frame != pending_.end()) {
+            frame->rtp_timestamp = rtp_timestamp;
+            frame->bound = true;
+          }
+        }
+
+        if (marker && frame != pending_.end()) {
+          // Frames sent before this one will not be received now
+          capture_ns = frame->capture_ns;
+          lost += frame - pending_.begin();
+          pending_.erase(pending_.begin(), frame + 1);
+          received_.push_back(rtp_timestamp);
+          if (received_.size() > kMaxReceived) received_.pop_front();
+        } else if (marker) {
+          unmatched++;
+        }
+      }
+      if (capture_ns) {
+        int64_t latency = now - capture_ns;
+        sum += latency;
+        worst = std::max(worst, latency);
+        best = std::min(best, latency);
+        frames++;
+      }
+    }
+
+    if (now - report_start >= report_ns_) {
+      if (frames) {
+        printf("Capture to loopback latency: mean %.2f ms, min %.2f ms, max %.2f ms over %llu frames, %llu lost, "
+               "%llu unmatched\n",
+               sum / 1e6 / frames, best / 1e6, worst / 1e6, static_cast<unsigned long long>(frames),
+               static_cast<unsigned long long>(lost), static_cast<unsigned long long>(unmatched));
+      } else {
+        printf("Capture to loopback latency: no frames received on port %d\n", port_);
+      }
+      report_start = now;
+      sum = worst = 0;
+      best = INT64_MAX;
+      frames = lost = unmatched = 0;
+    }
+  }
+}
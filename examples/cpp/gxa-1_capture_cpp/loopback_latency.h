@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Measures capture to network latency by receiving our own RTP stream on the same host
+///
+/// \file loopback_latency.h
+///
+
+#ifndef LOOPBACK_LATENCY_H
+#define LOOPBACK_LATENCY_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+///
+/// \brief Receives the stream being sent and times each frame from capture to its last packet arriving
+///
+/// Frames are matched on their RTP timestamp, so a lost or repeated marker packet costs one measurement and does not
+/// shift the ones after it. A sink that sets the RTP timestamp itself passes it with the frame. For one that leaves it
+/// to its payloader, the frame is bound to the timestamp of the next new frame to arrive, the oldest unbound frame
+/// first, which includes any delay in the encoder. Frames sent before one that has been received are stale and
+/// dropped.
+///
+class LoopbackLatency {
+ public:
+  ///
+  /// \brief Construct a new Loopback Latency object
+  ///
+  /// \param address The address the stream is sent to, a multicast group is joined
+  /// \param port The UDP port the stream is sent to
+  /// \param report_seconds Log the latency this often
+  ///
+  LoopbackLatency(std::string address, int port, int report_seconds = 5);
+
+  ///
+  /// \brief Destroy the Loopback Latency object, stops receiving
+  ///
+  ///
+  ~LoopbackLatency();
+
+  ///
+  /// \brief Open the socket and start receiving
+  ///
+  /// \return true if the socket is open
+  ///
+  bool Start();
+
+  ///
+  /// \brief Record that a frame is about to be sent, called before it is handed to the transmitter
+  ///
+  /// \param rtp_timestamp The RTP timestamp its packets will carry
+  /// \param capture_ns When the frame was captured, CLOCK_MONOTONIC nanoseconds
+  ///
+  void Sent(uint32_t rtp_timestamp, int64_t capture_ns);
+
+  ///
+  /// \brief Record that a frame is about to be sent by a payloader that chooses the RTP timestamp itself
+  ///
+  /// \param capture_ns When the frame was captured, CLOCK_MONOTONIC nanoseconds
+  ///
+  void Sent(int64_t capture_ns);
+
+ private:
+  /// \brief A frame sent and not yet received
+  struct Pending {
+    /// \brief Its RTP timestamp, once bound
+    uint32_t rtp_timestamp;
+    /// \brief The RTP timestamp is known
+    bool bound;
+    /// \brief When the frame was captured
+    int64_t capture_ns;
+  };
+
+  ///
+  /// \brief Add a frame to pending_, forgetting the oldest if there are too many
+  ///
+  /// \param frame The frame
+  ///
+  void Add(const Pending &frame);
+
+  ///
+  /// \brief Receive thread
+  ///
+  ///
+  void Receive();
+
+  /// \brief The address the stream is sent to
+  std::string address_;
+  /// \brief The UDP port
+  int port_;
+  /// \brief Nanoseconds between reports
+  int64_t report_ns_;
+  /// \brief The UDP socket, -1 when closed
+  int socket_ = -1;
+  /// \brief The receive thread
+  std::thread thread_;
+  /// \brief The receive thread keeps going while set
+  std::atomic<bool> running_{false};
+  /// \brief Frames sent and not yet received, oldest first
+  std::deque<Pending> pending_;
+  /// \brief RTP timestamps of the frames received most recently, so their late or repeated packets are not bound
+  std::deque<uint32_t> received_;
+  /// \brief Protects pending_
+  std::mutex mutex_;
+};
+
+#endif  // LOOPBACK_LATENCY_H
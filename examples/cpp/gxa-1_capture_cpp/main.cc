@@ -18,7 +18,6 @@
 #include <errno.h>
 #include <fcntl.h>   // low-level i/o
 #include <getopt.h>  // getopt_long()
-#include <libswscale/swscale.h>
 #include <linux/videodev2.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,12 +30,37 @@
 #include <unistd.h>
 
 #include <algorithm>  // for std::clamp
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#include "deinterlacer.h"
+#include "frame_synchroniser.h"
+#include "jpeg_encoder.h"
+#include "jpeg_sink.h"
+#include "loopback_latency.h"
+#include "pyramid_sink.h"
+#include "region_scaler.h"
+#include "rfc4175_sink.h"
+#include "shm_ring_sink.h"
 #include "video_capture.h"
+#ifdef MEDIAX_SUPPORTED
+#include "rtp_sink.h"
+#endif
+#ifdef ZENOH_SUPPORTED
+#include "zenoh_sink.h"
+#endif
 
 // Gflags
 #include <gflags/gflags.h>
@@ -47,9 +71,291 @@ DEFINE_string(device, "/dev/video0", "Video device name [/dev/video]");
 DEFINE_int32(io_method, 1, "IO Method: 1 - MMAP, 2 - READ, 3 - USERPTR");
 // Flag to set video standard
 DEFINE_string(video_standard, "PAL", "Video standard [PAL, NTSC]");
+// Flag to show the video in a window
+DEFINE_bool(display, true, "Show the video in a window");
+// RTP output
+DEFINE_string(rtp, "",
+              "Send the video as RTP [raw, h264] through mediax with a SAP announcement, or [rfc4175] zero copy "
+              "without, empty for none");
+DEFINE_string(rtp_address, "238.192.1.1", "RTP multicast group or unicast address");
+DEFINE_int32(rtp_port, 5004, "RTP port");
+DEFINE_string(session_name, "gxa-1-capture", "SAP session name");
+DEFINE_bool(gso, true, "Batch rfc4175 packets with UDP_SEGMENT when the kernel supports it");
+DEFINE_int32(mtu, 1500, "Largest IP packet for rfc4175");
+// Latency measurement
+DEFINE_bool(latency, false, "Receive the RTP stream on this host and report the capture to network latency");
+// Shared memory output
+DEFINE_string(shm_ring, "", "Write the frames to this POSIX shared memory ring, for example /gxa-video0");
+DEFINE_int32(shm_ring_slots, 8, "Frames held by the shared memory ring");
+// Synchronised capture
+DEFINE_string(sync_devices, "", "Capture these comma separated devices together and bundle frames captured at once");
+DEFINE_int32(sync_tolerance_us, 10000, "Most the capture times in a bundle may differ by, under half a frame period");
+DEFINE_int32(sync_queue, 4, "Bundles waiting for the consumer before the oldest is dropped");
+// Zenoh output
+DEFINE_string(zenoh_key, "", "Publish the frames on this zenoh key expression, through shared memory, empty for none");
+DEFINE_int32(zenoh_shm_mb, 32, "Shared memory pool for zenoh in megabytes, a few frames more than subscribers hold");
+// Region of interest
+DEFINE_string(crop, "", "Capture only this region, x,y,width,height in pixels and frame lines, empty for all of it");
+DEFINE_string(scale, "", "Output the frame, or the cropped region, at widthxheight, for example 360x288");
+// Previews
+DEFINE_string(preview_scales, "", "Make previews at these comma separated fractions of the frame size [2, 4, 8]");
+DEFINE_string(preview_zenoh_key, "", "Publish each preview on this key expression, {scale} is replaced by 2, 4 or 8");
+DEFINE_string(preview_shm_ring, "", "Write each preview to this shared memory ring, {scale} is replaced as above");
+// JPEG output
+DEFINE_string(snapshot_dir, "", "Save a JPEG of the next frame here on SIGUSR1, empty for no snapshots");
+DEFINE_string(mjpeg, "", "Write every frame to this MJPEG file, {device} is replaced by the device name");
+DEFINE_int32(jpeg_quality, 85, "JPEG quality, 1 to 100");
+DEFINE_int32(jpeg_workers, 0, "Threads encoding JPEG for all channels, 0 for one per core");
+DEFINE_int32(jpeg_benchmark, 0, "Time JPEG encoding over this many synthetic PAL frames and exit");
+// Deinterlacer cost
+DEFINE_int32(deinterlace_benchmark, 0, "Time each deinterlace mode over this many synthetic PAL fields and exit");
+DECLARE_bool(interlaced);
+DECLARE_bool(pair_fields);
+
+// Times the deinterlacer on fields cut from a moving test picture, a still background with a bar crossing it
+static int benchmark_deinterlace(int fields) {
+  const int width = 720;
+  const int height = 576;
+  const int row_bytes = width * 2;
+  const int64_t field_period_ns = 20000000;
+
+  // Two fields a frame, each from the picture at its own time, as an interlaced camera sees it
+  std::vector<std::vector<uint8_t>> sequence(50, std::vector<uint8_t>(row_bytes * height / 2));
+  for (size_t f = 0; f < sequence.size(); f++) {
+    int bar = static_cast<int>(f * 12) % width;
+    for (int line = 0; line < height / 2; line++) {
+      int y = line * 2 + (f & 1);
+      uint8_t *row = &sequence[f][line * row_bytes];
+      for (int x = 0; x < width; x++) {
+        bool moving = x >= bar && x < bar + 64;
+        row[x * 2] = moving ? 235 : static_cast<uint8_t>(16 + ((x / 8 + y / 8) & 1) * 180);
+        row[x * 2 + 1] = moving ? 90 : 128;
+      }
+    }
+  }
+
+  printf("Deinterlacing %d PAL fields of %dx%d YUYV\n", fields, width, height / 2);
+  for (const char *name : {"bob", "weave", "adaptive"}) {
+    Deinterlacer deinterlacer(ParseDeinterlaceMode(name), width, height, field_period_ns);
+    double motion = 0;
+    uint32_t check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < fields; i++) {
+      int f = i % sequence.size();
+      const uint8_t *frame = deinterlacer.Field(sequence[f].data(), f & 1 ? V4L2_FIELD_BOTTOM : V4L2_FIELD_TOP,
+                                                (i + 1) * field_period_ns);
+      motion += deinterlacer.Motion();
+      check += frame[(i * 4099) % (row_bytes * height)];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-8s %.3f ms/field, %.0f fields/s, %.0f%% of blocks moving (%u)\n", name, seconds * 1000 / fields,
+           fields / seconds, 100 * motion / fields, check);
+  }
+  return EXIT_SUCCESS;
+}
+
+// Replaces {scale} in a key or ring name
+static std::string expand_scale(std::string name, int scale) {
+  const std::string field = "{scale}";
+  std::string value = std::to_string(scale);
+  for (size_t at = name.find(field); at != std::string::npos; at = name.find(field, at + value.size())) {
+    name.replace(at, field.size(), value);
+  }
+  return name;
+}
+
+// Makes a zenoh sink publishing on a key expression
+using ZenohSinkFactory = std::function<std::unique_ptr<FrameSink>(const std::string &key)>;
+
+// The preview outputs, a sink per scale and transport, and the pyramid sink feeding them, nullptr if none
+static std::unique_ptr<FrameSink> make_previews(std::vector<std::unique_ptr<FrameSink>> *outputs,
+                                                const ZenohSinkFactory &make_zenoh) {
+  if (FLAGS_preview_scales.empty()) return nullptr;
+  if (FLAGS_preview_zenoh_key.empty() && FLAGS_preview_shm_ring.empty()) {
+    throw std::runtime_error("Previews need -preview_zenoh_key or -preview_shm_ring");
+  }
+
+  std::vector<int> scales;
+  std::stringstream list(FLAGS_preview_scales);
+  for (std::string item; std::getline(list, item, ',');) {
+    if (item.empty()) continue;
+    int scale = item == "2" ? 2 : item == "4" ? 4 : item == "8" ? 8 : 0;
+    if (!scale) throw std::runtime_error("Unknown preview scale '" + item + "', expected 2, 4 or 8");
+    scales.push_back(scale);
+  }
+
+  // Every size under one name would publish over each other, and each shared memory ring would unlink the last
+  for (const std::string *name : {&FLAGS_preview_zenoh_key, &FLAGS_preview_shm_ring}) {
+    if (scales.size() > 1 && !name->empty() && name->find("{scale}") == std::string::npos) {
+      throw std::runtime_error("Several preview scales need {scale} in '" + *name + "' to tell them apart");
+    }
+  }
+
+  std::vector<PyramidSink::Output> levels;
+  for (int scale : scales) {
+    int level = scale == 2 ? 1 : scale == 4 ? 2 : 3;
+    if (!FLAGS_preview_zenoh_key.empty()) {
+      if (!make_zenoh) throw std::runtime_error("zenoh previews need zenoh, rebuild with it installed");
+      outputs->push_back(make_zenoh(expand_scale(FLAGS_preview_zenoh_key, scale)));
+      levels.push_back({level, outputs->back().get()});
+    }
+    if (!FLAGS_preview_shm_ring.empty()) {
+      outputs->push_back(
+          std::make_unique<ShmRingSink>(expand_scale(FLAGS_preview_shm_ring, scale), FLAGS_shm_ring_slots));
+      levels.push_back({level, outputs->back().get()});
+    }
+  }
+  return std::make_unique<PyramidSink>(std::move(levels));
+}
+
+// The JPEG sinks, told by SIGUSR1 to take a snapshot
+static std::vector<JpegSink *> jpeg_sinks;
+
+// A JPEG sink for a device on the shared workers, nullptr if neither snapshots nor MJPEG are wanted
+static std::unique_ptr<JpegSink> make_jpeg_sink(std::unique_ptr<JpegWorkers> *workers, const std::string &device) {
+  if (FLAGS_snapshot_dir.empty() && FLAGS_mjpeg.empty()) return nullptr;
+  if (!*workers) *workers = std::make_unique<JpegWorkers>(FLAGS_jpeg_workers, FLAGS_jpeg_quality);
+
+  std::string name = device.substr(device.find_last_of('/') + 1);
+  std::string mjpeg = FLAGS_mjpeg;
+  const std::string field = "{device}";
+  for (size_t at = mjpeg.find(field); at != std::string::npos; at = mjpeg.find(field, at + name.size())) {
+    mjpeg.replace(at, field.size(), name);
+  }
+  auto sink = std::make_unique<JpegSink>(workers->get(), name, FLAGS_snapshot_dir, mjpeg);
+  jpeg_sinks.push_back(sink.get());
+  std::signal(SIGUSR1, [](int) {
+    for (JpegSink *sink : jpeg_sinks) sink->Snapshot();
+  });
+  return sink;
+}
+
+// Times JPEG encoding of a PAL frame on one core, and on all the workers together
+static int benchmark_jpeg(int frames) {
+  const int width = 720;
+  const int height = 576;
+
+  // Gradients under fine noise, which compresses about like a real picture and far worse than flat colour
+  auto image = std::make_shared<std::vector<uint8_t>>(width * 2 * height);
+  uint32_t noise = 2463534242u;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 2) {
+      uint8_t *pixel = &(*image)[(y * width + x) * 2];
+      noise ^= noise << 13;
+      noise ^= noise >> 17;
+      noise ^= noise << 5;
+      pixel[0] = static_cast<uint8_t>(16 + (x + y) * 200 / (width + height) + (noise & 15));
+      pixel[1] = static_cast<uint8_t>(64 + x * 128 / width);
+      pixel[2] = static_cast<uint8_t>(16 + (x + y) * 200 / (width + height) + ((noise >> 4) & 15));
+      pixel[3] = static_cast<uint8_t>(64 + y * 128 / height);
+    }
+  }
+  CapturedFrame frame = {};
+  frame.data = image->data();
+  frame.bytes = image->size();
+  frame.width = width;
+  frame.height = height;
+  frame.stride = width * 2;
+  frame.pixelformat = V4L2_PIX_FMT_YUYV;
+  frame.buffer_index = -1;
+
+  JpegEncoder encoder(FLAGS_jpeg_quality);
+  std::vector<uint8_t> jpeg;
+  encoder.Encode(frame, &jpeg);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) encoder.Encode(frame, &jpeg);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("JPEG %dx%d 4:2:2 quality %d, %zu KB a frame against %d KB as PPM\n", width, height, FLAGS_jpeg_quality,
+         jpeg.size() / 1024, width * height * 3 / 1024);
+  printf("  one core:  %.2f ms/frame, %.0f frames/s\n", seconds * 1000 / frames, frames / seconds);
+
+  JpegWorkers workers(FLAGS_jpeg_workers, FLAGS_jpeg_quality);
+  std::mutex mutex;
+  std::condition_variable finished;
+  int done = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    workers.Submit(frame, image, [&](const std::vector<uint8_t> &) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++done == frames) finished.notify_one();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return done == frames; });
+  }
+  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("  %d workers: %.2f ms/frame per core, %.0f frames/s, %.1f PAL channels at 25 fps\n", workers.Threads(),
+         seconds * 1000 * workers.Threads() / frames, frames / seconds, frames / seconds / 25);
+  return EXIT_SUCCESS;
+}
+
+// Captures several channels, a thread each, and bundles the frames captured at the same time
+static int synchronise(io_method io, const std::string &video_standard, uint32_t pixelformat,
+                       const CaptureRegion &region) {
+  std::vector<std::string> devices;
+  std::stringstream list(FLAGS_sync_devices);
+  for (std::string device; std::getline(list, device, ',');) {
+    if (!device.empty()) devices.push_back(device);
+  }
+
+  FrameSynchroniser sync(devices.size(), FLAGS_sync_tolerance_us * 1000LL, FLAGS_sync_queue);
+  // Snapshots of every channel at once, encoded on one pool
+  std::unique_ptr<JpegWorkers> jpeg_workers;
+  std::vector<std::unique_ptr<JpegSink>> jpeg;
+  std::vector<std::unique_ptr<VideoCapture>> captures;
+  for (size_t i = 0; i < devices.size(); i++) {
+    // Only the first channel is shown
+    captures.push_back(
+        std::make_unique<VideoCapture>(devices[i], io, video_standard, i == 0 && FLAGS_display, pixelformat, region));
+    captures.back()->AddSink(sync.Channel(i));
+    jpeg.push_back(make_jpeg_sink(&jpeg_workers, devices[i]));
+    if (jpeg.back()) captures.back()->AddSink(jpeg.back().get());
+  }
+  for (std::unique_ptr<VideoCapture> &capture : captures) {
+    std::thread([&capture] {
+      try {
+        capture->Start();
+      } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }).detach();
+  }
+
+  // Stands in for the stereo or surround processing, which would take each bundle here
+  FrameBundle bundle;
+  auto report_start = std::chrono::steady_clock::now();
+  while (true) {
+    sync.Pop(&bundle, 100);
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - report_start).count();
+    if (seconds < 5) continue;
+
+    SyncStats stats = sync.TakeStats();
+    printf("\n%.1f bundles/s, skew mean %.2f ms max %.2f ms, %llu dropped by the consumer\n", stats.bundles / seconds,
+           stats.bundles ? stats.skew_sum_ns / 1e6 / stats.bundles : 0.0, stats.skew_max_ns / 1e6,
+           static_cast<unsigned long long>(stats.queue_dropped));
+    for (size_t i = 0; i < devices.size(); i++) {
+      const ChannelSyncStats &channel = stats.channels[i];
+      printf("  %s: %.1f fps, %llu unmatched, offset mean %.2f ms max %.2f ms\n", devices[i].c_str(),
+             channel.frames / seconds, static_cast<unsigned long long>(channel.dropped),
+             channel.bundled ? channel.offset_sum_ns / 1e6 / channel.bundled : 0.0, channel.offset_max_ns / 1e6);
+      if (!jpeg[i]) continue;
+      JpegSinkStats encoded = jpeg[i]->TakeStats();
+      printf("    JPEG %.1f fps, %.0f KB a frame, %llu dropped, %llu snapshots\n", encoded.frames / seconds,
+             encoded.frames ? encoded.bytes / 1024.0 / encoded.frames : 0.0,
+             static_cast<unsigned long long>(encoded.dropped), static_cast<unsigned long long>(encoded.snapshots));
+    }
+    report_start = now;
+  }
+  return EXIT_SUCCESS;
+}
 
 int main(int argc, char **argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_deinterlace_benchmark > 0) return benchmark_deinterlace(FLAGS_deinterlace_benchmark);
+  if (FLAGS_jpeg_benchmark > 0) return benchmark_jpeg(FLAGS_jpeg_benchmark);
 
   std::string device = FLAGS_device;
   io_method io = static_cast<io_method>(FLAGS_io_method);
@@ -60,8 +366,79 @@ int main(int argc, char **argv) {
   std::cout << "IO Method: " << io << std::endl;
   std::cout << "Video Standard: " << video_standard << std::endl;
 
+  // RTP is sent as UYVY, the RFC 4175 byte order, so the capture needs no conversion
+  uint32_t pixelformat = FLAGS_rtp.empty() ? V4L2_PIX_FMT_YUYV : V4L2_PIX_FMT_UYVY;
+
+  if (!FLAGS_sync_devices.empty()) {
+    try {
+      return synchronise(io, video_standard, pixelformat, ParseCaptureRegion(FLAGS_crop, FLAGS_scale));
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   try {
-    VideoCapture capture(device, io, video_standard);
+    // Fields are sent separately when interlaced, unless paired back into frames
+    int fps = (video_standard == "NTSC" ? 30 : 25) * (FLAGS_interlaced && !FLAGS_pair_fields ? 2 : 1);
+    std::unique_ptr<LoopbackLatency> latency;
+    if (FLAGS_latency && !FLAGS_rtp.empty()) {
+      latency = std::make_unique<LoopbackLatency>(FLAGS_rtp_address, FLAGS_rtp_port);
+      if (!latency->Start()) latency.reset();
+    }
+
+    std::unique_ptr<FrameSink> rtp;
+    if (FLAGS_rtp == "rfc4175") {
+      rtp = std::make_unique<Rfc4175Sink>(FLAGS_rtp_address, FLAGS_rtp_port, FLAGS_session_name, fps, FLAGS_gso,
+                                          FLAGS_mtu, latency.get());
+    } else if (!FLAGS_rtp.empty()) {
+#ifdef MEDIAX_SUPPORTED
+      rtp = std::make_unique<RtpSink>(ParseRtpCodec(FLAGS_rtp), FLAGS_rtp_address, FLAGS_rtp_port,
+                                      FLAGS_session_name, fps, latency.get());
+#else
+      throw std::runtime_error("RTP " + FLAGS_rtp + " needs mediax, rebuild with it installed");
+#endif
+    }
+
+    // The frames and every preview publish on one zenoh session, declared first so it outlives their publishers
+    ZenohSinkFactory make_preview_zenoh;
+#ifdef ZENOH_SUPPORTED
+    std::unique_ptr<zenoh::Session> zenoh_session;
+    if (!FLAGS_zenoh_key.empty() || (!FLAGS_preview_scales.empty() && !FLAGS_preview_zenoh_key.empty())) {
+      zenoh_session = std::make_unique<zenoh::Session>(zenoh::Session::open(VideoSessionConfig()));
+    }
+    // A preview is small, a pool of a few frames is plenty
+    make_preview_zenoh = [&zenoh_session](const std::string &key) {
+      return std::make_unique<ZenohSink>(*zenoh_session, key, 4 << 20);
+    };
+#endif
+
+    std::unique_ptr<FrameSink> zenoh_sink;
+    if (!FLAGS_zenoh_key.empty()) {
+#ifdef ZENOH_SUPPORTED
+      zenoh_sink =
+          std::make_unique<ZenohSink>(*zenoh_session, FLAGS_zenoh_key, static_cast<size_t>(FLAGS_zenoh_shm_mb) << 20);
+#else
+      throw std::runtime_error("zenoh output needs zenoh, rebuild with it installed");
+#endif
+    }
+
+    std::unique_ptr<FrameSink> shm_ring;
+    if (!FLAGS_shm_ring.empty()) shm_ring = std::make_unique<ShmRingSink>(FLAGS_shm_ring, FLAGS_shm_ring_slots);
+
+    std::vector<std::unique_ptr<FrameSink>> preview_outputs;
+    std::unique_ptr<FrameSink> previews = make_previews(&preview_outputs, make_preview_zenoh);
+
+    std::unique_ptr<JpegWorkers> jpeg_workers;
+    std::unique_ptr<JpegSink> jpeg = make_jpeg_sink(&jpeg_workers, device);
+
+    VideoCapture capture(device, io, video_standard, FLAGS_display, pixelformat,
+                         ParseCaptureRegion(FLAGS_crop, FLAGS_scale));
+    if (rtp) capture.AddSink(rtp.get());
+    if (zenoh_sink) capture.AddSink(zenoh_sink.get());
+    if (shm_ring) capture.AddSink(shm_ring.get());
+    if (previews) capture.AddSink(previews.get());
+    if (jpeg) capture.AddSink(jpeg.get());
     capture.Start();
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Half, quarter and eighth size previews of packed 4:2:2 frames, made in one pass
+///
+/// \file preview_pyramid.cc
+///
+
+#include "preview_pyramid.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void HalveRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int width, bool uyvy) {
+  // Output macropixels, each from two source macropixels on each line
+  int count = width / 4;
+  int i = 0;
+  // Where each byte of a macropixel is
+  int y0 = uyvy ? 1 : 0;
+  int y1 = uyvy ? 3 : 2;
+  int u = uyvy ? 0 : 1;
+  int v = uyvy ? 2 : 3;
+
+#if defined(__SSE2__)
+  // Eight source macropixels to four, sums over the 2x2 block in 16 bit lanes
+  const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i two = _mm_set1_epi16(2);
+  for (; i + 4 <= count; i += 4) {
+    __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i * 8));
+    __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i * 8 + 16));
+    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i * 8));
+    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i * 8 + 16));
+    // Each byte widened to a 16 bit lane and the two lines added, luma Y0 Y1 and chroma U V per macropixel
+    __m128i luma0 = uyvy ? _mm_add_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(b0, 8))
+                         : _mm_add_epi16(_mm_and_si128(a0, low_bytes), _mm_and_si128(b0, low_bytes));
+    __m128i luma1 = uyvy ? _mm_add_epi16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8))
+                         : _mm_add_epi16(_mm_and_si128(a1, low_bytes), _mm_and_si128(b1, low_bytes));
+    __m128i chroma0 = uyvy ? _mm_add_epi16(_mm_and_si128(a0, low_bytes), _mm_and_si128(b0, low_bytes))
+                           : _mm_add_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(b0, 8));
+    __m128i chroma1 = uyvy ? _mm_add_epi16(_mm_and_si128(a1, low_bytes), _mm_and_si128(b1, low_bytes))
+                           : _mm_add_epi16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8));
+
+    // Y0 + Y1 of each source macropixel is one output pixel, eight of them
+    __m128i luma = _mm_packs_epi32(_mm_madd_epi16(luma0, ones), _mm_madd_epi16(luma1, ones));
+    // U and V of neighbouring macropixels added, then the even macropixels kept, four U V pairs
+    chroma0 = _mm_add_epi16(chroma0, _mm_srli_si128(chroma0, 4));
+    chroma1 = _mm_add_epi16(chroma1, _mm_srli_si128(chroma1, 4));
+    __m128i chroma = _mm_unpacklo_epi64(_mm_shuffle_epi32(chroma0, _MM_SHUFFLE(3, 1, 2, 0)),
+                                        _mm_shuffle_epi32(chroma1, _MM_SHUFFLE(3, 1, 2, 0)));
+
+    // Interleaved back into macropixels, luma pairs with chroma pairs, and the sums of four rounded
+    __m128i lo = uyvy ? _mm_unpacklo_epi16(chroma, luma) : _mm_unpacklo_epi16(luma, chroma);
+    __m128i hi = uyvy ? _mm_unpackhi_epi16(chroma, luma) : _mm_unpackhi_epi16(luma, chroma);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#elif defined(__ARM_NEON)
+  // Sixteen source macropixels to eight, split into their four bytes by the load
+  for (; i + 8 <= count; i += 8) {
+    uint8x16x4_t x = vld4q_u8(a + i * 8);
+    uint8x16x4_t y = vld4q_u8(b + i * 8);
+    // Y0 + Y1 of each source macropixel on both lines is one output pixel, the even ones Y0 and the odd Y1
+    uint16x8_t luma_lo = vaddq_u16(vaddl_u8(vget_low_u8(x.val[y0]), vget_low_u8(x.val[y1])),
+                                   vaddl_u8(vget_low_u8(y.val[y0]), vget_low_u8(y.val[y1])));
+    uint16x8_t luma_hi = vaddq_u16(vaddl_u8(vget_high_u8(x.val[y0]), vget_high_u8(x.val[y1])),
+                                   vaddl_u8(vget_high_u8(y.val[y0]), vget_high_u8(y.val[y1])));
+    uint16x8x2_t luma = vuzpq_u16(luma_lo, luma_hi);
+    // U and V of both lines, then neighbouring macropixels added
+    uint16x8_t u_lo = vaddl_u8(vget_low_u8(x.val[u]), vget_low_u8(y.val[u]));
+    uint16x8_t u_hi = vaddl_u8(vget_high_u8(x.val[u]), vget_high_u8(y.val[u]));
+    uint16x8_t v_lo = vaddl_u8(vget_low_u8(x.val[v]), vget_low_u8(y.val[v]));
+    uint16x8_t v_hi = vaddl_u8(vget_high_u8(x.val[v]), vget_high_u8(y.val[v]));
+    uint16x8_t u_sum = vcombine_u16(vpadd_u16(vget_low_u16(u_lo), vget_high_u16(u_lo)),
+                                    vpadd_u16(vget_low_u16(u_hi), vget_high_u16(u_hi)));
+    uint16x8_t v_sum = vcombine_u16(vpadd_u16(vget_low_u16(v_lo), vget_high_u16(v_lo)),
+                                    vpadd_u16(vget_low_u16(v_hi), vget_high_u16(v_hi)));
+
+    uint8x8x4_t out;
+    out.val[y0] = vrshrn_n_u16(luma.val[0], 2);
+    out.val[y1] = vrshrn_n_u16(luma.val[1], 2);
+    out.val[u] = vrshrn_n_u16(u_sum, 2);
+    out.val[v] = vrshrn_n_u16(v_sum, 2);
+    vst4_u8(dst + i * 4, out);
+  }
+#endif
+
+  // Remainder, and the whole line on other architectures
+  for (; i < count; i++) {
+    const uint8_t *p = a + i * 8;
+    const uint8_t *q = b + i * 8;
+    uint8_t *out = dst + i * 4;
+    out[y0] = static_cast<uint8_t>((p[y0] + p[y1] + q[y0] + q[y1] + 2) >> 2);
+    out[y1] = static_cast<uint8_t>((p[4 + y0] + p[4 + y1] + q[4 + y0] + q[4 + y1] + 2) >> 2);
+    out[u] = static_cast<uint8_t>((p[u] + p[4 + u] + q[u] + q[4 + u] + 2) >> 2);
+    out[v] = static_cast<uint8_t>((p[v] + p[4 + v] + q[v] + q[4 + v] + 2) >> 2);
+  }
+}
+
+PreviewPyramid::PreviewPyramid(int width, int height, int levels, bool uyvy) : uyvy_(uyvy) {
+  if (levels < 1 || levels > kMaxLevels) {
+    throw std::runtime_error("Preview levels must be 1 to " + std::to_string(kMaxLevels));
+  }
+  widths_[0] = width;
+  heights_[0] = height;
+  for (int level = 1; level <= levels; level++) {
+    // Whole macropixels
+    widths_[level] = widths_[level - 1] / 4 * 2;
+    heights_[level] = heights_[level - 1] / 2;
+    if (widths_[level] < 2 || heights_[level] < 1) {
+      throw std::runtime_error("A " + std::to_string(width) + "x" + std::to_string(height) +
+                               " frame is too small for " + std::to_string(levels) + " preview levels");
+    }
+    levels_.emplace_back(static_cast<size_t>(widths_[level]) * 2 * heights_[level]);
+  }
+}
+
+void PreviewPyramid::MakeLine(int level, int line, const uint8_t *a, const uint8_t *b) {
+  int row_bytes = widths_[level] * 2;
+  uint8_t *out = &levels_[level - 1][static_cast<size_t>(line) * row_bytes];
+  HalveRows(out, a, b, widths_[level - 1], uyvy_);
+
+  // The second line of a pair makes a line of the next level while both are still in the cache
+  if (level < Levels() && (line & 1) && line / 2 < heights_[level + 1]) {
+    MakeLine(level + 1, line / 2, out - row_bytes, out);
+  }
+}
+
+void PreviewPyramid::Build(const uint8_t *frame, int stride) {
+  for (int line = 0; line < heights_[1]; line++) {
+    const uint8_t *upper = frame + static_cast<size_t>(line) * 2 * stride;
+    MakeLine(1, line, upper, upper + stride);
+  }
+}
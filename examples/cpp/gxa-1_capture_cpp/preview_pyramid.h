@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Half, quarter and eighth size previews of packed 4:2:2 frames, made in one pass
+///
+/// \file preview_pyramid.h
+///
+
+#ifndef PREVIEW_PYRAMID_H
+#define PREVIEW_PYRAMID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+///
+/// \brief Halve two lines of YUYV or UYVY both ways, each output pixel the rounded mean of a 2x2 block
+///
+/// Chroma is averaged over the two macropixels under each output macropixel, so it stays centred with the luma.
+///
+/// \param dst The output, width / 2 pixels rounded down to even
+/// \param a The upper line
+/// \param b The lower line
+/// \param width Pixels in a line
+/// \param uyvy The bytes are U Y0 V Y1, otherwise Y0 U Y1 V
+///
+void HalveRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int width, bool uyvy);
+
+///
+/// \brief Box filtered previews of each frame at 1/2, 1/4 and 1/8 size
+///
+/// Each level is made from the one above it, line by line as the frame is read, so the frame is read once,
+/// straight from wherever it was captured, and only the small levels are written. The half size level is kept
+/// even when only smaller ones are wanted, as it is the source of the next, at a quarter of the frame's size.
+///
+class PreviewPyramid {
+ public:
+  /// \brief The most levels, down to 1/8
+  static constexpr int kMaxLevels = 3;
+
+  ///
+  /// \brief Construct a new Preview Pyramid object
+  ///
+  /// \param width Frame width in pixels
+  /// \param height Frame height in lines
+  /// \param levels Levels made, 1 for half size only up to kMaxLevels for down to an eighth
+  /// \param uyvy The bytes are U Y0 V Y1, otherwise Y0 U Y1 V
+  ///
+  PreviewPyramid(int width, int height, int levels, bool uyvy);
+
+  ///
+  /// \brief Make the levels from a frame
+  ///
+  /// \param frame The frame
+  /// \param stride Bytes per line of the frame
+  ///
+  void Build(const uint8_t *frame, int stride);
+
+  ///
+  /// \brief A level, as YUYV or UYVY like the frame, Width(level) * 2 bytes per line
+  ///
+  /// \param level 1 for half size, 2 for a quarter, 3 for an eighth
+  /// \return const uint8_t* The level made by the last Build()
+  ///
+  const uint8_t *Level(int level) const { return levels_[level - 1].data(); }
+
+  ///
+  /// \brief Width of a level
+  ///
+  /// \param level 1 to Levels()
+  /// \return int Pixels, even
+  ///
+  int Width(int level) const { return widths_[level]; }
+
+  ///
+  /// \brief Height of a level
+  ///
+  /// \param level 1 to Levels()
+  /// \return int Lines
+  ///
+  int Height(int level) const { return heights_[level]; }
+
+  ///
+  /// \brief Levels made
+  ///
+  /// \return int 1 to kMaxLevels
+  ///
+  int Levels() const { return static_cast<int>(levels_.size()); }
+
+ private:
+  ///
+  /// \brief Make a line of a level from two lines of the level above, and the line below it when that completes
+  /// a pair
+  ///
+  /// \param level The level to make a line of, 1 for half size
+  /// \param line The line of that level
+  /// \param a The upper source line
+  /// \param b The lower source line
+  ///
+  void MakeLine(int level, int line, const uint8_t *a, const uint8_t *b);
+
+  /// \brief The frame's width in pixels, then each level's
+  int widths_[kMaxLevels + 1];
+  /// \brief The frame's lines, then each level's
+  int heights_[kMaxLevels + 1];
+  /// \brief The byte order
+  bool uyvy_;
+  /// \brief The levels, half size first
+  std::vector<std::vector<uint8_t>> levels_;
+};
+
+#endif  // PREVIEW_PYRAMID_H
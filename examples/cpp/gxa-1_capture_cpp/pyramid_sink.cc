@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Passes reduced size previews of each frame on to other sinks, for monitoring at low bandwidth
+///
+/// \file pyramid_sink.cc
+///
+
+#include "pyramid_sink.h"
+
+#include <linux/videodev2.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+PyramidSink::PyramidSink(std::vector<Output> outputs) : outputs_(std::move(outputs)) {
+  for (const Output &output : outputs_) {
+    if (output.level < 1 || output.level > PreviewPyramid::kMaxLevels) {
+      throw std::runtime_error("Preview level " + std::to_string(output.level) + " must be 1 to " +
+                               std::to_string(PreviewPyramid::kMaxLevels));
+    }
+    levels_ = std::max(levels_, output.level);
+  }
+}
+
+void PyramidSink::Consume(const CapturedFrame &frame) {
+  if (outputs_.empty()) return;
+  if (!pyramid_) {
+    pyramid_ = std::make_unique<PreviewPyramid>(frame.width, frame.height, levels_,
+                                                frame.pixelformat == V4L2_PIX_FMT_UYVY);
+    for (int level = 1; level <= levels_; level++) {
+      std::cout << "Preview 1/" << (1 << level) << ": " << pyramid_->Width(level) << "x" << pyramid_->Height(level)
+                << "\n";
+    }
+  }
+  pyramid_->Build(frame.data, frame.stride);
+
+  for (const Output &output : outputs_) {
+    CapturedFrame level = frame;
+    level.data = pyramid_->Level(output.level);
+    level.width = pyramid_->Width(output.level);
+    level.height = pyramid_->Height(output.level);
+    level.stride = level.width * 2;
+    level.bytes = static_cast<size_t>(level.stride) * level.height;
+    level.buffer_index = -1;
+    output.sink->Consume(level);
+  }
+}
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Passes reduced size previews of each frame on to other sinks, for monitoring at low bandwidth
+///
+/// \file pyramid_sink.h
+///
+
+#ifndef PYRAMID_SINK_H
+#define PYRAMID_SINK_H
+
+#include <memory>
+#include <vector>
+
+#include "frame_sink.h"
+#include "preview_pyramid.h"
+
+///
+/// \brief Makes a PreviewPyramid from each frame, or field when interlaced, and hands the selected levels on
+///
+/// The pyramid is made straight from the captured frame, so the only copies are the levels themselves. Each output
+/// is an ordinary FrameSink, zenoh or a shared memory ring for example, that is given a level as if it had been
+/// captured at that size, with the frame's timestamp and sequence number.
+///
+class PyramidSink : public FrameSink {
+ public:
+  /// \brief A level and where it goes
+  struct Output {
+    /// \brief 1 for half size, 2 for a quarter, 3 for an eighth
+    int level;
+    /// \brief Given the level, which must outlive the pyramid sink
+    FrameSink *sink;
+  };
+
+  ///
+  /// \brief Construct a new Pyramid Sink object
+  ///
+  /// \param outputs The levels wanted and their sinks, only levels down to the smallest of them are made
+  ///
+  explicit PyramidSink(std::vector<Output> outputs);
+
+  ///
+  /// \brief Make the levels and pass them on
+  ///
+  /// \param frame The captured frame
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+ private:
+  /// \brief The levels wanted and their sinks
+  std::vector<Output> outputs_;
+  /// \brief Levels made
+  int levels_ = 0;
+  /// \brief The pyramid, made on the first frame for its size
+  std::unique_ptr<PreviewPyramid> pyramid_;
+};
+
+#endif  // PYRAMID_SINK_H
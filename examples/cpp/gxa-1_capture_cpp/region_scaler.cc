@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Crops and scales packed 4:2:2 frames in one pass, for what the driver cannot do itself
+///
+/// \file region_scaler.cc
+///
+
+#include "region_scaler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Centred sample position of output index i, in 1/256ths of a source index, clamped to the last source index
+static int sample_position(int i, int in, int out) {
+  int position = static_cast<int>((static_cast<int64_t>(2 * i + 1) * in * 256) / (2 * out)) - 128;
+  return std::clamp(position, 0, (in - 1) * 256);
+}
+
+CaptureRegion ParseCaptureRegion(const std::string &crop, const std::string &scale) {
+  CaptureRegion region;
+  char end;
+  if (!crop.empty() && (sscanf(crop.c_str(), "%d,%d,%d,%d%c", &region.x, &region.y, &region.width, &region.height,
+                               &end) != 4 ||
+                        region.x < 0 || region.y < 0 || region.width <= 0 || region.height <= 0)) {
+    throw std::runtime_error("Invalid crop '" + crop + "', expected x,y,width,height");
+  }
+  if (!scale.empty() && (sscanf(scale.c_str(), "%dx%d%c", &region.out_width, &region.out_height, &end) != 2 ||
+                         region.out_width <= 0 || region.out_height <= 0)) {
+    throw std::runtime_error("Invalid scale '" + scale + "', expected widthxheight");
+  }
+  return region;
+}
+
+void BlendRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int weight, int count) {
+  int i = 0;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(weight));
+  const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(256 - weight));
+  const __m128i half = _mm_set1_epi16(128);
+  for (; i + 16 <= count; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    // 255 * 256 fits an unsigned 16 bit lane, so the sum is taken unsigned
+    __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), wa),
+                                             _mm_mullo_epi16(_mm_unpacklo_epi8(y, zero), wb)),
+                               half);
+    __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), wa),
+                                             _mm_mullo_epi16(_mm_unpackhi_epi8(y, zero), wb)),
+                               half);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+  }
+#elif defined(__ARM_NEON)
+  // The weights as bytes, 256 - weight only fits when weight is not 0, the scalar loop takes that case
+  if (weight) {
+    const uint8x8_t wa = vdup_n_u8(static_cast<uint8_t>(256 - weight));
+    const uint8x8_t wb = vdup_n_u8(static_cast<uint8_t>(weight));
+    for (; i + 16 <= count; i += 16) {
+      uint8x16_t x = vld1q_u8(a + i);
+      uint8x16_t y = vld1q_u8(b + i);
+      uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(x), wa), vget_low_u8(y), wb);
+      uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(x), wa), vget_high_u8(y), wb);
+      vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+  }
+#endif
+
+  // Remainder, and the whole row on other architectures
+  for (; i < count; i++) dst[i] = static_cast<uint8_t>((a[i] * (256 - weight) + b[i] * weight + 128) >> 8);
+}
+
+RegionScaler::RegionScaler(int stride, int x, int y, int width, int height, int out_width, int out_height, bool uyvy)
+    : out_row_bytes_(out_width * 2),
+      span_bytes_(width * 2),
+      left_(static_cast<size_t>(x & ~1) * 2),
+      same_width_(width == out_width) {
+  if (width < 2 || height < 1 || out_width < 2 || out_height < 1 || (out_width & 1)) {
+    throw std::runtime_error("Invalid region " + std::to_string(width) + "x" + std::to_string(height) + " to " +
+                             std::to_string(out_width) + "x" + std::to_string(out_height));
+  }
+
+  for (int line = 0; line < out_height; line++) {
+    int position = sample_position(line, height, out_height);
+    size_t upper = static_cast<size_t>(y + (position >> 8)) * stride + left_;
+    int weight = position & 255;
+    rows_.push_back({upper, weight ? upper + stride : upper, weight});
+  }
+
+  // Luma is every other byte, U and V every fourth, at half the horizontal rate
+  int luma = uyvy ? 1 : 0;
+  for (int byte = 0; byte < out_row_bytes_; byte++) {
+    if ((byte & 1) == luma) {
+      int position = sample_position(byte / 2, width, out_width);
+      first_.push_back((position >> 8) * 2 + luma);
+      weight_.push_back(position & 255);
+      step_.push_back((position & 255) ? 2 : 0);
+    } else {
+      int position = sample_position(byte / 4, width / 2, out_width / 2);
+      first_.push_back((position >> 8) * 4 + (byte & 3));
+      weight_.push_back(position & 255);
+      step_.push_back((position & 255) ? 4 : 0);
+    }
+  }
+  span_.resize(span_bytes_);
+}
+
+void RegionScaler::ScaleAcross(const uint8_t *line, uint8_t *out) const {
+  for (int byte = 0; byte < out_row_bytes_; byte++) {
+    const uint8_t *sample = line + first_[byte];
+    int weight = weight_[byte];
+    out[byte] = static_cast<uint8_t>((sample[0] * (256 - weight) + sample[step_[byte]] * weight + 128) >> 8);
+  }
+}
+
+void RegionScaler::Scale(const uint8_t *src, uint8_t *dst) {
+  for (const Row &row : rows_) {
+    // Blended down first, over only the region's bytes, then resampled across once
+    const uint8_t *line = src + row.upper;
+    uint8_t *blended = same_width_ ? dst : span_.data();
+    if (row.weight) {
+      BlendRows(blended, line, src + row.lower, row.weight, span_bytes_);
+      line = blended;
+    } else if (same_width_) {
+      memcpy(dst, line, out_row_bytes_);
+    }
+    if (!same_width_) ScaleAcross(line, dst);
+    dst += out_row_bytes_;
+  }
+}
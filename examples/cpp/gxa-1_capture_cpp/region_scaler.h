@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Crops and scales packed 4:2:2 frames in one pass, for what the driver cannot do itself
+///
+/// \file region_scaler.h
+///
+
+#ifndef REGION_SCALER_H
+#define REGION_SCALER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/// \brief A region of the frame and the size it is output at
+struct CaptureRegion {
+  /// \brief Left edge in pixels
+  int x = 0;
+  /// \brief Top edge in frame lines
+  int y = 0;
+  /// \brief Width in pixels, 0 for the whole frame
+  int width = 0;
+  /// \brief Height in frame lines, 0 for the whole frame
+  int height = 0;
+  /// \brief Output width in pixels, 0 for the region's width
+  int out_width = 0;
+  /// \brief Output height in lines, 0 for the region's height
+  int out_height = 0;
+};
+
+///
+/// \brief Parse the region from the command line
+///
+/// \param crop x,y,width,height, empty for the whole frame
+/// \param scale widthxheight, empty for the region's size
+/// \return CaptureRegion The region, throws std::runtime_error if either does not parse
+///
+CaptureRegion ParseCaptureRegion(const std::string &crop, const std::string &scale);
+
+///
+/// \brief Blend two rows of bytes, the vertical half of the bilinear scale
+///
+/// \param dst The result, count bytes
+/// \param a The upper row
+/// \param b The lower row
+/// \param weight Weight of b out of 256, a gets the rest
+/// \param count Bytes in a row
+///
+void BlendRows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int weight, int count);
+
+///
+/// \brief Cuts a region out of each frame and scales it bilinearly to the output size, as YUYV or UYVY
+///
+/// Only the source lines and pixels each output line needs are read: the region's part of the two source lines
+/// either side of each output line, blended down together, then two samples of that per output byte, looked up in
+/// tables made once. Nothing outside the region is touched, so the work, and the bytes read and written, go with
+/// the region and output sizes rather than the frame size. Luma and chroma are resampled separately, chroma at
+/// half the horizontal rate. A region with no scaling across is blended straight into the output, or copied when
+/// there is no scaling down either. Sampling is centred, so halving each way averages each 2x2 block.
+///
+class RegionScaler {
+ public:
+  ///
+  /// \brief Construct a new Region Scaler object
+  ///
+  /// \param stride Source bytes per line
+  /// \param x Left edge of the region in pixels, rounded down to even
+  /// \param y Top edge of the region in lines
+  /// \param width Region width in pixels
+  /// \param height Region height in lines
+  /// \param out_width Output width in pixels, even
+  /// \param out_height Output height in lines
+  /// \param uyvy The bytes are U Y0 V Y1, otherwise Y0 U Y1 V
+  ///
+  RegionScaler(int stride, int x, int y, int width, int height, int out_width, int out_height, bool uyvy);
+
+  ///
+  /// \brief Crop and scale a frame
+  ///
+  /// \param src The source frame
+  /// \param dst The output, out_width * 2 bytes per line
+  ///
+  void Scale(const uint8_t *src, uint8_t *dst);
+
+  ///
+  /// \brief Bytes in an output frame
+  ///
+  /// \return size_t out_width * 2 * out_height
+  ///
+  size_t Bytes() const { return static_cast<size_t>(out_row_bytes_) * rows_.size(); }
+
+ private:
+  /// \brief The source lines blended into an output line
+  struct Row {
+    /// \brief Byte offset of the upper line
+    size_t upper;
+    /// \brief Byte offset of the lower line
+    size_t lower;
+    /// \brief Weight of the lower line out of 256
+    int weight;
+  };
+
+  ///
+  /// \brief Resample part of a source line across to the output width
+  ///
+  /// \param line The region's part of a source line
+  /// \param out The output width of bytes
+  ///
+  void ScaleAcross(const uint8_t *line, uint8_t *out) const;
+
+  /// \brief Bytes in an output line
+  int out_row_bytes_;
+  /// \brief Bytes of the region in a source line
+  int span_bytes_;
+  /// \brief Byte offset of the region's left edge in a line
+  size_t left_;
+  /// \brief The region is the output width, so lines are not resampled across
+  bool same_width_;
+  /// \brief Per output line
+  std::vector<Row> rows_;
+  /// \brief Per output byte, the first of its two samples, relative to left_
+  std::vector<uint32_t> first_;
+  /// \brief Per output byte, the weight of the second sample, which is 2 bytes on for luma and 4 for chroma
+  std::vector<uint8_t> weight_;
+  /// \brief Per output byte, how far on the second sample is
+  std::vector<uint8_t> step_;
+  /// \brief The region's part of two lines blended
+  std::vector<uint8_t> span_;
+};
+
+#endif  // REGION_SCALER_H
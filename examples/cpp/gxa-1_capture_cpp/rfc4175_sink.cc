@@ -0,0 +1,249 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief RFC 4175 uncompressed video sender, scatter-gather straight from the capture buffer
+///
+/// \file rfc4175_sink.cc
+///
+
+#include "rfc4175_sink.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/videodev2.h>
+#include <netinet/udp.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+// IPv4 and UDP headers
+static constexpr int kIpUdpHeaderSize = 28;
+// Largest UDP payload the kernel accepts in one GSO send, and the most segments it will split it into
+static constexpr int kMaxGsoBytes = 65000;
+static constexpr int kMaxGsoSegments = 64;
+// Dynamic RTP payload type
+static constexpr uint8_t kPayloadType = 96;
+
+static int64_t monotonic_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+Rfc4175Sink::Rfc4175Sink(const std::string &address, int port, std::string session_name, int fps, bool gso, int mtu,
+                         LoopbackLatency *latency)
+    : address_(address),
+      port_(port),
+      session_name_(std::move(session_name)),
+      fps_(fps),
+      gso_(gso),
+      // Whole 4 byte pixel groups (two pixels) after the IP, UDP and RTP headers
+      max_payload_((mtu - kIpUdpHeaderSize - RFC4175_HEADER_SIZE) / 4 * 4),
+      latency_(latency) {
+  std::random_device random;
+  ssrc_ = random();
+  timestamp_offset_ = random();
+  sequence_ = random() & 0xffff;
+
+  socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) throw std::runtime_error(std::string("RTP socket: ") + strerror(errno));
+
+  // A frame of packets goes in at once
+  int send_buffer = 4 * 1024 * 1024;
+  setsockopt(socket_, SOL_SOCKET, SO_SNDBUF, &send_buffer, sizeof(send_buffer));
+
+  struct sockaddr_in destination = {};
+  destination.sin_family = AF_INET;
+  destination.sin_port = htons(port_);
+  if (inet_pton(AF_INET, address_.c_str(), &destination.sin_addr) != 1) {
+    close(socket_);
+    throw std::runtime_error("Invalid RTP address " + address_);
+  }
+  if (IN_MULTICAST(ntohl(destination.sin_addr.s_addr))) {
+    int ttl = 15;
+    setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  }
+  // Connected, so the messages need no address
+  if (connect(socket_, reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination)) < 0) {
+    close(socket_);
+    throw std::runtime_error("RTP connect to " + address_ + ": " + strerror(errno));
+  }
+
+  // GSO needs Linux 4.18, without it every packet is its own datagram
+  if (gso_) {
+    int segment = 0;
+    if (setsockopt(socket_, SOL_UDP, UDP_SEGMENT, &segment, sizeof(segment)) < 0) {
+      std::cerr << "UDP_SEGMENT not supported, sending without GSO\n";
+      gso_ = false;
+    }
+  }
+}
+
+Rfc4175Sink::~Rfc4175Sink() {
+  if (socket_ >= 0) close(socket_);
+}
+
+void Rfc4175Sink::Prepare(const CapturedFrame &frame) {
+  width_ = frame.width;
+  height_ = frame.height;
+
+  int line_bytes = width_ * 2;
+  int packets_per_line = (line_bytes + max_payload_ - 1) / max_payload_;
+  size_t packets = static_cast<size_t>(packets_per_line) * height_;
+
+  header_ring_.assign(packets * RFC4175_HEADER_SIZE, 0);
+  iovecs_.assign(packets * 2, {});
+  messages_.assign(packets, {});
+  control_.assign(packets * CMSG_SPACE(sizeof(uint16_t)), 0);
+  segments_per_message_ = gso_ ? std::min(kMaxGsoSegments, kMaxGsoBytes / (RFC4175_HEADER_SIZE + max_payload_)) : 1;
+
+  // For receivers without SAP, for example gst-launch-1.0 or ffplay
+  bool interlaced = frame.field == V4L2_FIELD_TOP || frame.field == V4L2_FIELD_BOTTOM;
+  struct in_addr group;
+  bool multicast = inet_pton(AF_INET, address_.c_str(), &group) == 1 && IN_MULTICAST(ntohl(group.s_addr));
+  printf(
+      "v=0\no=- %u 1 IN IP4 0.0.0.0\ns=%s\nc=IN IP4 %s%s\nt=0 0\nm=video %d RTP/AVP %d\na=rtpmap:%d raw/90000\n"
+      "a=fmtp:%d sampling=YCbCr-4:2:2; width=%d; height=%d; depth=8; colorimetry=BT601-5%s\na=framerate:%d\n",
+      ssrc_, session_name_.c_str(), address_.c_str(), multicast ? "/15" : "", port_, kPayloadType, kPayloadType,
+      kPayloadType, width_,
+      interlaced ? height_ * 2 : height_, interlaced ? "; interlace" : "", interlaced ? fps_ / 2 : fps_);
+  printf("%zu packets per %s, %d per GSO send\n", packets, interlaced ? "field" : "frame", segments_per_message_);
+}
+
+void Rfc4175Sink::Consume(const CapturedFrame &frame) {
+  if (frame.pixelformat != V4L2_PIX_FMT_UYVY) return;
+
+  if (latency_) latency_->Sent(RtpTimestamp(frame), frame.timestamp_ns);
+  uint32_t first_sequence = sequence_;
+  int calls = SendFrame(frame);
+  if (calls < 0 && gso_) {
+    // The device cannot segment, for example no checksum offload, so send this frame and the rest one by one
+    std::cerr << "GSO send failed (" << strerror(errno) << "), sending without GSO\n";
+    gso_ = false;
+    width_ = 0;
+    sequence_ = first_sequence;
+    calls = SendFrame(frame);
+  }
+
+  // Packets per second and system calls per frame
+  int64_t now = monotonic_ns();
+  if (report_start_ns_ == 0) report_start_ns_ = now;
+  frames_++;
+  packets_ += messages_.size();
+  bytes_ += static_cast<uint64_t>(width_) * 2 * height_;
+  syscalls_ += std::max(calls, 0);
+  if (now - report_start_ns_ >= 5000000000LL) {
+    double seconds = (now - report_start_ns_) / 1e9;
+    printf("RFC 4175: %.1f frames/s, %.0f packets/s, %.1f Mbit/s, %.2f sendmmsg calls per frame%s\n",
+           frames_ / seconds, packets_ / seconds, bytes_ * 8 / seconds / 1e6,
+           static_cast<double>(syscalls_) / frames_, gso_ ? " (GSO)" : "");
+    report_start_ns_ = now;
+    frames_ = packets_ = bytes_ = syscalls_ = 0;
+  }
+}
+
+int Rfc4175Sink::SendFrame(const CapturedFrame &frame) {
+  if (frame.width != width_ || frame.height != height_) Prepare(frame);
+
+  int line_bytes = width_ * 2;
+  // The second field of a frame has the field bit set
+  uint16_t field_bit = frame.field == V4L2_FIELD_BOTTOM ? 0x8000 : 0;
+  uint32_t timestamp = RtpTimestamp(frame);
+
+  // Headers into the ring, payload iovecs straight into the capture buffer
+  size_t packets = 0;
+  size_t last = messages_.size() - 1;
+  for (int line = 0; line < height_; line++) {
+    const uint8_t *row = frame.data + static_cast<size_t>(line) * frame.stride;
+    for (int offset = 0; offset < line_bytes; offset += max_payload_, packets++) {
+      uint16_t length = static_cast<uint16_t>(std::min(max_payload_, line_bytes - offset));
+      uint8_t *header = &header_ring_[packets * RFC4175_HEADER_SIZE];
+      uint16_t sequence = htons(sequence_ & 0xffff);
+      uint16_t extended = htons(sequence_ >> 16);
+      uint32_t rtp_timestamp = htonl(timestamp);
+      uint32_t ssrc = htonl(ssrc_);
+      uint16_t line_length = htons(length);
+      uint16_t line_number = htons(field_bit | line);
+      uint16_t line_offset = htons(offset / 2);  // In pixels, continuation bit clear as there is one line per packet
+      sequence_++;
+
+      header[0] = 0x80;  // Version 2
+      header[1] = (packets == last ? 0x80 : 0) | kPayloadType;
+      memcpy(header + 2, &sequence, 2);
+      memcpy(header + 4, &rtp_timestamp, 4);
+      memcpy(header + 8, &ssrc, 4);
+      memcpy(header + 12, &extended, 2);
+      memcpy(header + 14, &line_length, 2);
+      memcpy(header + 16, &line_number, 2);
+      memcpy(header + 18, &line_offset, 2);
+
+      iovecs_[packets * 2] = {header, RFC4175_HEADER_SIZE};
+      iovecs_[packets * 2 + 1] = {const_cast<uint8_t *>(row + offset), length};
+    }
+  }
+
+  // One message per packet, or with GSO one per run of equal sized packets, ending at the first shorter one
+  int count = 0;
+  for (size_t first = 0; first < packets; count++) {
+    size_t size = iovecs_[first * 2 + 1].iov_len;
+    size_t end = first + 1;
+    while (end < packets && static_cast<int>(end - first) < segments_per_message_ &&
+           iovecs_[end * 2 + 1].iov_len <= size && iovecs_[(end - 1) * 2 + 1].iov_len == size) {
+      end++;
+    }
+
+    struct msghdr &message = messages_[count].msg_hdr;
+    message = {};
+    message.msg_iov = &iovecs_[first * 2];
+    message.msg_iovlen = (end - first) * 2;
+    if (end - first > 1) {
+      uint8_t *control = &control_[count * CMSG_SPACE(sizeof(uint16_t))];
+      message.msg_control = control;
+      message.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+      struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      uint16_t segment = static_cast<uint16_t>(RFC4175_HEADER_SIZE + size);
+      memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+    }
+    first = end;
+  }
+
+  return Send(count);
+}
+
+int Rfc4175Sink::Send(int count) {
+  int calls = 0;
+  int sent = 0;
+
+  while (sent < count) {
+    int result = sendmmsg(socket_, &messages_[sent], count - sent, 0);
+    calls++;
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      // GSO is refused per send if the route cannot offload it
+      if (gso_ && sent == 0 && (errno == EIO || errno == EINVAL)) return -1;
+      std::cerr << "RTP send failed: " << strerror(errno) << "\n";
+      break;
+    }
+    sent += result;
+  }
+  return calls;
+}
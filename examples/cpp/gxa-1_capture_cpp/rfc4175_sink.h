@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief RFC 4175 uncompressed video sender, scatter-gather straight from the capture buffer
+///
+/// \file rfc4175_sink.h
+///
+
+#ifndef RFC4175_SINK_H
+#define RFC4175_SINK_H
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+
+#include "frame_sink.h"
+#include "loopback_latency.h"
+
+/// \brief RTP, extended sequence number and one line header
+#define RFC4175_HEADER_SIZE 20
+
+///
+/// \brief Sends UYVY frames as RFC 4175 YCbCr 4:2:2 8 bit, one packet per line or part of a line
+///
+/// Each packet is two iovecs, its header from a preallocated ring and its payload pointing into the frame, so the
+/// payload is never copied in user space. A whole frame goes in as few sendmmsg() calls as the kernel allows, and
+/// with UDP_SEGMENT (GSO) the packets are also batched into a few large datagrams that the kernel splits.
+///
+class Rfc4175Sink : public FrameSink {
+ public:
+  ///
+  /// \brief Construct a new Rfc4175 Sink object, throws std::runtime_error if the socket cannot be opened
+  ///
+  /// \param address Multicast group or unicast address
+  /// \param port UDP port
+  /// \param session_name Session name for the SDP
+  /// \param fps Frames, or fields when interlaced, per second
+  /// \param gso Batch packets with UDP_SEGMENT if the kernel supports it
+  /// \param mtu Largest IP packet
+  /// \param latency Told when each frame is sent, or nullptr
+  ///
+  Rfc4175Sink(const std::string &address, int port, std::string session_name, int fps, bool gso = true,
+              int mtu = 1500, LoopbackLatency *latency = nullptr);
+
+  ///
+  /// \brief Destroy the Rfc4175 Sink object
+  ///
+  ///
+  ~Rfc4175Sink();
+
+  ///
+  /// \brief Send a frame
+  ///
+  /// \param frame The captured frame, UYVY
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+ private:
+  ///
+  /// \brief Size the header ring and message arrays for a frame and print the SDP
+  ///
+  /// \param frame The first frame
+  ///
+  void Prepare(const CapturedFrame &frame);
+
+  ///
+  /// \brief Packetise and send a frame
+  ///
+  /// \param frame The captured frame, UYVY
+  /// \return int The sendmmsg() calls made, -1 if the kernel refused GSO
+  ///
+  int SendFrame(const CapturedFrame &frame);
+
+  ///
+  /// \brief The RTP timestamp of a frame, its capture time on the 90 kHz clock
+  ///
+  /// \param frame The captured frame
+  /// \return uint32_t The timestamp
+  ///
+  uint32_t RtpTimestamp(const CapturedFrame &frame) const {
+    return static_cast<uint32_t>(frame.timestamp_ns / 1000 * 9 / 100) + timestamp_offset_;
+  }
+
+  ///
+  /// \brief Send the prepared messages, carrying on after a partial send
+  ///
+  /// \param count The number of messages
+  /// \return int The sendmmsg() calls made, -1 if the kernel refused GSO
+  ///
+  int Send(int count);
+
+  /// \brief The UDP socket, connected to the destination
+  int socket_ = -1;
+  /// \brief Destination address
+  std::string address_;
+  /// \brief Destination port
+  int port_;
+  /// \brief Session name for the SDP
+  std::string session_name_;
+  /// \brief Frames per second
+  int fps_;
+  /// \brief UDP_SEGMENT is in use
+  bool gso_;
+  /// \brief Largest payload, a multiple of the 4 byte pixel group
+  int max_payload_;
+  /// \brief The latency probe, or nullptr
+  LoopbackLatency *latency_;
+  /// \brief Frame size the arrays are prepared for
+  int width_ = 0;
+  /// \brief Lines the arrays are prepared for
+  int height_ = 0;
+  /// \brief Packet headers, RFC4175_HEADER_SIZE bytes each, one slot per packet in a frame
+  std::vector<uint8_t> header_ring_;
+  /// \brief Two iovecs per packet, header then payload
+  std::vector<struct iovec> iovecs_;
+  /// \brief One message per packet, or per GSO batch
+  std::vector<struct mmsghdr> messages_;
+  /// \brief UDP_SEGMENT control messages, one per GSO batch
+  std::vector<uint8_t> control_;
+  /// \brief Packets per GSO batch
+  int segments_per_message_ = 1;
+  /// \brief RTP synchronisation source
+  uint32_t ssrc_;
+  /// \brief Extended sequence number, the RTP header has the low 16 bits
+  uint32_t sequence_ = 0;
+  /// \brief Offset added to the RTP timestamp
+  uint32_t timestamp_offset_;
+  /// \brief Statistics, start of the report period
+  int64_t report_start_ns_ = 0;
+  /// \brief Statistics, frames in the period
+  uint64_t frames_ = 0;
+  /// \brief Statistics, packets in the period
+  uint64_t packets_ = 0;
+  /// \brief Statistics, payload bytes in the period
+  uint64_t bytes_ = 0;
+  /// \brief Statistics, sendmmsg() calls in the period
+  uint64_t syscalls_ = 0;
+};
+
+#endif  // RFC4175_SINK_H
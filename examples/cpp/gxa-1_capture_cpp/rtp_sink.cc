@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Sends captured frames as RTP with a SAP announcement, using the mediax transmitters
+///
+/// \file rtp_sink.cc
+///
+
+#include "rtp_sink.h"
+
+#include <linux/videodev2.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+RtpCodec ParseRtpCodec(const std::string &name) {
+  if (name == "raw") return RtpCodec::kRaw;
+  if (name == "h264") return RtpCodec::kH264;
+  throw std::runtime_error("Unknown RTP codec '" + name + "', expected raw or h264");
+}
+
+RtpSink::RtpSink(RtpCodec codec, std::string address, int port, std::string session_name, int fps,
+                 LoopbackLatency *latency)
+    : codec_(codec),
+      address_(std::move(address)),
+      port_(port),
+      session_name_(std::move(session_name)),
+      fps_(fps),
+      latency_(latency) {}
+
+void RtpSink::Consume(const CapturedFrame &frame) {
+  // mediax YUV422 is UYVY, a YUYV capture would need its bytes swapped
+  if (frame.pixelformat != V4L2_PIX_FMT_UYVY) {
+    if (!format_error_) std::cerr << "RTP needs a UYVY capture, frames are not being sent\n";
+    format_error_ = true;
+    return;
+  }
+
+  // Announce the size actually captured
+  if (!raw_ && !h264_) {
+    std::cout << "Sending " << session_name_ << " to " << address_ << ":" << port_ << ", " << frame.width << "x"
+              << frame.height << " " << (codec_ == RtpCodec::kRaw ? "raw" : "H.264") << "\n";
+    if (codec_ == RtpCodec::kRaw) {
+      raw_ = std::make_unique<mediax::RtpSapTransmit<mediax::rtp::uncompressed::RtpUncompressedPayloader>>(
+          address_, port_, session_name_, frame.width, frame.height, fps_, "YUV422");
+    } else {
+      h264_ = std::make_unique<mediax::RtpSapTransmit<mediax::rtp::h264::gst::open::RtpH264GstOpenPayloader>>(
+          address_, port_, session_name_, frame.width, frame.height, fps_, "H264");
+    }
+  }
+
+  // Straight from the driver's buffer, the payloader does not keep it after Transmit() returns
+  uint8_t *data = const_cast<uint8_t *>(frame.data);
+  // The payloader stamps the frame itself, so the probe binds it to the RTP timestamp when it arrives
+  if (latency_) latency_->Sent(frame.timestamp_ns);
+  if (raw_) raw_->Transmit(data, false);
+  if (h264_) h264_->Transmit(data, false);
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Sends captured frames as RTP with a SAP announcement, using the mediax transmitters
+///
+/// \file rtp_sink.h
+///
+
+#ifndef RTP_SINK_H
+#define RTP_SINK_H
+
+#include <memory>
+#include <string>
+
+#include "frame_sink.h"
+#include "loopback_latency.h"
+#include "rtp/rtp.h"
+
+/// \brief How the frames are sent
+enum class RtpCodec {
+  /// \brief Uncompressed RFC 4175 YCbCr 4:2:2
+  kRaw,
+  /// \brief H.264
+  kH264
+};
+
+///
+/// \brief Parse an RTP codec name
+///
+/// \param name raw or h264, throws std::runtime_error otherwise
+/// \return RtpCodec The codec
+///
+RtpCodec ParseRtpCodec(const std::string &name);
+
+///
+/// \brief Publishes the captured frames as an RTP/SAP session
+///
+/// Frames are passed to mediax straight from the capture buffer as YCbCr 4:2:2, there is no RGB conversion. The
+/// capture has to be UYVY, the RFC 4175 byte order. The transmitter is created on the first frame so the session
+/// announces the size actually captured, a field when the capture is interlaced.
+///
+class RtpSink : public FrameSink {
+ public:
+  ///
+  /// \brief Construct a new Rtp Sink object
+  ///
+  /// \param codec Raw or H.264
+  /// \param address Multicast group or unicast address
+  /// \param port UDP port
+  /// \param session_name SAP session name
+  /// \param fps Frames, or fields when interlaced, per second
+  /// \param latency Told when each frame is sent, or nullptr
+  ///
+  RtpSink(RtpCodec codec, std::string address, int port, std::string session_name, int fps,
+          LoopbackLatency *latency = nullptr);
+
+  ///
+  /// \brief Send a frame
+  ///
+  /// \param frame The captured frame
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+ private:
+  /// \brief Raw or H.264
+  RtpCodec codec_;
+  /// \brief Multicast group or unicast address
+  std::string address_;
+  /// \brief UDP port
+  int port_;
+  /// \brief SAP session name
+  std::string session_name_;
+  /// \brief Frames per second
+  int fps_;
+  /// \brief The latency probe, or nullptr
+  LoopbackLatency *latency_;
+  /// \brief The uncompressed transmitter
+  std::unique_ptr<mediax::RtpSapTransmit<mediax::rtp::uncompressed::RtpUncompressedPayloader>> raw_;
+  /// \brief The H.264 transmitter
+  std::unique_ptr<mediax::RtpSapTransmit<mediax::rtp::h264::gst::open::RtpH264GstOpenPayloader>> h264_;
+  /// \brief A wrong pixel format has been reported
+  bool format_error_ = false;
+};
+
+#endif  // RTP_SINK_H
@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Writes captured frames to a shared memory ring for readers in other processes
+///
+/// \file shm_ring_sink.cc
+///
+
+#include "shm_ring_sink.h"
+
+#include <iostream>
+#include <utility>
+
+ShmRingSink::ShmRingSink(std::string name, int slots) : name_(std::move(name)), slots_(slots) {}
+
+void ShmRingSink::Consume(const CapturedFrame &frame) {
+  if (!writer_) {
+    writer_ = std::make_unique<ShmRingWriter>(name_, slots_, frame.bytes);
+    std::cout << "Writing " << frame.width << "x" << frame.height << " frames to shared memory " << name_ << ", "
+              << slots_ << " slots\n";
+  }
+
+  ShmRingFrame out = {};
+  out.width = frame.width;
+  out.height = frame.height;
+  out.stride = frame.stride;
+  out.fourcc = frame.pixelformat;
+  out.field = frame.field;
+  out.sequence = frame.sequence;
+  out.timestamp_ns = frame.timestamp_ns;
+  out.bytes = frame.bytes;
+  out.data = frame.data;
+  // The one copy, out of the driver's buffer before it goes back
+  writer_->Write(out);
+}
@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Writes captured frames to a shared memory ring for readers in other processes
+///
+/// \file shm_ring_sink.h
+///
+
+#ifndef SHM_RING_SINK_H
+#define SHM_RING_SINK_H
+
+#include <memory>
+#include <string>
+
+#include "frame_sink.h"
+#include "shm_ring/shm_ring.h"
+
+///
+/// \brief Copies every frame, or field when interlaced, into a ShmRingWriter, as captured, YUYV or UYVY
+///
+/// The ring is created on the first frame, sized for the frames actually captured. The capture never waits for
+/// readers, any number of which, C++ or Python, follow the ring independently and read the frames in place.
+///
+class ShmRingSink : public FrameSink {
+ public:
+  ///
+  /// \brief Construct a new Shm Ring Sink object
+  ///
+  /// \param name The POSIX shared memory name, for example /gxa-video0
+  /// \param slots Frames held, how long readers can keep a frame in place
+  ///
+  ShmRingSink(std::string name, int slots);
+
+  ///
+  /// \brief Write a frame
+  ///
+  /// \param frame The captured frame
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+ private:
+  /// \brief The POSIX shared memory name
+  std::string name_;
+  /// \brief Frames held
+  int slots_;
+  /// \brief The ring, created on the first frame
+  std::unique_ptr<ShmRingWriter> writer_;
+};
+
+#endif  // SHM_RING_SINK_H
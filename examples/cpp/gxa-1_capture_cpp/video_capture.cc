@@ -27,6 +27,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -35,19 +36,20 @@
 #include <thread>
 #include <vector>
 
-extern "C" {
-#include <libswscale/swscale.h>
-}
-
 // Indicate if the video processing is interlaced
 DEFINE_bool(interlaced, false, "Interlaced video");
-
-int count = 0;
-// Timestamp
-struct timeval start, end;
-
-VideoCapture::VideoCapture(const std::string &device, io_method io, const std::string &video_standard)
-    : dev_name(device), io(io), fd(-1), video_standard(video_standard) {
+DEFINE_string(deinterlace, "adaptive", "How interlaced fields are shown [bob, weave, adaptive]");
+DEFINE_bool(pair_fields, false, "Weave the two interlaced fields of each frame into one, for 25 or 30 frames a second");
+
+VideoCapture::VideoCapture(const std::string &device, io_method io, const std::string &video_standard, bool show,
+                           uint32_t pixelformat, const CaptureRegion &region)
+    : dev_name(device),
+      io(io),
+      fd(-1),
+      video_standard(video_standard),
+      show(show),
+      pixelformat(pixelformat),
+      region(region) {
   // Set correct resolution based on standard
   if (video_standard == "NTSC") {
     height = 480;
@@ -56,6 +58,29 @@ VideoCapture::VideoCapture(const std::string &device, io_method io, const std::s
     height = 576;
     width = 720;
   }
+  full_width = capture_width = width;
+  full_height = capture_height = height;
+
+  // Everything after the capture sees the output size. Interlaced regions are whole frame lines on even lines, so
+  // each field gets half of them, and 4:2:2 needs an even number of pixels.
+  CaptureRegion &r = this->region;
+  if (!r.width) r.width = full_width - r.x;
+  if (!r.height) r.height = full_height - r.y;
+  if (r.x + r.width > full_width || r.y + r.height > full_height) {
+    throw std::runtime_error("Crop region is outside the " + std::to_string(full_width) + "x" +
+                             std::to_string(full_height) + " frame");
+  }
+  if (!r.out_width) r.out_width = r.width;
+  if (!r.out_height) r.out_height = r.height;
+  r.x &= ~1;
+  r.out_width &= ~1;
+  if (FLAGS_interlaced) {
+    r.y &= ~1;
+    r.height &= ~1;
+    r.out_height &= ~1;
+  }
+  width = r.out_width;
+  height = r.out_height;
 
   std::string type = "";
   if (FLAGS_interlaced) {
@@ -70,20 +95,32 @@ VideoCapture::VideoCapture(const std::string &device, io_method io, const std::s
   else
     std::cout << "Progressive video" << std::endl;
 
-  display.Initalise(width, height, "Capture " + video_standard + " (" + type + ")");
-  std::thread display_thread(&DisplayManager::Run, &display);
-  display_thread.detach();
+  // Without a window the frames only go to the sinks
+  if (show) {
+    display.Initalise(width, height, "Capture " + video_standard + " (" + type + ")");
+    std::thread display_thread(&DisplayManager::Run, &display);
+    display_thread.detach();
+  }
+  // Fields are either woven back into frames for everything downstream, or each shown as a full frame
+  int64_t field_period_ns = video_standard == "NTSC" ? 16683350 : 20000000;
+  if (FLAGS_interlaced && FLAGS_pair_fields) {
+    // NTSC sends the bottom field first
+    pairer = std::make_unique<FieldPairer>(width, height, BYTESPERPIXEL, field_period_ns, video_standard != "NTSC");
+  } else if (show && FLAGS_interlaced) {
+    deinterlacer = std::make_unique<Deinterlacer>(ParseDeinterlaceMode(FLAGS_deinterlace), width, height,
+                                                  field_period_ns);
+  }
   open_device();
   init_device();
   start_capturing();
-  gettimeofday(&start, NULL);
+  gettimeofday(&fps_start, NULL);
 }
 
 VideoCapture::~VideoCapture() {
   stop_capturing();
   uninit_device();
   close_device();
-  display.Stop();
+  if (show) display.Stop();
 }
 
 void VideoCapture::Start() { mainloop(); }
@@ -106,12 +143,14 @@ int VideoCapture::xioctl(int fd, int request, void *arg) {
 void VideoCapture::yuv422_to_rgb(const uint8_t *yuv, uint8_t *rgb, int width, int height) {
   int frameSize = width * height * 2;
   int rgbIndex = 0;
+  // YUYV is Y0 U Y1 V, UYVY is U Y0 V Y1
+  bool uyvy = pixelformat == V4L2_PIX_FMT_UYVY;
 
   for (int i = 0; i < frameSize; i += 4) {
-    uint8_t y0 = yuv[i];
-    uint8_t u = yuv[i + 1];
-    uint8_t y1 = yuv[i + 2];
-    uint8_t v = yuv[i + 3];
+    uint8_t y0 = yuv[i + (uyvy ? 1 : 0)];
+    uint8_t u = yuv[i + (uyvy ? 0 : 1)];
+    uint8_t y1 = yuv[i + (uyvy ? 3 : 2)];
+    uint8_t v = yuv[i + (uyvy ? 2 : 3)];
 
     int c = y0 - 16;
     int d = u - 128;
@@ -136,42 +175,63 @@ void VideoCapture::yuv422_to_rgb(const uint8_t *yuv, uint8_t *rgb, int width, in
   }
 }
 
-void VideoCapture::process_image(const void *p, int field) {
+void VideoCapture::process_image(const void *p, int field, const struct v4l2_buffer *buf) {
   image_info_t info;
 
+  int64_t timestamp_ns;
+  if (buf && (buf->flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+    timestamp_ns = buf->timestamp.tv_sec * 1000000000LL + buf->timestamp.tv_usec * 1000LL;
+  } else {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timestamp_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+
+  // Cropped and scaled here if the driver could not, before anything else sees the frame
+  if (scaler) {
+    scaler->Scale(static_cast<const uint8_t *>(p), scaled.data());
+    p = scaled.data();
+  }
+
+  // Both fields of a frame are woven before the sinks or display see either, which then run at the frame rate
+  if (pairer) {
+    p = pairer->Field(static_cast<const uint8_t *>(p), field, timestamp_ns);
+    if (!p) return;
+    timestamp_ns = pairer->TimestampNs();
+    field = V4L2_FIELD_INTERLACED;
+  }
+
+  // The sinks get the frame as captured, still in the driver's buffer unless the fields were paired
+  if (!sinks.empty()) {
+    CapturedFrame frame;
+    frame.data = static_cast<const uint8_t *>(p);
+    frame.width = width;
+    frame.height = FLAGS_interlaced && !pairer ? height / 2 : height;
+    frame.stride = width * BYTESPERPIXEL;
+    frame.bytes = static_cast<size_t>(frame.stride) * frame.height;
+    frame.pixelformat = pixelformat;
+    frame.field = field;
+    frame.sequence = buf ? buf->sequence : 0;
+    frame.buffer_index = buf && io == IO_METHOD_MMAP && !pairer && !scaler ? static_cast<int>(buf->index) : -1;
+    frame.timestamp_ns = timestamp_ns;
+    for (FrameSink *sink : sinks) sink->Consume(frame);
+  }
+  if (!show) return;
+
   // set up the image save( or if SDL, display to screen)
   info.width = width;
   info.height = height;
   info.stride = info.width * BYTESPERPIXEL;
 
-  if (FLAGS_interlaced) {
-    int offset = 0;
-    if (field == V4L2_FIELD_TOP) {
-      // Start one line down
-      offset = info.width * BYTESPERPIXEL;
-    }
-    // Use swscale to scale the RGB image to 2 * height
-    SwsContext *sws_ctx = sws_getContext(width, height / 2, AV_PIX_FMT_YUYV422, width, height, AV_PIX_FMT_RGB24,
-                                         SWS_BILINEAR, NULL, NULL, NULL);
-    std::vector<uint8_t> scaled_rgb_buffer(width * height * 3);
-    uint8_t *srcSlice[] = {(uint8_t *)p + offset};
-    int srcStride[] = {info.width * 2};
-    uint8_t *dstSlice[] = {scaled_rgb_buffer.data()};
-    int dstStride[] = {info.width * 3};
-
-    sws_scale(sws_ctx, srcSlice, srcStride, 0, height / 2, dstSlice, dstStride);
-    sws_freeContext(sws_ctx);
+  // Fields are made into full frames while still 4:2:2, so there is one conversion to RGB at full size
+  const uint8_t *yuv = static_cast<const uint8_t *>(p);
+  if (deinterlacer) yuv = deinterlacer->Field(yuv, field, timestamp_ns);
 
-    Resolution res = {info.width, info.height, 3};
-    display.DisplayBuffer(scaled_rgb_buffer.data(), res, "Video Capture");
-
-  } else {
-    // Convert YUV422 to RGB
-    std::vector<uint8_t> rgb_buffer(width * height * 3);
-    yuv422_to_rgb((const uint8_t *)p, rgb_buffer.data(), width, height);
-    Resolution res = {info.width, info.height, 3};
-    display.DisplayBuffer(rgb_buffer.data(), res, "Video Capture");
-  }
+  // Convert YUV422 to RGB
+  std::vector<uint8_t> rgb_buffer(width * height * 3);
+  yuv422_to_rgb(yuv, rgb_buffer.data(), width, height);
+  Resolution res = {info.width, info.height, 3};
+  display.DisplayBuffer(rgb_buffer.data(), res, "Video Capture");
 }
 
 int VideoCapture::read_frame() {
@@ -195,7 +255,7 @@ int VideoCapture::read_frame() {
         }
       }
 
-      process_image(buffers[0].start, 0);
+      process_image(buffers[0].start, 0, nullptr);
 
       break;
 
@@ -232,7 +292,7 @@ int VideoCapture::read_frame() {
       }
       // std::cout << "Field: " << (buf.field == V4L2_FIELD_TOP ? "TOP" : "BOTTOM") << std::endl;
 
-      process_image(buffers[buf.index].start, field);
+      process_image(buffers[buf.index].start, field, &buf);
 
       if (-1 == xioctl(fd, VIDIOC_QBUF, &buf)) errno_exit("VIDIOC_QBUF");
     } break;
@@ -263,7 +323,7 @@ int VideoCapture::read_frame() {
 
       assert(i < buffers.size());
 
-      process_image((void *)buf.m.userptr, 0);
+      process_image((void *)buf.m.userptr, 0, &buf);
 
       if (-1 == xioctl(fd, VIDIOC_QBUF, &buf)) errno_exit("VIDIOC_QBUF");
 
@@ -302,13 +362,22 @@ void VideoCapture::mainloop() {
 #if 0
     std::cout << "." << std::flush;
 #else
-    count++;
+    fps_count++;
     // Reset count every one second and print it out
+    struct timeval end;
     gettimeofday(&end, NULL);
-    if (end.tv_sec - start.tv_sec >= 1) {
-      std::cout << "FPS: " << count << "\r" << std::flush;
-      count = 0;
-      gettimeofday(&start, NULL);
+    if (end.tv_sec - fps_start.tv_sec >= 1) {
+      std::cout << "FPS: " << fps_count;
+      if (pairer) {
+        FieldPairStats stats = pairer->TakeStats();
+        std::cout << ", frames: " << stats.frames << ", unpaired fields: " << stats.unpaired;
+      }
+      if (deinterlacer && deinterlacer->Mode() != DeinterlaceMode::kBob) {
+        std::cout << ", unpaired fields: " << deinterlacer->TakeUnpaired();
+      }
+      std::cout << "\r" << std::flush;
+      fps_count = 0;
+      gettimeofday(&fps_start, NULL);
     }
 #endif
 
@@ -524,7 +593,19 @@ void VideoCapture::init_device() {
 
   // Select video input, video standard and tune here.
 
-  // Reset Cropping
+  // Select standard
+  set_video_standard(video_standard);
+  sleep(1);
+
+  // Select input
+  input = 0;  // Composite-0
+  if (-1 == ioctl(fd, VIDIOC_S_INPUT, &input)) {
+    perror("VIDIOC_S_INPUT");
+    exit(EXIT_FAILURE);
+  }
+  sleep(1);
+
+  // Reset Cropping, for the standard just selected
   CLEAR(cropcap);
   cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -547,40 +628,43 @@ void VideoCapture::init_device() {
   }
   sleep(1);
 
-  // Select standard
-  set_video_standard(video_standard);
-  sleep(1);
-
-  // Select input
-  input = 0;  // Composite-0
-  if (-1 == ioctl(fd, VIDIOC_S_INPUT, &input)) {
-    perror("VIDIOC_S_INPUT");
-    exit(EXIT_FAILURE);
+  // The driver crops if it can. The selection goes after the standard and format, either of which may reset it, and
+  // is read back, so a driver that does not keep it is caught and the frame cropped here instead
+  bool whole = region.x == 0 && region.y == 0 && region.width == full_width && region.height == full_height;
+  bool driver_crop = false;
+  if (!whole) {
+    set_format(width, height, &fmt);
+    driver_crop = set_crop_selection(&fmt);
+    if (!driver_crop) {
+      std::cout << dev_name << " cannot crop, cropping each frame" << std::endl;
+      xioctl(fd, VIDIOC_S_CROP, &crop);
+    }
   }
-  sleep(1);
 
-  CLEAR(fmt);
-
-  fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-  fmt.fmt.pix.width = width;
-  fmt.fmt.pix.height = height;
-  fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
-  if (FLAGS_interlaced) {
-    fmt.fmt.pix.field = V4L2_FIELD_ALTERNATE;
-    // Interlaces so height is halved
-    fmt.fmt.pix.height = height / 2;
+  // The driver scales the cropped region to the output size, or else the whole frame to the size at which the
+  // region comes out at the output size, so at most a crop is left to do and no more than needed is captured
+  if (!driver_crop) {
+    set_format(std::min(full_width * width / region.width, full_width),
+               std::min(full_height * height / region.height, full_height), &fmt);
   }
-  if (BYTESPERPIXEL == 2)
-    if (-1 == xioctl(fd, VIDIOC_S_FMT, &fmt)) errno_exit("VIDIOC_S_FMT");
 
   // Note VIDIOC_S_FMT may change width and height.
 
+  // The sinks rely on the byte order, so a substituted format is an error
+  if (fmt.fmt.pix.pixelformat != pixelformat) {
+    throw std::runtime_error(dev_name + " does not support the requested pixel format");
+  }
+
   // Buggy driver paranoia.
   min = fmt.fmt.pix.width * BYTESPERPIXEL;
   if (fmt.fmt.pix.bytesperline < min) fmt.fmt.pix.bytesperline = min;
   min = fmt.fmt.pix.bytesperline * fmt.fmt.pix.height;
   if (fmt.fmt.pix.sizeimage < min) fmt.fmt.pix.sizeimage = min;
 
+  capture_width = fmt.fmt.pix.width;
+  capture_height = fmt.fmt.pix.height * (FLAGS_interlaced ? 2 : 1);
+  init_region_scaler(driver_crop, fmt.fmt.pix.bytesperline);
+
   switch (io) {
     case IO_METHOD_READ:
       init_read(fmt.fmt.pix.sizeimage);
@@ -596,6 +680,67 @@ void VideoCapture::init_device() {
   }
 }
 
+void VideoCapture::set_format(int request_width, int request_height, struct v4l2_format *fmt) {
+  CLEAR(*fmt);
+  fmt->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  fmt->fmt.pix.width = request_width;
+  fmt->fmt.pix.height = request_height;
+  fmt->fmt.pix.pixelformat = pixelformat;
+  if (FLAGS_interlaced) {
+    fmt->fmt.pix.field = V4L2_FIELD_ALTERNATE;
+    // Interlaces so height is halved
+    fmt->fmt.pix.height = request_height / 2;
+  }
+  if (BYTESPERPIXEL == 2)
+    if (-1 == xioctl(fd, VIDIOC_S_FMT, fmt)) errno_exit("VIDIOC_S_FMT");
+}
+
+bool VideoCapture::set_crop_selection(struct v4l2_format *fmt) {
+  struct v4l2_selection selection;
+  CLEAR(selection);
+  selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  selection.target = V4L2_SEL_TGT_CROP;
+  selection.r.left = region.x;
+  selection.r.top = region.y;
+  selection.r.width = region.width;
+  selection.r.height = region.height;
+  if (-1 == xioctl(fd, VIDIOC_S_SELECTION, &selection)) return false;
+
+  // What the driver kept, it adjusts the rectangle to what it can do and a different one is no use
+  CLEAR(selection);
+  selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  selection.target = V4L2_SEL_TGT_CROP;
+  if (-1 == xioctl(fd, VIDIOC_G_SELECTION, &selection)) return false;
+  if (selection.r.left != region.x || selection.r.top != region.y ||
+      static_cast<int>(selection.r.width) != region.width || static_cast<int>(selection.r.height) != region.height) {
+    return false;
+  }
+
+  // A driver without a scaler changes the format to the size of the rectangle
+  if (-1 == xioctl(fd, VIDIOC_G_FMT, fmt)) errno_exit("VIDIOC_G_FMT");
+  return true;
+}
+
+void VideoCapture::init_region_scaler(bool driver_crop, int stride) {
+  // The region in the captured frame, which the driver may have scaled
+  int x = driver_crop ? 0 : region.x * capture_width / full_width;
+  int y = driver_crop ? 0 : region.y * capture_height / full_height;
+  int w = driver_crop ? capture_width : region.width * capture_width / full_width;
+  int h = driver_crop ? capture_height : region.height * capture_height / full_height;
+  if (x == 0 && y == 0 && w == capture_width && h == capture_height && w == width && h == height) {
+    std::cout << "Capturing " << width << "x" << height << " in the driver" << std::endl;
+    return;
+  }
+
+  // Fields have every other line of the region
+  int lines = FLAGS_interlaced ? 2 : 1;
+  scaler = std::make_unique<RegionScaler>(stride, x, y / lines, w, h / lines, width, height / lines,
+                                          pixelformat == V4L2_PIX_FMT_UYVY);
+  scaled.resize(scaler->Bytes());
+  std::cout << "Capturing " << capture_width << "x" << capture_height << ", region " << w << "x" << h << " at " << x
+            << "," << y << " scaled to " << width << "x" << height << std::endl;
+}
+
 void VideoCapture::close_device() {
   if (-1 == close(fd)) errno_exit("close");
 
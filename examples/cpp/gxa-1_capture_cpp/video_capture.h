@@ -14,13 +14,21 @@
 #ifndef VIDEO_CAPTURE_H
 #define VIDEO_CAPTURE_H
 
+#include <linux/videodev2.h>
+#include <sys/time.h>
+
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "common/display_manager_sdl.h"
+#include "deinterlacer.h"
+#include "field_pairer.h"
+#include "region_scaler.h"
+#include "frame_sink.h"
 
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
 #define WIDTH 720
@@ -54,11 +62,30 @@ typedef struct {
 /// \brief Video capture class
 class VideoCapture {
  public:
-  VideoCapture(const std::string &device, io_method io, const std::string &video_standard);
+  ///
+  /// \brief Construct a new Video Capture object, opens the device and starts capturing
+  ///
+  /// \param device The video device
+  /// \param io The i/o method
+  /// \param video_standard PAL or NTSC
+  /// \param show Show the frames in a window, false to only pass them to the sinks
+  /// \param pixelformat V4L2_PIX_FMT_YUYV, or V4L2_PIX_FMT_UYVY which is the RFC 4175 4:2:2 byte order
+  /// \param region Part of the frame to capture and the size to output it at, the whole frame by default. The
+  /// driver crops and scales where it can and the rest is done as each frame is captured.
+  ///
+  VideoCapture(const std::string &device, io_method io, const std::string &video_standard, bool show = true,
+               uint32_t pixelformat = V4L2_PIX_FMT_YUYV, const CaptureRegion &region = CaptureRegion());
   ~VideoCapture();
   void Start();
   void Stop();
 
+  ///
+  /// \brief Pass every captured frame to a sink, before Start()
+  ///
+  /// \param sink The sink, not owned
+  ///
+  void AddSink(FrameSink *sink) { sinks.push_back(sink); }
+
  private:
   ///
   /// \brief Handle errors by printing a message and exiting
@@ -78,7 +105,7 @@ class VideoCapture {
   int xioctl(int fd, int request, void *arg);
 
   ///
-  /// \brief Convert YUV422 to RGB
+  /// \brief Convert YUV422 to RGB, in the capture byte order
   ///
   /// \param yuv The input YUV buffer
   /// \param rgb The output RGB buffer
@@ -88,12 +115,13 @@ class VideoCapture {
   void yuv422_to_rgb(const uint8_t *yuv, uint8_t *rgb, int width, int height);
 
   ///
-  /// \brief Process a captured image
+  /// \brief Process a captured image, pass it to the sinks and show it
   ///
   /// \param p The image buffer
   /// \param field Indicated TOP or BOTTOM for interlaced video
+  /// \param buf The dequeued V4L2 buffer, nullptr for read() i/o
   ///
-  void process_image(const void *p, int field);
+  void process_image(const void *p, int field, const struct v4l2_buffer *buf);
 
   ///
   /// \brief Read a frame from the video device
@@ -147,6 +175,31 @@ class VideoCapture {
   ///
   void init_device();
 
+  ///
+  /// \brief Set the capture format
+  ///
+  /// \param request_width Frame width asked for
+  /// \param request_height Frame height asked for, a field is half of it when interlaced
+  /// \param fmt The format the driver chose, which may differ from the request
+  ///
+  void set_format(int request_width, int request_height, struct v4l2_format *fmt);
+
+  ///
+  /// \brief Ask the driver to crop to the region, after the standard and format are set as either may reset it
+  ///
+  /// \param fmt Updated with the format the driver is using with the crop
+  /// \return true if reading the selection back gives exactly the region
+  ///
+  bool set_crop_selection(struct v4l2_format *fmt);
+
+  ///
+  /// \brief Make the scaler for whatever cropping and scaling the driver did not do
+  ///
+  /// \param driver_crop The driver cropped to the region
+  /// \param stride Bytes per captured line
+  ///
+  void init_region_scaler(bool driver_crop, int stride);
+
   ///
   /// \brief Close the video device
   ///
@@ -164,14 +217,41 @@ class VideoCapture {
   ///
   void set_video_standard(const std::string &video_standard);
 
+  /// \brief Output height, the region's output height
   int height;
+  /// \brief Output width
   int width;
+  /// \brief The whole frame for the video standard, in pixels
+  int full_width;
+  /// \brief The whole frame in lines
+  int full_height;
+  /// \brief The size the driver captures at, in pixels
+  int capture_width;
+  /// \brief The captured frame height in lines, twice the field height when interlaced
+  int capture_height;
   std::string dev_name;
   io_method io;
   int fd;
   std::vector<buffer> buffers;
   DisplayManager display;
   std::string video_standard;
+  bool show;
+  uint32_t pixelformat;
+  /// \brief The region in the whole frame and its output size
+  CaptureRegion region;
+  std::vector<FrameSink *> sinks;
+  /// \brief Makes the fields shown into frames, nullptr when progressive or not shown
+  std::unique_ptr<Deinterlacer> deinterlacer;
+  /// \brief Weaves each frame's fields together, nullptr unless pairing fields
+  std::unique_ptr<FieldPairer> pairer;
+  /// \brief Crops and scales what the driver did not, nullptr if it did it all
+  std::unique_ptr<RegionScaler> scaler;
+  /// \brief The scaler's output
+  std::vector<uint8_t> scaled;
+  /// \brief Frames since fps_start, per capture so several can run in one process
+  int fps_count = 0;
+  /// \brief Start of the second being counted
+  struct timeval fps_start;
 };
 
 #endif  // VIDEO_CAPTURE_H
@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Publishes captured frames on zenoh, through shared memory to subscribers on this host
+///
+/// \file zenoh_sink.cc
+///
+
+#include "zenoh_sink.h"
+
+#include <iostream>
+
+ZenohSink::ZenohSink(zenoh::Session &session, const std::string &key, size_t shm_bytes)
+    : publisher_(std::make_unique<ShmFramePublisher>(session, key, shm_bytes)) {
+  std::cout << "Publishing frames on " << key << (publisher_->Shm() ? " through shared memory" : "") << "\n";
+}
+
+void ZenohSink::Consume(const CapturedFrame &frame) {
+  VideoFrameHeader header = {};
+  header.width = frame.width;
+  header.height = frame.height;
+  header.stride = frame.stride;
+  header.fourcc = frame.pixelformat;
+  header.field = frame.field;
+  header.sequence = frame.sequence;
+  header.capture_ns = frame.timestamp_ns;
+  header.image_bytes = frame.bytes;
+
+  // Never waits, the driver's buffer has to go back in time for the next frame
+  if (!publisher_->Publish(header, frame.data) && !drop_reported_) {
+    std::cerr << "Zenoh shared memory is full, frames are being dropped\n";
+    drop_reported_ = true;
+  }
+}
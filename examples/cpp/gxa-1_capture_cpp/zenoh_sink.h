@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief Publishes captured frames on zenoh, through shared memory to subscribers on this host
+///
+/// \file zenoh_sink.h
+///
+
+#ifndef ZENOH_SINK_H
+#define ZENOH_SINK_H
+
+#include <memory>
+#include <string>
+#include <zenoh/zenoh.hpp>
+
+#include "frame_sink.h"
+#include "shm_frame_publisher.h"
+
+///
+/// \brief Publishes every frame, or field when interlaced, as it was captured, YUYV or UYVY
+///
+/// The frame is copied once, from the driver's buffer into a shared memory chunk, and local subscribers such as a
+/// recorder or analytics read the chunk without copying it again. When the pool is full because subscribers are
+/// holding frames, frames are dropped rather than holding up the capture.
+///
+class ZenohSink : public FrameSink {
+ public:
+  ///
+  /// \brief Declare the publisher, throws zenoh::ZException on failure
+  ///
+  /// \param session An open session from VideoSessionConfig(), shared with other sinks and outliving this one
+  /// \param key The key expression, for example video/0/raw
+  /// \param shm_bytes Size of the shared memory pool
+  ///
+  ZenohSink(zenoh::Session &session, const std::string &key, size_t shm_bytes);
+
+  ///
+  /// \brief Publish a frame
+  ///
+  /// \param frame The captured frame
+  ///
+  void Consume(const CapturedFrame &frame) final;
+
+ private:
+  /// \brief Publishes from shared memory
+  std::unique_ptr<ShmFramePublisher> publisher_;
+  /// \brief Dropped frames have been reported
+  bool drop_reported_ = false;
+};
+
+#endif  // ZENOH_SINK_H
@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Receives the transmitted RTP stream and measures when each frame arrives
+///
+/// \file arrival_check.cc
+///
+
+#include "arrival_check.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "frame_pacer.h"
+
+ArrivalCheck::ArrivalCheck(const std::string &address, int port, int64_t interval_ns)
+    : address_(address), port_(port), interval_ns_(interval_ns) {}
+
+ArrivalCheck::~ArrivalCheck() { Stop(); }
+
+bool ArrivalCheck::Start() {
+  struct in_addr group;
+  if (inet_pton(AF_INET, address_.c_str(), &group) != 1) {
+    fprintf(stderr, "Arrival check: %s is not an IPv4 address\n", address_.c_str());
+    return false;
+  }
+
+  socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) {
+    fprintf(stderr, "Arrival check: socket failed: %s\n", strerror(errno));
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  // Wake regularly so Stop() is noticed when nothing arrives
+  struct timeval timeout = {0, 100000};
+  setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(port_);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(socket_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0) {
+    fprintf(stderr, "Arrival check: bind to port %d failed: %s\n", port_, strerror(errno));
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+
+  // Multicast is looped back to the sending host by default, so joining is enough to see it
+  if (IN_MULTICAST(ntohl(group.s_addr))) {
+    struct ip_mreqn membership = {};
+    membership.imr_multiaddr = group;
+    if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+      fprintf(stderr, "Arrival check: join %s failed: %s\n", address_.c_str(), strerror(errno));
+      close(socket_);
+      socket_ = -1;
+      return false;
+    }
+  }
+
+  running_ = true;
+  thread_ = std::thread(&ArrivalCheck::Receive, this);
+  return true;
+}
+
+void ArrivalCheck::Stop() {
+  running_ = false;
+  if (thread_.joinable()) thread_.join();
+  if (socket_ >= 0) close(socket_);
+  socket_ = -1;
+}
+
+void ArrivalCheck::Receive() {
+  uint8_t packet[65536];
+
+  while (running_) {
+    ssize_t size = recv(socket_, packet, sizeof(packet), 0);
+    if (size < 0) continue;
+    int64_t now = MonotonicNs();
+
+    // RTP version 2, the timestamp is the same for every packet of a frame
+    if (size < 12 || (packet[0] >> 6) != 2) continue;
+    packets_++;
+    uint32_t rtp_timestamp = (packet[4] << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+    if (frames_ && rtp_timestamp == rtp_timestamp_) continue;
+
+    if (frames_) {
+      int64_t error = std::abs(now - last_ns_ - interval_ns_);
+      error_sum_ns_ += error;
+      error_max_ns_ = std::max(error_max_ns_, error);
+    } else {
+      first_ns_ = now;
+    }
+    frames_++;
+    rtp_timestamp_ = rtp_timestamp;
+    last_ns_ = now;
+  }
+}
+
+ArrivalStats ArrivalCheck::Stats() const {
+  ArrivalStats stats;
+  stats.packets = packets_;
+  stats.frames = frames_;
+  if (frames_ < 2) return stats;
+
+  stats.fps = (frames_ - 1) * 1e9 / (last_ns_ - first_ns_);
+  stats.spacing_error_us = error_sum_ns_ / 1000.0 / (frames_ - 1);
+  stats.max_spacing_error_us = error_max_ns_ / 1000.0;
+  return stats;
+}
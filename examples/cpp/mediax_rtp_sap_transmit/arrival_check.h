@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Receives the transmitted RTP stream and measures when each frame arrives
+///
+/// \file arrival_check.h
+///
+
+#ifndef MEDIAX_RTP_SAP_TRANSMIT_ARRIVAL_CHECK_H_
+#define MEDIAX_RTP_SAP_TRANSMIT_ARRIVAL_CHECK_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/// \brief Frame arrival statistics
+struct ArrivalStats {
+  /// \brief RTP packets received
+  uint64_t packets = 0;
+  /// \brief Frames received, counted by new RTP timestamps
+  uint64_t frames = 0;
+  /// \brief Frame rate from the first to the last frame to arrive
+  double fps = 0;
+  /// \brief Mean difference between the spacing of consecutive frames and the frame interval, in microseconds
+  double spacing_error_us = 0;
+  /// \brief Largest difference between the spacing of consecutive frames and the frame interval, in microseconds
+  double max_spacing_error_us = 0;
+};
+
+///
+/// \brief Listens on the stream's address and port and times the first packet of every frame
+///
+/// A frame starts with the first packet carrying a new RTP timestamp. Its arrival time, taken on the monotonic clock as
+/// the packet is read, is compared with the previous frame's to check what actually went out on the wire.
+///
+class ArrivalCheck {
+ public:
+  ///
+  /// \brief Construct a new Arrival Check object
+  ///
+  /// \param address The address the stream is sent to, a multicast group is joined
+  /// \param port The UDP port
+  /// \param interval_ns Nanoseconds between frames
+  ///
+  ArrivalCheck(const std::string &address, int port, int64_t interval_ns);
+
+  ///
+  /// \brief Destroy the Arrival Check object
+  ///
+  ///
+  ~ArrivalCheck();
+
+  ///
+  /// \brief Open the socket and start receiving
+  ///
+  /// \return true if the socket is bound
+  ///
+  bool Start();
+
+  ///
+  /// \brief Stop receiving
+  ///
+  ///
+  void Stop();
+
+  ///
+  /// \brief The statistics, call after Stop()
+  ///
+  /// \return ArrivalStats The totals
+  ///
+  ArrivalStats Stats() const;
+
+ private:
+  ///
+  /// \brief Receive until stopped
+  ///
+  ///
+  void Receive();
+
+  /// \brief The address the stream is sent to
+  std::string address_;
+  /// \brief The UDP port
+  int port_;
+  /// \brief Nanoseconds between frames
+  int64_t interval_ns_;
+  /// \brief The UDP socket, -1 when closed
+  int socket_ = -1;
+  /// \brief Cleared to stop the receive thread
+  std::atomic<bool> running_{false};
+  /// \brief The receive thread
+  std::thread thread_;
+  /// \brief RTP packets received
+  uint64_t packets_ = 0;
+  /// \brief Frames received
+  uint64_t frames_ = 0;
+  /// \brief RTP timestamp of the latest frame
+  uint32_t rtp_timestamp_ = 0;
+  /// \brief Arrival of the first frame
+  int64_t first_ns_ = 0;
+  /// \brief Arrival of the latest frame
+  int64_t last_ns_ = 0;
+  /// \brief Sum of the spacing errors
+  int64_t error_sum_ns_ = 0;
+  /// \brief Largest spacing error
+  int64_t error_max_ns_ = 0;
+};
+
+#endif  // MEDIAX_RTP_SAP_TRANSMIT_ARRIVAL_CHECK_H_
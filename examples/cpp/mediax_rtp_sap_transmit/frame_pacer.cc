@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Paces a transmit loop to a frame rate against the monotonic clock
+///
+/// \file frame_pacer.cc
+///
+
+#include "frame_pacer.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <utility>
+
+static constexpr int64_t kNsPerSecond = 1000000000;
+
+int64_t MonotonicNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * kNsPerSecond + now.tv_nsec;
+}
+
+void SleepUntilNs(int64_t deadline_ns) {
+  struct timespec deadline = {static_cast<time_t>(deadline_ns / kNsPerSecond),
+                              static_cast<long>(deadline_ns % kNsPerSecond)};  // NOLINT(runtime/int)
+  // An absolute deadline, restarting after a signal does not extend the sleep
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+  }
+}
+
+// CPU time used by every thread in the process
+static int64_t process_cpu_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return static_cast<int64_t>(now.tv_sec) * kNsPerSecond + now.tv_nsec;
+}
+
+FramePacer::FramePacer(double fps, std::string name, int report_seconds)
+    : name_(std::move(name)),
+      interval_ns_(static_cast<int64_t>(kNsPerSecond / (fps > 0 ? fps : 25))),
+      report_ns_(static_cast<int64_t>(report_seconds) * kNsPerSecond) {}
+
+void FramePacer::WaitFrame() {
+  int64_t now = MonotonicNs();
+
+  if (deadline_ns_ == 0) {
+    // The first frame goes straight away
+    deadline_ns_ = now;
+    total_ = {now, process_cpu_ns(), now};
+    report_ = total_;
+  } else {
+    deadline_ns_ += interval_ns_;
+    // More than a frame behind, skip the deadlines that have passed rather than bursting to catch up
+    if (now - deadline_ns_ > interval_ns_) {
+      uint64_t missed = (now - deadline_ns_) / interval_ns_;
+      deadline_ns_ += missed * interval_ns_;
+      total_.skipped += missed;
+      report_.skipped += missed;
+    }
+    SleepUntilNs(deadline_ns_);
+    now = MonotonicNs();
+  }
+
+  int64_t late = std::max<int64_t>(0, now - deadline_ns_);
+  bool first = total_.frames == 0;
+  for (Period *period : {&total_, &report_}) {
+    period->frames++;
+    period->last_ns = now;
+    if (!first) period->intervals++;
+    period->late_sum_ns += late;
+    period->late_max_ns = std::max(period->late_max_ns, late);
+  }
+
+  if (report_ns_ > 0 && now - report_.start_ns >= report_ns_) {
+    PacerStats stats = Summarise(report_, now);
+    printf("%s: %.2f frames/s, jitter %.0f us (max %.0f us), %llu skipped, CPU %.1f%%\n", name_.c_str(), stats.fps,
+           stats.jitter_us, stats.max_jitter_us, static_cast<unsigned long long>(stats.skipped), stats.cpu_percent);
+    report_ = {now, process_cpu_ns(), now};
+  }
+}
+
+PacerStats FramePacer::Total() const { return Summarise(total_, MonotonicNs()); }
+
+PacerStats FramePacer::Summarise(const Period &period, int64_t now_ns) {
+  PacerStats stats;
+  stats.frames = period.frames;
+  stats.skipped = period.skipped;
+  if (period.frames == 0) return stats;
+
+  // The rate up to the latest frame, the CPU usage up to now
+  int64_t frames_elapsed = period.last_ns - period.start_ns;
+  int64_t elapsed = now_ns - period.start_ns;
+  if (frames_elapsed > 0) stats.fps = period.intervals * static_cast<double>(kNsPerSecond) / frames_elapsed;
+  if (elapsed > 0) stats.cpu_percent = 100.0 * (process_cpu_ns() - period.cpu_start_ns) / elapsed;
+  stats.jitter_us = period.late_sum_ns / 1000.0 / period.frames;
+  stats.max_jitter_us = period.late_max_ns / 1000.0;
+  return stats;
+}
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Paces a transmit loop to a frame rate against the monotonic clock
+///
+/// \file frame_pacer.h
+///
+
+#ifndef MEDIAX_RTP_SAP_TRANSMIT_FRAME_PACER_H_
+#define MEDIAX_RTP_SAP_TRANSMIT_FRAME_PACER_H_
+
+#include <stdint.h>
+
+#include <string>
+
+/// \brief Pacing statistics over a period
+struct PacerStats {
+  /// \brief Frames sent in the period
+  uint64_t frames = 0;
+  /// \brief Frame deadlines skipped because the sender fell more than a frame behind
+  uint64_t skipped = 0;
+  /// \brief Achieved frame rate
+  double fps = 0;
+  /// \brief Mean time a frame started after its deadline, in microseconds
+  double jitter_us = 0;
+  /// \brief Longest time a frame started after its deadline, in microseconds
+  double max_jitter_us = 0;
+  /// \brief Process CPU time as a percentage of one core
+  double cpu_percent = 0;
+};
+
+///
+/// \brief Sleeps until each frame is due, so frames leave at the frame rate rather than as fast as they can be sent
+///
+/// Deadlines are absolute, start + n * interval, so sleep overshoot does not accumulate into drift.
+///
+class FramePacer {
+ public:
+  ///
+  /// \brief Construct a new Frame Pacer object
+  ///
+  /// \param fps The frame rate
+  /// \param name Name used when logging
+  /// \param report_seconds Log the statistics this often, 0 to never log
+  ///
+  FramePacer(double fps, std::string name, int report_seconds = 5);
+
+  ///
+  /// \brief Sleep until the next frame is due
+  ///
+  /// If the sender has fallen more than a whole frame behind, the missed deadlines are skipped rather than sent in a
+  /// burst to catch up.
+  ///
+  void WaitFrame();
+
+  ///
+  /// \brief The frame interval
+  ///
+  /// \return int64_t Nanoseconds between frames
+  ///
+  int64_t IntervalNs() const { return interval_ns_; }
+
+  ///
+  /// \brief Statistics since the first frame
+  ///
+  /// \return PacerStats The totals
+  ///
+  PacerStats Total() const;
+
+ private:
+  /// \brief Running totals for a period
+  struct Period {
+    /// \brief Monotonic time the period started
+    int64_t start_ns = 0;
+    /// \brief Process CPU time when the period started
+    int64_t cpu_start_ns = 0;
+    /// \brief Monotonic time of the latest frame
+    int64_t last_ns = 0;
+    /// \brief Frames in the period
+    uint64_t frames = 0;
+    /// \brief Frame intervals that ended in the period, one less than the frames in the first period
+    uint64_t intervals = 0;
+    /// \brief Skipped deadlines in the period
+    uint64_t skipped = 0;
+    /// \brief Sum of the frame start lateness
+    int64_t late_sum_ns = 0;
+    /// \brief Worst frame start lateness
+    int64_t late_max_ns = 0;
+  };
+
+  ///
+  /// \brief Convert a period to statistics
+  ///
+  /// \param period The period
+  /// \param now_ns The end of the period
+  /// \return PacerStats The statistics
+  ///
+  static PacerStats Summarise(const Period &period, int64_t now_ns);
+
+  /// \brief Name used when logging
+  std::string name_;
+  /// \brief Nanoseconds between frames
+  int64_t interval_ns_;
+  /// \brief Nanoseconds between reports, 0 for none
+  int64_t report_ns_;
+  /// \brief Deadline of the current frame, 0 before the first
+  int64_t deadline_ns_ = 0;
+  /// \brief Totals since the first frame
+  Period total_;
+  /// \brief Totals since the last report
+  Period report_;
+};
+
+///
+/// \brief The monotonic clock
+///
+/// \return int64_t Nanoseconds
+///
+int64_t MonotonicNs();
+
+///
+/// \brief Sleep until an absolute time on the monotonic clock
+///
+/// \param deadline_ns The time to wake, in nanoseconds
+///
+void SleepUntilNs(int64_t deadline_ns);
+
+#endif  // MEDIAX_RTP_SAP_TRANSMIT_FRAME_PACER_H_
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Sends several streams, each at its own frame rate, encoding on a shared bounded worker pool
+///
+/// \file multi_stream_transmit.cc
+///
+
+#include "multi_stream_transmit.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "frame_pacer.h"
+
+static constexpr int64_t kNsPerSecond = 1000000000;
+
+std::vector<StreamSpec> ParseStreamSpecs(const std::string &list) {
+  std::vector<StreamSpec> specs;
+  std::stringstream items(list);
+  std::string item;
+
+  while (std::getline(items, item, ',')) {
+    if (item.empty()) continue;
+
+    // name=address:port/WIDTHxHEIGHT@FPS
+    StreamSpec spec;
+    char name[64] = {}, address[64] = {};
+    if (sscanf(item.c_str(), "%63[^=]=%63[^:]:%d/%dx%d@%d", name, address, &spec.port, &spec.width, &spec.height,
+               &spec.fps) != 6) {
+      throw std::runtime_error("Invalid stream '" + item + "', expected name=address:port/WIDTHxHEIGHT@FPS");
+    }
+    spec.name = name;
+    spec.address = address;
+    if (spec.port <= 0 || spec.port > 65535 || spec.width <= 0 || spec.height <= 0 || spec.fps <= 0) {
+      throw std::runtime_error("Invalid port, size or frame rate in stream '" + item + "'");
+    }
+    specs.push_back(spec);
+  }
+  return specs;
+}
+
+MultiStreamTransmitter::MultiStreamTransmitter(int workers) {
+  if (workers <= 0) workers = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 0; i < workers; i++) workers_.emplace_back(&MultiStreamTransmitter::Work, this);
+}
+
+MultiStreamTransmitter::~MultiStreamTransmitter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  ready_.notify_all();
+  for (auto &worker : workers_) worker.join();
+}
+
+void MultiStreamTransmitter::Add(const StreamSpec &spec, std::unique_ptr<FrameSource> source, Send send) {
+  auto stream = std::make_unique<Stream>();
+  stream->spec = spec;
+  stream->source = std::move(source);
+  stream->send = std::move(send);
+  stream->interval_ns = kNsPerSecond / spec.fps;
+  streams_.push_back(std::move(stream));
+}
+
+void MultiStreamTransmitter::Run(int seconds, int report_seconds) {
+  if (streams_.empty()) return;
+
+  int64_t now = MonotonicNs();
+  int64_t stop = seconds > 0 ? now + seconds * kNsPerSecond : 0;
+  int64_t report_interval = static_cast<int64_t>(report_seconds) * kNsPerSecond;
+  int64_t last_report = now;
+  std::vector<StreamStats> reported(streams_.size());
+  for (auto &stream : streams_) stream->deadline_ns = now;
+
+  while (running_) {
+    // Sleep until the next frame of any stream is due, or it is time to report or stop
+    int64_t wake = (*std::min_element(streams_.begin(), streams_.end(), [](const auto &a, const auto &b) {
+                     return a->deadline_ns < b->deadline_ns;
+                   }))->deadline_ns;
+    if (report_interval > 0) wake = std::min(wake, last_report + report_interval);
+    if (stop) wake = std::min(wake, stop);
+    SleepUntilNs(wake);
+    now = MonotonicNs();
+
+    if (stop && now >= stop) break;
+    if (report_interval > 0 && now - last_report >= report_interval) {
+      Report(&reported, now - last_report);
+      last_report = now;
+    }
+
+    for (auto &stream : streams_) {
+      if (stream->deadline_ns > now) continue;
+
+      // A stream whose last frame is still with a worker drops this one, it does not queue behind it
+      if (stream->busy.exchange(true)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stream->stats.dropped++;
+      } else {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          jobs_.push_back({stream.get(), stream->deadline_ns});
+        }
+        ready_.notify_one();
+      }
+
+      // Skip any deadlines that passed while we were behind, rather than bursting to catch up
+      stream->deadline_ns += stream->interval_ns;
+      if (now - stream->deadline_ns > stream->interval_ns) {
+        int64_t missed = (now - stream->deadline_ns) / stream->interval_ns;
+        stream->deadline_ns += missed * stream->interval_ns;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stream->stats.dropped += missed;
+      }
+    }
+  }
+  running_ = false;
+
+  // Let the frames already handed out finish
+  for (auto &stream : streams_) {
+    while (stream->busy) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void MultiStreamTransmitter::Work() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this]() { return shutdown_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+      job = jobs_.front();
+      jobs_.pop_front();
+    }
+
+    Stream *stream = job.stream;
+    int64_t start = MonotonicNs();
+    stream->send(stream->source->Frame());
+    int64_t end = MonotonicNs();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      int64_t late = std::max<int64_t>(0, start - job.deadline_ns);
+      stream->stats.frames++;
+      stream->stats.late_sum_ns += late;
+      stream->stats.late_max_ns = std::max(stream->stats.late_max_ns, late);
+      stream->stats.busy_ns += end - start;
+    }
+    stream->busy = false;
+  }
+}
+
+std::vector<StreamStats> MultiStreamTransmitter::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<StreamStats> stats;
+  for (const auto &stream : streams_) stats.push_back(stream->stats);
+  return stats;
+}
+
+void MultiStreamTransmitter::Report(std::vector<StreamStats> *previous, int64_t elapsed_ns) {
+  std::vector<StreamStats> current = Stats();
+  double seconds = static_cast<double>(elapsed_ns) / kNsPerSecond;
+  double total_fps = 0, total_pixels = 0, busy = 0;
+
+  for (size_t i = 0; i < current.size(); i++) {
+    const StreamSpec &spec = streams_[i]->spec;
+    uint64_t frames = current[i].frames - (*previous)[i].frames;
+    uint64_t dropped = current[i].dropped - (*previous)[i].dropped;
+    int64_t late = current[i].late_sum_ns - (*previous)[i].late_sum_ns;
+    double fps = frames / seconds;
+    printf("%s: %.2f/%d frames/s, %llu dropped, waited %.0f us for a worker (max %.0f us since start)\n",
+           spec.name.c_str(), fps, spec.fps, static_cast<unsigned long long>(dropped),
+           frames ? late / 1000.0 / frames : 0.0, current[i].late_max_ns / 1000.0);
+    total_fps += fps;
+    total_pixels += fps * spec.width * spec.height;
+    busy += current[i].busy_ns - (*previous)[i].busy_ns;
+  }
+  printf("All streams: %.1f frames/s, %.1f Mpixel/s, workers %.0f%% busy\n", total_fps, total_pixels / 1e6,
+         100.0 * busy / (elapsed_ns * static_cast<double>(workers_.size())));
+  *previous = std::move(current);
+}
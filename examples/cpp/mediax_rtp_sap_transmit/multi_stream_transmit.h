@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Sends several streams, each at its own frame rate, encoding on a shared bounded worker pool
+///
+/// \file multi_stream_transmit.h
+///
+
+#ifndef MEDIAX_RTP_SAP_TRANSMIT_MULTI_STREAM_TRANSMIT_H_
+#define MEDIAX_RTP_SAP_TRANSMIT_MULTI_STREAM_TRANSMIT_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// \brief One RTP/SAP session
+struct StreamSpec {
+  /// \brief SAP session name
+  std::string name;
+  /// \brief Multicast group or unicast address
+  std::string address;
+  /// \brief UDP port
+  int port = 5004;
+  /// \brief Frame width
+  int width = 640;
+  /// \brief Frame height
+  int height = 480;
+  /// \brief Frame rate
+  int fps = 25;
+};
+
+///
+/// \brief Parse a comma separated list of name=address:port/WIDTHxHEIGHT@FPS streams
+///
+/// \param list For example "sight=238.192.1.1:5004/640x480@25,driver=238.192.1.2:5004/720x576@30", throws
+/// std::runtime_error if malformed
+/// \return std::vector<StreamSpec> One entry per stream
+///
+std::vector<StreamSpec> ParseStreamSpecs(const std::string &list);
+
+///
+/// \brief Where a stream's frames come from, for example a capture channel or a test pattern
+///
+class FrameSource {
+ public:
+  ///
+  /// \brief Destroy the Frame Source object
+  ///
+  ///
+  virtual ~FrameSource() = default;
+
+  ///
+  /// \brief The latest frame, called from a worker thread
+  ///
+  /// \return const uint8_t* The frame in the transmitter's input format, valid until the next call
+  ///
+  virtual const uint8_t *Frame() = 0;
+};
+
+/// \brief Per stream transmit statistics
+struct StreamStats {
+  /// \brief Frames sent
+  uint64_t frames = 0;
+  /// \brief Frames dropped because the stream's previous frame was still being encoded
+  uint64_t dropped = 0;
+  /// \brief Sum of the time frames waited for a worker after they were due
+  int64_t late_sum_ns = 0;
+  /// \brief Longest time a frame waited for a worker
+  int64_t late_max_ns = 0;
+  /// \brief Sum of the encode and send time
+  int64_t busy_ns = 0;
+};
+
+///
+/// \brief Schedules every stream against the monotonic clock and hands due frames to a bounded worker pool
+///
+/// A stream has at most one frame being encoded. If its next frame is due while the previous one is still with a
+/// worker, the frame is dropped rather than queued, so a slow encoder costs frame rate rather than latency and the
+/// other streams keep their rate.
+///
+class MultiStreamTransmitter {
+ public:
+  /// \brief Encodes and sends one frame of a stream
+  using Send = std::function<void(const uint8_t *frame)>;
+
+  ///
+  /// \brief Construct a new Multi Stream Transmitter object
+  ///
+  /// \param workers Encode threads, 0 for one per core
+  ///
+  explicit MultiStreamTransmitter(int workers = 0);
+
+  ///
+  /// \brief Destroy the Multi Stream Transmitter object, stops the workers
+  ///
+  ///
+  ~MultiStreamTransmitter();
+
+  ///
+  /// \brief Add a stream, before Run()
+  ///
+  /// \param spec The stream
+  /// \param source Where its frames come from
+  /// \param send Encodes and sends a frame
+  ///
+  void Add(const StreamSpec &spec, std::unique_ptr<FrameSource> source, Send send);
+
+  ///
+  /// \brief Send the streams until stopped, returns straight away if Stop() has already been called
+  ///
+  /// \param seconds Stop after this long, 0 to run until Stop()
+  /// \param report_seconds Log the statistics this often, 0 to never log
+  ///
+  void Run(int seconds = 0, int report_seconds = 5);
+
+  ///
+  /// \brief Stop Run(), from any thread or a signal handler, including before Run() has been entered
+  ///
+  ///
+  void Stop() { running_ = false; }
+
+  ///
+  /// \brief Statistics for each stream, in the order added
+  ///
+  /// \return std::vector<StreamStats> A copy of the statistics
+  ///
+  std::vector<StreamStats> Stats();
+
+  ///
+  /// \brief The number of worker threads
+  ///
+  /// \return int The workers
+  ///
+  int Workers() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  /// \brief A stream and its schedule
+  struct Stream {
+    /// \brief The stream
+    StreamSpec spec;
+    /// \brief Where its frames come from
+    std::unique_ptr<FrameSource> source;
+    /// \brief Encodes and sends a frame
+    Send send;
+    /// \brief Nanoseconds between frames
+    int64_t interval_ns = 0;
+    /// \brief When the next frame is due
+    int64_t deadline_ns = 0;
+    /// \brief A frame is with a worker
+    std::atomic<bool> busy{false};
+    /// \brief Statistics, guarded by the transmitter's mutex
+    StreamStats stats;
+  };
+
+  /// \brief A due frame waiting for a worker
+  struct Job {
+    /// \brief The stream
+    Stream *stream;
+    /// \brief When the frame was due
+    int64_t deadline_ns;
+  };
+
+  ///
+  /// \brief Worker thread, encodes and sends due frames
+  ///
+  ///
+  void Work();
+
+  ///
+  /// \brief Log the statistics since the last report
+  ///
+  /// \param previous The statistics at the last report, updated
+  /// \param elapsed_ns Time since the last report
+  ///
+  void Report(std::vector<StreamStats> *previous, int64_t elapsed_ns);
+
+  /// \brief The streams
+  std::vector<std::unique_ptr<Stream>> streams_;
+  /// \brief Encode threads
+  std::vector<std::thread> workers_;
+  /// \brief Due frames, never more than one per stream
+  std::deque<Job> jobs_;
+  /// \brief Protects jobs_ and the statistics
+  std::mutex mutex_;
+  /// \brief Signals a job or shutdown to the workers
+  std::condition_variable ready_;
+  /// \brief The workers are to exit
+  bool shutdown_ = false;
+  /// \brief Run() keeps scheduling while set, set from construction so a Stop() before Run() is not lost
+  std::atomic<bool> running_{true};
+};
+
+#endif  // MEDIAX_RTP_SAP_TRANSMIT_MULTI_STREAM_TRANSMIT_H_
@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Sends several RTP/SAP sessions from one process, encoding on a shared worker pool
+///
+/// \file rtp_multi_transmit.cc
+///
+
+#include <gflags/gflags.h>
+#include <signal.h>
+#include <stdio.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "frame_pacer.h"
+#include "multi_stream_transmit.h"
+#include "rtp/rtp.h"
+
+// Streams
+DEFINE_string(streams, "sight=238.192.1.1:5004/640x480@25,driver=238.192.1.2:5004/640x480@25",
+              "Comma separated name=address:port/WIDTHxHEIGHT@FPS sessions");
+// Worker pool
+DEFINE_int32(workers, 0, "Encode threads shared by all the streams, 0 for one per core");
+// Reporting
+DEFINE_int32(report, 5, "Seconds between statistics reports, 0 for none");
+DEFINE_int32(benchmark_seconds, 0, "Send for this many seconds then print the aggregate throughput");
+
+/// \brief The H.264 transmitter used for every stream
+using Transmitter = mediax::RtpSapTransmit<mediax::rtp::h264::gst::open::RtpH264GstOpenPayloader>;
+
+/// \brief The transmitter a signal stops
+static MultiStreamTransmitter *transmitter_to_stop = nullptr;
+
+/// \brief Stop sending on Ctrl-C so the throughput summary is still printed
+static void stop_handler(int) {
+  if (transmitter_to_stop) transmitter_to_stop->Stop();
+}
+
+/// \brief A bouncing ball test pattern, stands in for a capture channel
+class TestPatternSource : public FrameSource {
+ public:
+  ///
+  /// \brief Construct a new Test Pattern Source object
+  ///
+  /// \param transmitter The transmitter that renders the pattern at its size
+  ///
+  explicit TestPatternSource(Transmitter *transmitter) : frame_(transmitter->GetBufferTestPattern(10)) {}
+
+  ///
+  /// \brief The latest frame
+  ///
+  /// \return const uint8_t* The test pattern
+  ///
+  const uint8_t *Frame() final { return frame_.data(); }
+
+ private:
+  /// \brief The test pattern
+  std::vector<uint8_t> &frame_;
+};
+
+/// \brief Main function
+int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<StreamSpec> specs;
+  try {
+    specs = ParseStreamSpecs(FLAGS_streams);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // One SAP session per stream, all sharing the encode workers
+  MultiStreamTransmitter transmitter(FLAGS_workers);
+  std::vector<std::unique_ptr<Transmitter>> sessions;
+  for (const auto &spec : specs) {
+    sessions.push_back(
+        std::make_unique<Transmitter>(spec.address, spec.port, spec.name, spec.width, spec.height, spec.fps, "H264"));
+    Transmitter *session = sessions.back().get();
+    transmitter.Add(spec, std::make_unique<TestPatternSource>(session),
+                    [session](const uint8_t *frame) { session->Transmit(const_cast<uint8_t *>(frame), false); });
+    std::cout << "Sending " << spec.name << " to " << spec.address << ":" << spec.port << ", " << spec.width << "x"
+              << spec.height << " at " << spec.fps << " frames/s\n";
+  }
+  std::cout << transmitter.Workers() << " encode workers\n";
+  transmitter_to_stop = &transmitter;
+  signal(SIGINT, stop_handler);
+  signal(SIGTERM, stop_handler);
+
+  int64_t start = MonotonicNs();
+  transmitter.Run(FLAGS_benchmark_seconds, FLAGS_report);
+  double seconds = (MonotonicNs() - start) / 1e9;
+
+  // Aggregate throughput over the whole run
+  double frames = 0, pixels = 0, wanted = 0, dropped = 0;
+  std::vector<StreamStats> stats = transmitter.Stats();
+  for (size_t i = 0; i < specs.size(); i++) {
+    frames += stats[i].frames;
+    dropped += stats[i].dropped;
+    pixels += static_cast<double>(stats[i].frames) * specs[i].width * specs[i].height;
+    wanted += specs[i].fps * seconds;
+  }
+  printf("%zu streams, %.1f s: %.1f/%.1f frames/s, %.1f Mpixel/s, %.0f dropped\n", specs.size(), seconds,
+         frames / seconds, wanted / seconds, pixels / seconds / 1e6, dropped);
+  return EXIT_SUCCESS;
+}
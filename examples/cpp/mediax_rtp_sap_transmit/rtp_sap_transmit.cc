@@ -6,17 +6,71 @@
 // Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
 // License. See the LICENSE file in the project root for full license details.
 //
-/// \brief A SAP/SDP listener example
+/// \brief An RTP H.264 transmit example announced over SAP/SDP, paced to the frame rate
 ///
 /// \file rtp_sap_transmit.cc
 ///
 
+#include <gflags/gflags.h>
+#include <stdio.h>
+
+#include <cmath>
+
+#include "arrival_check.h"
+#include "frame_pacer.h"
 #include "rtp/rtp.h"
 
+// Session
+DEFINE_string(address, "238.192.1.1", "Multicast group or unicast address to send to, 127.0.0.1 for loopback");
+DEFINE_int32(port, 5004, "UDP port");
+DEFINE_string(session_name, "test-session-name", "SAP session name");
+DEFINE_int32(width, 640, "Frame width");
+DEFINE_int32(height, 480, "Frame height");
+DEFINE_int32(fps, 25, "Frame rate, announced in the SDP and paced on the wire");
+// Pacing
+DEFINE_int32(report, 5, "Seconds between pacing reports, 0 for none");
+DEFINE_int32(check_seconds, 0, "Send for this many seconds while receiving the stream, exit status 1 if it is off");
+
 /// \brief Main function
 int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
   mediax::RtpSapTransmit<mediax::rtp::h264::gst::open::RtpH264GstOpenPayloader> rtp(
-      "238.192.1.1", 5004, "test-session-name", 640, 480, 25, "H264");
+      FLAGS_address, FLAGS_port, FLAGS_session_name, FLAGS_width, FLAGS_height, FLAGS_fps, "H264");
   std::vector<uint8_t> &data = rtp.GetBufferTestPattern(10);  // Bouncing ball
-  while (true) rtp.Transmit(data.data(), false);
+
+  // One frame per interval at the advertised rate, the payloader packetises and sends each frame as it is handed over
+  FramePacer pacer(FLAGS_fps, FLAGS_session_name, FLAGS_report);
+  if (FLAGS_check_seconds <= 0) {
+    while (true) {
+      pacer.WaitFrame();
+      rtp.Transmit(data.data(), false);
+    }
+  }
+
+  // The stream is received as well, so the check sees what went out on the wire rather than when the loop woke
+  ArrivalCheck check(FLAGS_address, FLAGS_port, pacer.IntervalNs());
+  if (!check.Start()) return EXIT_FAILURE;
+  for (int64_t stop = MonotonicNs() + FLAGS_check_seconds * 1000000000LL; MonotonicNs() < stop;) {
+    pacer.WaitFrame();
+    rtp.Transmit(data.data(), false);
+  }
+  // Let the last frame arrive
+  SleepUntilNs(MonotonicNs() + pacer.IntervalNs());
+  check.Stop();
+
+  // Every frame received, within 1% of the frame rate, no frame more than half an interval off its spacing and none
+  // skipped by the sender
+  PacerStats sent = pacer.Total();
+  ArrivalStats received = check.Stats();
+  double half_interval_us = pacer.IntervalNs() / 2000.0;
+  bool ok = received.frames == sent.frames && std::fabs(received.fps - FLAGS_fps) <= FLAGS_fps * 0.01 &&
+            received.max_spacing_error_us < half_interval_us && sent.skipped == 0;
+  printf("Arrival %s: %llu/%llu frames in %llu packets, %.2f/%d frames/s, spacing error %.0f us (max %.0f us, limit "
+         "%.0f us), %llu skipped, CPU %.1f%%\n",
+         ok ? "ok" : "FAILED", static_cast<unsigned long long>(received.frames),
+         static_cast<unsigned long long>(sent.frames), static_cast<unsigned long long>(received.packets), received.fps,
+         FLAGS_fps, received.spacing_error_us, received.max_spacing_error_us, half_interval_us,
+         static_cast<unsigned long long>(sent.skipped), sent.cpu_percent);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,248 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief A ring of video frames in POSIX shared memory, one writer and any number of independent readers
+///
+/// \file shm_ring.cc
+///
+
+#include "shm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <new>
+#include <stdexcept>
+
+// Slots start on a page so large images map cleanly
+static constexpr size_t kPage = 4096;
+
+static size_t round_up(size_t bytes, size_t to) { return (bytes + to - 1) / to * to; }
+
+// Not FUTEX_PRIVATE_FLAG, the waiters are in other processes
+static long futex(std::atomic<uint32_t> *word, int op, uint32_t value, const struct timespec *timeout) {
+  return syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), op, value, timeout, nullptr, 0);
+}
+
+static int64_t monotonic_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+ShmRingWriter::ShmRingWriter(const std::string &name, int slots, size_t capacity) : name_(name) {
+  if (slots < 2) throw std::runtime_error("A shared memory ring needs at least two slots");
+  size_t slots_offset = round_up(sizeof(ShmRingHeader), kPage);
+  size_t slot_bytes = round_up(sizeof(ShmRingSlot) + capacity, kPage);
+  map_bytes_ = slots_offset + slot_bytes * slots;
+
+  // Always a new object, readers of an old ring see it replaced and open this one
+  shm_unlink(name_.c_str());
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) throw std::runtime_error("Shared memory " + name_ + ": " + strerror(errno));
+  if (ftruncate(fd, map_bytes_) < 0) {
+    std::string error = strerror(errno);
+    close(fd);
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Shared memory " + name_ + " size: " + error);
+  }
+  void *map = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Shared memory " + name_ + " map: " + strerror(errno));
+  }
+  map_ = static_cast<uint8_t *>(map);
+
+  // The object is zero filled, so every slot starts with seq 0, which is no frame
+  header_ = new (map_) ShmRingHeader();
+  header_->version = SHM_RING_VERSION;
+  header_->slots = slots;
+  header_->slots_offset = slots_offset;
+  header_->slot_bytes = slot_bytes;
+  header_->capacity = capacity;
+  // Readers check the magic, so it goes last
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = SHM_RING_MAGIC;
+}
+
+ShmRingWriter::~ShmRingWriter() {
+  header_->closed.store(1, std::memory_order_release);
+  header_->futex.fetch_add(1);
+  futex(&header_->futex, FUTEX_WAKE, INT_MAX, nullptr);
+  munmap(map_, map_bytes_);
+  shm_unlink(name_.c_str());
+}
+
+uint8_t *ShmRingWriter::Begin() {
+  uint64_t frame = header_->written.load(std::memory_order_relaxed);
+  open_ = reinterpret_cast<ShmRingSlot *>(map_ + header_->slots_offset + frame % header_->slots * header_->slot_bytes);
+  // Odd, readers leave the slot alone, and the fence keeps the image writes after it
+  open_->seq.store(2 * frame + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return reinterpret_cast<uint8_t *>(open_) + sizeof(ShmRingSlot);
+}
+
+void ShmRingWriter::Commit(const ShmRingFrame &frame) {
+  if (!open_) return;
+  open_->width = frame.width;
+  open_->height = frame.height;
+  open_->stride = frame.stride;
+  open_->fourcc = frame.fourcc;
+  open_->field = frame.field;
+  open_->sequence = frame.sequence;
+  open_->timestamp_ns = frame.timestamp_ns;
+  open_->bytes = frame.bytes < header_->capacity ? frame.bytes : header_->capacity;
+
+  uint64_t number = header_->written.load(std::memory_order_relaxed);
+  open_->seq.store(2 * number + 2, std::memory_order_release);
+  header_->written.store(number + 1, std::memory_order_release);
+  open_ = nullptr;
+
+  // Sequentially consistent with the readers' waiters increment, so either they see the new futex value or the
+  // writer sees them waiting. Nobody waiting, which is usual for readers keeping up, costs no system call.
+  header_->futex.fetch_add(1);
+  if (header_->waiters.load()) futex(&header_->futex, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+bool ShmRingWriter::Write(const ShmRingFrame &frame) {
+  if (frame.bytes > header_->capacity) return false;
+  uint8_t *out = Begin();
+  memcpy(out, frame.data, frame.bytes);
+  Commit(frame);
+  return true;
+}
+
+ShmRingReader::ShmRingReader(const std::string &name) : name_(name) {
+  int fd = shm_open(name_.c_str(), O_RDWR, 0);
+  if (fd < 0) throw std::runtime_error("Shared memory " + name_ + ": " + strerror(errno));
+  struct stat status;
+  if (fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) < sizeof(ShmRingHeader)) {
+    close(fd);
+    throw std::runtime_error("Shared memory " + name_ + " is not a frame ring");
+  }
+  inode_ = status.st_ino;
+  map_bytes_ = status.st_size;
+  // Read and write, the futex and waiters count live in the header
+  void *map = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) throw std::runtime_error("Shared memory " + name_ + " map: " + strerror(errno));
+  map_ = static_cast<uint8_t *>(map);
+  header_ = reinterpret_cast<ShmRingHeader *>(map_);
+
+  uint32_t magic = header_->magic;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (magic != SHM_RING_MAGIC || header_->version != SHM_RING_VERSION ||
+      header_->slots_offset + header_->slot_bytes * header_->slots > map_bytes_) {
+    munmap(map_, map_bytes_);
+    throw std::runtime_error("Shared memory " + name_ + " is not a frame ring of version " +
+                             std::to_string(SHM_RING_VERSION));
+  }
+  // From the next frame written, what is already there may be half overwritten
+  cursor_ = header_->written.load(std::memory_order_acquire);
+}
+
+ShmRingReader::~ShmRingReader() { munmap(map_, map_bytes_); }
+
+ShmRingSlot *ShmRingReader::Slot(uint64_t frame) const {
+  return reinterpret_cast<ShmRingSlot *>(map_ + header_->slots_offset + frame % header_->slots * header_->slot_bytes);
+}
+
+bool ShmRingReader::Replaced() const {
+  int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) return true;
+  struct stat status;
+  bool replaced = fstat(fd, &status) < 0 || status.st_ino != inode_;
+  close(fd);
+  return replaced;
+}
+
+int ShmRingReader::Next(ShmRingFrame *frame, int timeout_ms) {
+  int64_t deadline = timeout_ms >= 0 ? monotonic_ns() + timeout_ms * 1000000LL : 0;
+  for (;;) {
+    if (header_->closed.load(std::memory_order_acquire)) return -1;
+    // Read before written, so a frame committed after this wakes the wait below
+    uint32_t seen = header_->futex.load(std::memory_order_acquire);
+    uint64_t written = header_->written.load(std::memory_order_acquire);
+
+    if (cursor_ < written) {
+      // A whole ring behind, the slot is being rewritten, so start again from the newest frame
+      if (written - cursor_ >= header_->slots) {
+        lost_ += written - 1 - cursor_;
+        cursor_ = written - 1;
+      }
+      ShmRingSlot *slot = Slot(cursor_);
+      uint64_t seq = slot->seq.load(std::memory_order_acquire);
+      if (seq == 2 * cursor_ + 2) {
+        frame->frame = cursor_;
+        frame->width = slot->width;
+        frame->height = slot->height;
+        frame->stride = slot->stride;
+        frame->fourcc = slot->fourcc;
+        frame->field = slot->field;
+        frame->sequence = slot->sequence;
+        frame->timestamp_ns = slot->timestamp_ns;
+        frame->bytes = slot->bytes;
+        frame->data = reinterpret_cast<const uint8_t *>(slot) + sizeof(ShmRingSlot);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) == seq) {
+          cursor_++;
+          return 1;
+        }
+      }
+      // Overwritten before it could be read
+      lost_++;
+      cursor_++;
+      continue;
+    }
+
+    struct timespec wait;
+    if (timeout_ms >= 0) {
+      int64_t left = deadline - monotonic_ns();
+      if (left <= 0) return Replaced() ? -1 : 0;
+      wait = {static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+    }
+    header_->waiters.fetch_add(1);
+    futex(&header_->futex, FUTEX_WAIT, seen, timeout_ms >= 0 ? &wait : nullptr);
+    header_->waiters.fetch_sub(1);
+  }
+}
+
+bool ShmRingReader::Valid(const ShmRingFrame &frame) const {
+  // After the caller's reads of the image
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return Slot(frame.frame)->seq.load(std::memory_order_relaxed) == 2 * frame.frame + 2;
+}
+
+void *shm_ring_reader_open(const char *name) {
+  try {
+    return new ShmRingReader(name);
+  } catch (const std::exception &) {
+    return nullptr;
+  }
+}
+
+void shm_ring_reader_close(void *reader) { delete static_cast<ShmRingReader *>(reader); }
+
+int shm_ring_reader_next(void *reader, ShmRingFrame *frame, int timeout_ms) {
+  return static_cast<ShmRingReader *>(reader)->Next(frame, timeout_ms);
+}
+
+int shm_ring_reader_valid(void *reader, const ShmRingFrame *frame) {
+  return static_cast<ShmRingReader *>(reader)->Valid(*frame) ? 1 : 0;
+}
+
+uint64_t shm_ring_reader_lost(void *reader) { return static_cast<ShmRingReader *>(reader)->Lost(); }
@@ -0,0 +1,312 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the GXA-1 product developed by Astute Systems.
+//
+// Licensed under the MIT License. See the LICENSE file in the project root for full license
+// details.
+//
+/// \brief A ring of video frames in POSIX shared memory, one writer and any number of independent readers
+///
+/// \file shm_ring.h
+///
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+#include <sys/types.h>
+
+#include <atomic>
+#include <string>
+#endif
+
+/// \brief First four bytes of a ring, "RING" in memory
+#define SHM_RING_MAGIC 0x474e4952u
+/// \brief Version of the layout
+#define SHM_RING_VERSION 1u
+
+///
+/// \brief One frame, as written and as read
+///
+/// The same layout is used by the C functions for other languages, see python_shm/shm_ring.py.
+///
+typedef struct ShmRingFrame {
+  /// \brief Frame number in the ring, counted from 0 when the writer started, set by the ring
+  uint64_t frame;
+  /// \brief Width in pixels
+  uint32_t width;
+  /// \brief Height in lines, half the frame height for a field
+  uint32_t height;
+  /// \brief Bytes per line
+  uint32_t stride;
+  /// \brief The V4L2 fourcc, for example V4L2_PIX_FMT_YUYV
+  uint32_t fourcc;
+  /// \brief V4L2_FIELD_TOP, V4L2_FIELD_BOTTOM, or V4L2_FIELD_ANY for a whole frame
+  int32_t field;
+  /// \brief The driver's sequence number
+  uint32_t sequence;
+  /// \brief When the frame was captured, CLOCK_MONOTONIC nanoseconds
+  int64_t timestamp_ns;
+  /// \brief Bytes of image
+  uint64_t bytes;
+  /// \brief The image, in the shared memory when read, set by the ring
+  const uint8_t *data;
+} ShmRingFrame;
+
+#ifdef __cplusplus
+
+///
+/// \brief The start of the shared memory
+///
+///
+struct ShmRingHeader {
+  /// \brief SHM_RING_MAGIC
+  uint32_t magic;
+  /// \brief SHM_RING_VERSION
+  uint32_t version;
+  /// \brief Frames held
+  uint32_t slots;
+  /// \brief Zero
+  uint32_t reserved;
+  /// \brief Offset of the first slot
+  uint64_t slots_offset;
+  /// \brief Bytes from one slot to the next
+  uint64_t slot_bytes;
+  /// \brief Most bytes of image a slot holds
+  uint64_t capacity;
+  /// \brief Frames committed, the next frame number, on its own cache line as every reader polls it
+  alignas(64) std::atomic<uint64_t> written;
+  /// \brief Incremented for every frame and on close, readers sleep on it with FUTEX_WAIT
+  std::atomic<uint32_t> futex;
+  /// \brief Readers asleep, the writer only makes the wake system call when there are some
+  std::atomic<uint32_t> waiters;
+  /// \brief The writer has gone, readers should reopen the ring
+  std::atomic<uint32_t> closed;
+};
+
+///
+/// \brief A slot, the frame's description and then, 64 bytes in, the image
+///
+/// seq is the seqlock. It is 2 * frame + 1 while the writer fills the slot and 2 * frame + 2 once the frame is
+/// complete, so a reader knows both that the slot is stable and which frame it holds.
+///
+struct alignas(64) ShmRingSlot {
+  /// \brief The seqlock
+  std::atomic<uint64_t> seq;
+  /// \brief Width in pixels
+  uint32_t width;
+  /// \brief Height in lines
+  uint32_t height;
+  /// \brief Bytes per line
+  uint32_t stride;
+  /// \brief The V4L2 fourcc
+  uint32_t fourcc;
+  /// \brief The V4L2 field
+  int32_t field;
+  /// \brief The driver's sequence number
+  uint32_t sequence;
+  /// \brief CLOCK_MONOTONIC nanoseconds
+  int64_t timestamp_ns;
+  /// \brief Bytes of image
+  uint64_t bytes;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs lock free 64 bit atomics");
+static_assert(sizeof(ShmRingSlot) == 64, "ShmRingSlot is part of the shared memory layout");
+
+///
+/// \brief Creates the ring and writes frames into it, never waiting for readers
+///
+/// A writer that is faster than a reader overwrites frames the reader has not got to, and the reader counts them as
+/// lost. A reader can hold on to a frame in place while the writer fills the other slots, and checks it was not
+/// overwritten with ShmRingReader::Valid() when it has finished.
+///
+/// Not thread safe, one thread writes.
+///
+class ShmRingWriter {
+ public:
+  ///
+  /// \brief Create the ring, replacing one of the same name, throws std::runtime_error on failure
+  ///
+  /// \param name The POSIX shared memory name, for example /gxa-video0
+  /// \param slots Frames held, readers can keep a frame in place for slots - 1 frame times
+  /// \param capacity Most bytes of image in a frame
+  ///
+  ShmRingWriter(const std::string &name, int slots, size_t capacity);
+
+  ///
+  /// \brief Tell readers the writer has gone, then remove the ring
+  ///
+  ///
+  ~ShmRingWriter();
+
+  ShmRingWriter(const ShmRingWriter &) = delete;
+  ShmRingWriter &operator=(const ShmRingWriter &) = delete;
+
+  ///
+  /// \brief Start the next frame, the caller fills the image in place then calls Commit()
+  ///
+  /// \return uint8_t* Where to write up to Capacity() bytes of image
+  ///
+  uint8_t *Begin();
+
+  ///
+  /// \brief Publish the frame started by Begin() and wake the readers
+  ///
+  /// \param frame The description, frame and data are ignored, bytes at most Capacity()
+  ///
+  void Commit(const ShmRingFrame &frame);
+
+  ///
+  /// \brief Copy an image into the next frame and publish it
+  ///
+  /// \param frame The description, data is the image
+  /// \return true if written, false if the image is larger than Capacity()
+  ///
+  bool Write(const ShmRingFrame &frame);
+
+  ///
+  /// \brief Most bytes of image in a frame
+  ///
+  /// \return size_t The capacity
+  ///
+  size_t Capacity() const { return header_->capacity; }
+
+ private:
+  /// \brief The shared memory name
+  std::string name_;
+  /// \brief The mapping
+  uint8_t *map_ = nullptr;
+  /// \brief Bytes mapped
+  size_t map_bytes_ = 0;
+  /// \brief The header, at the start of the mapping
+  ShmRingHeader *header_ = nullptr;
+  /// \brief The slot started by Begin(), or nullptr
+  ShmRingSlot *open_ = nullptr;
+};
+
+///
+/// \brief Follows a ring from its newest frame, independently of any other reader
+///
+/// Frames are returned in order, pointing into the shared memory, so reading costs no copy. Frames the writer
+/// overwrote before they were read are skipped and counted as lost; a reader that falls a whole ring behind jumps to
+/// the newest frame.
+///
+class ShmRingReader {
+ public:
+  ///
+  /// \brief Open and map a ring, throws std::runtime_error if there is no ring of that name
+  ///
+  /// \param name The POSIX shared memory name
+  ///
+  explicit ShmRingReader(const std::string &name);
+
+  ///
+  /// \brief Unmap the ring
+  ///
+  ///
+  ~ShmRingReader();
+
+  ShmRingReader(const ShmRingReader &) = delete;
+  ShmRingReader &operator=(const ShmRingReader &) = delete;
+
+  ///
+  /// \brief Wait for the next frame
+  ///
+  /// \param frame Filled in, data points into the ring and stays valid until the writer comes round again
+  /// \param timeout_ms Longest wait, -1 to wait forever
+  /// \return int 1 for a frame, 0 on timeout, -1 if the writer has closed the ring
+  ///
+  int Next(ShmRingFrame *frame, int timeout_ms);
+
+  ///
+  /// \brief Whether a frame from Next() is still in the ring, check after using it in place
+  ///
+  /// \param frame The frame
+  /// \return true if the writer has not started overwriting it
+  ///
+  bool Valid(const ShmRingFrame &frame) const;
+
+  ///
+  /// \brief Frames overwritten before they were read
+  ///
+  /// \return uint64_t The count since the ring was opened
+  ///
+  uint64_t Lost() const { return lost_; }
+
+ private:
+  /// \brief The slot holding a frame number
+  ShmRingSlot *Slot(uint64_t frame) const;
+  /// \brief A writer has replaced the ring or removed it, without closing this one
+  bool Replaced() const;
+
+  /// \brief The shared memory name
+  std::string name_;
+  /// \brief Identifies the shared memory object opened
+  ino_t inode_ = 0;
+  /// \brief The mapping
+  uint8_t *map_ = nullptr;
+  /// \brief Bytes mapped
+  size_t map_bytes_ = 0;
+  /// \brief The header, at the start of the mapping
+  ShmRingHeader *header_ = nullptr;
+  /// \brief The next frame number to read
+  uint64_t cursor_ = 0;
+  /// \brief Frames overwritten before they were read
+  uint64_t lost_ = 0;
+};
+
+extern "C" {
+#endif
+
+///
+/// \brief Open a ring for reading, for bindings from other languages
+///
+/// \param name The POSIX shared memory name
+/// \return void* The reader, NULL if there is no ring of that name
+///
+void *shm_ring_reader_open(const char *name);
+
+///
+/// \brief Close a reader from shm_ring_reader_open()
+///
+/// \param reader The reader
+///
+void shm_ring_reader_close(void *reader);
+
+///
+/// \brief ShmRingReader::Next()
+///
+/// \param reader The reader
+/// \param frame Filled in
+/// \param timeout_ms Longest wait, -1 to wait forever
+/// \return int 1 for a frame, 0 on timeout, -1 if the writer has closed the ring
+///
+int shm_ring_reader_next(void *reader, ShmRingFrame *frame, int timeout_ms);
+
+///
+/// \brief ShmRingReader::Valid()
+///
+/// \param reader The reader
+/// \param frame A frame from shm_ring_reader_next()
+/// \return int 1 if the frame is still in the ring, else 0
+///
+int shm_ring_reader_valid(void *reader, const ShmRingFrame *frame);
+
+///
+/// \brief ShmRingReader::Lost()
+///
+/// \param reader The reader
+/// \return uint64_t Frames overwritten before they were read
+///
+uint64_t shm_ring_reader_lost(void *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SHM_RING_H
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief A rate limited logger that writes on its own thread
+///
+/// \file async_logger.cc
+///
+
+#include "async_logger.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <utility>
+
+#include "can_frame.h"
+
+AsyncLogger::AsyncLogger(int lines_per_second, size_t queue_lines)
+    : lines_per_second_(lines_per_second), queue_lines_(queue_lines), thread_(&AsyncLogger::Run, this) {}
+
+AsyncLogger::~AsyncLogger() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+bool AsyncLogger::Admit() {
+  int64_t now = MonotonicNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (now - window_start_ns_ >= 1000000000LL) {
+    window_start_ns_ = now;
+    window_lines_ = 0;
+  }
+  if (window_lines_ >= lines_per_second_ || queue_.size() >= queue_lines_) {
+    dropped_++;
+    return false;
+  }
+  window_lines_++;
+  return true;
+}
+
+void AsyncLogger::Log(std::string line) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(line));
+  }
+  wake_.notify_one();
+}
+
+void AsyncLogger::Run() {
+  std::deque<std::string> lines;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (running_ || !queue_.empty()) {
+    wake_.wait_for(lock, std::chrono::seconds(1), [this] { return !running_ || !queue_.empty(); });
+
+    // Write without the lock, the callers only wait for the swap
+    lines.swap(queue_);
+    lock.unlock();
+    for (const std::string &line : lines) {
+      fwrite(line.data(), 1, line.size(), stdout);
+      fputc('\n', stdout);
+    }
+    lines.clear();
+    uint64_t dropped = dropped_.exchange(0);
+    if (dropped) printf("... %llu lines not logged\n", static_cast<unsigned long long>(dropped));
+    fflush(stdout);
+    lock.lock();
+  }
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief A rate limited logger that writes on its own thread
+///
+/// \file async_logger.h
+///
+
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+///
+/// \brief Queues lines for a writer thread, so a slow terminal never holds up the caller
+///
+/// Lines over the rate limit, or that find the queue full, are dropped and counted, and the writer reports how many
+/// were dropped after the lines it writes. Callers ask Admit() before formatting a line so dropped lines cost nothing.
+///
+class AsyncLogger {
+ public:
+  ///
+  /// \brief Start the writer thread
+  ///
+  /// \param lines_per_second The most lines written per second, 0 to drop everything
+  /// \param queue_lines The most lines waiting for the writer
+  ///
+  explicit AsyncLogger(int lines_per_second = 20, size_t queue_lines = 1024);
+
+  ///
+  /// \brief Write what is queued and stop the writer thread
+  ///
+  ///
+  ~AsyncLogger();
+
+  ///
+  /// \brief Whether a line would be written now, counts it as dropped if not
+  ///
+  /// \return true if the caller should format and Log() the line
+  ///
+  bool Admit();
+
+  ///
+  /// \brief Queue a line for writing, a newline is added
+  ///
+  /// \param line The text
+  ///
+  void Log(std::string line);
+
+ private:
+  ///
+  /// \brief The writer thread
+  ///
+  ///
+  void Run();
+
+  /// \brief Lines allowed per second
+  int lines_per_second_;
+  /// \brief Queue limit
+  size_t queue_lines_;
+  /// \brief Start of the current one second rate window, CLOCK_MONOTONIC nanoseconds
+  int64_t window_start_ns_ = 0;
+  /// \brief Lines admitted in the current window
+  int window_lines_ = 0;
+  /// \brief Lines dropped since the last report
+  std::atomic<uint64_t> dropped_{0};
+  /// \brief Lines waiting to be written
+  std::deque<std::string> queue_;
+  /// \brief Protects queue_ and the rate window
+  std::mutex mutex_;
+  /// \brief Wakes the writer
+  std::condition_variable wake_;
+  /// \brief The writer keeps going while set
+  bool running_ = true;
+  /// \brief The writer thread
+  std::thread thread_;
+};
+
+#endif  // ASYNC_LOGGER_H
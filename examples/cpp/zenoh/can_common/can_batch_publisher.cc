@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Publishes CAN frames to zenoh in CANBatch messages, on a time or count window
+///
+/// \file can_batch_publisher.cc
+///
+
+#include "can_batch_publisher.h"
+
+#include <algorithm>
+#include <utility>
+
+// A compact batch counts its frames in 16 bits
+static constexpr int kMaxBatchFrames = 65535;
+
+std::vector<uint8_t> *BufferPool::Get(size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<uint8_t> *buffer;
+  if (free_.empty()) {
+    buffers_.push_back(std::make_unique<std::vector<uint8_t>>());
+    buffer = buffers_.back().get();
+  } else {
+    buffer = free_.back();
+    free_.pop_back();
+  }
+  // Only grows, so a reused buffer is not reallocated
+  if (buffer->size() < size) buffer->resize(size);
+  return buffer;
+}
+
+void BufferPool::Put(std::vector<uint8_t> *buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.push_back(buffer);
+}
+
+// The encoding marks the format, so subscribers can take either on any key expression
+static zenoh::Session::PublisherOptions batch_options(CanWireFormat format) {
+  zenoh::Session::PublisherOptions options = zenoh::Session::PublisherOptions::create_default();
+  options.encoding = zenoh::Encoding(format == CanWireFormat::kCompact ? kCanCompactEncoding : kCanBatchEncoding);
+  return options;
+}
+
+CanBatchPublisher::CanBatchPublisher(zenoh::Session &session, const std::string &key, int batch_frames, int batch_us,
+                                     CanWireFormat format)
+    : publisher_(session.declare_publisher(zenoh::KeyExpr(key), batch_options(format))),
+      batch_frames_(std::clamp(batch_frames, 1, kMaxBatchFrames)),
+      batch_ns_(std::max(batch_us, 0) * 1000LL),
+      encoder_(format, batch_frames_),
+      pool_(std::make_shared<BufferPool>()) {
+  read_ns_.reserve(batch_frames_);
+}
+
+void CanBatchPublisher::Add(const CanFrame &frame) {
+  if (encoder_.Frames() == 0) opened_ns_ = MonotonicNs();
+  encoder_.Add(frame);
+  read_ns_.push_back(frame.timestamp_ns);
+
+  if (encoder_.Frames() >= batch_frames_) Flush();
+}
+
+void CanBatchPublisher::Poll(int64_t now_ns) {
+  if (encoder_.Frames() && now_ns >= opened_ns_ + batch_ns_) Flush();
+}
+
+void CanBatchPublisher::Flush() {
+  if (encoder_.Frames() == 0) return;
+  int64_t start = MonotonicNs();
+
+  size_t size = encoder_.Finish(sequence_++, RealtimeNs());
+  std::vector<uint8_t> *buffer = pool_->Get(size);
+  encoder_.SerializeTo(buffer->data());
+
+  // zenoh owns the payload until it has been sent, then hands the buffer back to the pool
+  std::shared_ptr<BufferPool> pool = pool_;
+  zenoh::Publisher::PutOptions options = zenoh::Publisher::PutOptions::create_default();
+  if (!origin_.empty()) options.attachment = zenoh::Bytes(origin_);
+  publisher_.put(zenoh::Bytes(buffer->data(), size, [pool, buffer](uint8_t *) { pool->Put(buffer); }),
+                 std::move(options));
+
+  int64_t put_ns = RealtimeNs();
+  stats_.frames += read_ns_.size();
+  stats_.batches++;
+  stats_.bytes += size;
+  stats_.publish_ns += MonotonicNs() - start;
+  for (int64_t read_ns : read_ns_) {
+    stats_.latency_sum_ns += put_ns - read_ns;
+    stats_.latency_max_ns = std::max(stats_.latency_max_ns, put_ns - read_ns);
+  }
+
+  read_ns_.clear();
+  encoder_.Clear();
+}
+
+CanPublishStats CanBatchPublisher::TakeStats() { return std::exchange(stats_, CanPublishStats()); }
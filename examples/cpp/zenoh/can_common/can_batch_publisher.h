@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Publishes CAN frames to zenoh in CANBatch messages, on a time or count window
+///
+/// \file can_batch_publisher.h
+///
+
+#ifndef CAN_BATCH_PUBLISHER_H
+#define CAN_BATCH_PUBLISHER_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zenoh/zenoh.hpp>
+
+#include "can_codec.h"
+#include "can_frame.h"
+
+///
+/// \brief Publish statistics since the last call to CanBatchPublisher::TakeStats()
+///
+///
+struct CanPublishStats {
+  /// \brief Frames published
+  uint64_t frames = 0;
+  /// \brief Batches published
+  uint64_t batches = 0;
+  /// \brief Serialised bytes published
+  uint64_t bytes = 0;
+  /// \brief Nanoseconds spent building, serialising and putting batches
+  int64_t publish_ns = 0;
+  /// \brief Sum of the time from each frame being read to its batch being put
+  int64_t latency_sum_ns = 0;
+  /// \brief The longest time from a frame being read to its batch being put
+  int64_t latency_max_ns = 0;
+};
+
+///
+/// \brief Serialised batches waiting to be published or held by zenoh, reused once zenoh releases them
+///
+///
+class BufferPool {
+ public:
+  ///
+  /// \brief A free buffer, or a new one
+  ///
+  /// \param size The bytes needed
+  /// \return std::vector<uint8_t>* A buffer of at least size bytes, owned by the pool
+  ///
+  std::vector<uint8_t> *Get(size_t size);
+
+  ///
+  /// \brief Return a buffer, called by zenoh when it has finished with the payload
+  ///
+  /// \param buffer A buffer from Get()
+  ///
+  void Put(std::vector<uint8_t> *buffer);
+
+ private:
+  /// \brief Every buffer made
+  std::vector<std::unique_ptr<std::vector<uint8_t>>> buffers_;
+  /// \brief Buffers not in use
+  std::vector<std::vector<uint8_t> *> free_;
+  /// \brief Protects free_ and buffers_, zenoh may release payloads on its own threads
+  std::mutex mutex_;
+};
+
+///
+/// \brief Collects frames into a batch and puts it on a declared zenoh publisher
+///
+/// A batch is published when it holds batch_frames frames, or when its oldest frame is batch_us old. The caller
+/// checks the time window, see Deadline(), so one thread can read the bus and publish without locks. Protobuf
+/// batches are built on an arena that is reset, not freed, after every batch. Either format is serialised into
+/// pooled buffers that zenoh takes without copying, and the publisher's encoding tells subscribers which it is.
+///
+class CanBatchPublisher {
+ public:
+  ///
+  /// \brief Declare the publisher, throws zenoh::ZException on failure
+  ///
+  /// \param session An open zenoh session, which must outlive the publisher
+  /// \param key The key expression, for example can0/tx/batch
+  /// \param batch_frames Publish when a batch has this many frames, 1 to publish every frame
+  /// \param batch_us Publish when the oldest frame in a batch has waited this long
+  /// \param format The wire format for this key expression
+  ///
+  CanBatchPublisher(zenoh::Session &session, const std::string &key, int batch_frames, int batch_us,
+                    CanWireFormat format = CanWireFormat::kProtobuf);
+
+  ///
+  /// \brief Add a frame, publishing the batch if it is full
+  ///
+  /// \param frame The frame, its timestamp is when it was read
+  ///
+  void Add(const CanFrame &frame);
+
+  ///
+  /// \brief Publish the batch if its window has closed
+  ///
+  /// \param now_ns CLOCK_MONOTONIC nanoseconds
+  ///
+  void Poll(int64_t now_ns);
+
+  ///
+  /// \brief Publish the batch now, if it has any frames
+  ///
+  ///
+  void Flush();
+
+  ///
+  /// \brief When the open batch must be published
+  ///
+  /// \return int64_t CLOCK_MONOTONIC nanoseconds, 0 if no batch is open
+  ///
+  int64_t Deadline() const { return encoder_.Frames() ? opened_ns_ + batch_ns_ : 0; }
+
+  ///
+  /// \brief Attach an origin to every batch, so whoever sent it can recognise it coming back
+  ///
+  /// \param origin Unique to the sender, empty for no attachment
+  ///
+  void SetOrigin(std::string origin) { origin_ = std::move(origin); }
+
+  ///
+  /// \brief The statistics since the last call, and reset them
+  ///
+  /// \return CanPublishStats The statistics
+  ///
+  CanPublishStats TakeStats();
+
+ private:
+  /// \brief The declared publisher
+  zenoh::Publisher publisher_;
+  /// \brief Frames per batch
+  int batch_frames_;
+  /// \brief The time window in nanoseconds
+  int64_t batch_ns_;
+  /// \brief The open batch
+  CanBatchEncoder encoder_;
+  /// \brief When the first frame of the open batch arrived, CLOCK_MONOTONIC nanoseconds
+  int64_t opened_ns_ = 0;
+  /// \brief Read time of every frame in the open batch, for the latency statistics
+  std::vector<int64_t> read_ns_;
+  /// \brief Sent as the attachment of each batch, if not empty
+  std::string origin_;
+  /// \brief Sequence number of the next batch
+  uint64_t sequence_ = 0;
+  /// \brief Serialised batches, shared with the zenoh payload deleters
+  std::shared_ptr<BufferPool> pool_;
+  /// \brief The statistics so far
+  CanPublishStats stats_;
+};
+
+#endif  // CAN_BATCH_PUBLISHER_H
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Encodes and decodes batches of CAN frames, as a protobuf CANBatch or in the compact fixed layout
+///
+/// \file can_codec.cc
+///
+
+#include "can_codec.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+// Arena bytes kept per frame of the batch size, a CANMessage and its data string take about 150
+static constexpr size_t kArenaBytesPerFrame = 192;
+// Frames the decoder's arena holds before it has to grow
+static constexpr size_t kDecoderArenaFrames = 256;
+
+CanWireFormat ParseCanWireFormat(const std::string &name) {
+  if (name == "protobuf") return CanWireFormat::kProtobuf;
+  if (name == "compact") return CanWireFormat::kCompact;
+  throw std::runtime_error("Unknown CAN wire format '" + name + "', expected protobuf or compact");
+}
+
+static std::unique_ptr<google::protobuf::Arena> make_arena(std::vector<char> *block) {
+  google::protobuf::ArenaOptions options;
+  options.initial_block = block->data();
+  options.initial_block_size = block->size();
+  return std::make_unique<google::protobuf::Arena>(options);
+}
+
+CanBatchEncoder::CanBatchEncoder(CanWireFormat format, int batch_frames)
+    : format_(format), arena_block_(std::max(batch_frames, 1) * kArenaBytesPerFrame + 1024) {
+  arena_ = make_arena(&arena_block_);
+  compact_.resize(sizeof(CanWireHeader) + std::max(batch_frames, 1) * sizeof(CanWireFrame));
+  Clear();
+}
+
+void CanBatchEncoder::Add(const CanFrame &frame) {
+  frames_++;
+
+  if (format_ == CanWireFormat::kCompact) {
+    // The buffer only grows, a record is written in place and its padding zeroed
+    size_t record_size = CanWireFrameSize(frame.len);
+    if (compact_size_ + record_size > compact_.size()) compact_.resize(compact_size_ + sizeof(CanWireFrame) * 16);
+    CanWireFrame *record = reinterpret_cast<CanWireFrame *>(&compact_[compact_size_]);
+    record->id = frame.id;
+    record->flags = frame.flags;
+    record->len = frame.len;
+    record->reserved = 0;
+    record->timestamp_ns = frame.timestamp_ns;
+    memcpy(record->data, frame.data, frame.len);
+    memset(record->data + frame.len, 0, record_size - offsetof(CanWireFrame, data) - frame.len);
+    compact_size_ += record_size;
+    return;
+  }
+
+  if (!batch_) batch_ = google::protobuf::Arena::CreateMessage<can::CANBatch>(arena_.get());
+  can::CANMessage *message = batch_->add_messages();
+  message->set_id(frame.id);
+  message->add_data(frame.data, frame.len);
+  message->set_is_extended_id(frame.flags & kCanExtended);
+  message->set_is_remote(frame.flags & kCanRemote);
+  message->set_is_error(frame.flags & kCanError);
+  message->set_is_fd(frame.flags & kCanFd);
+  message->set_timestamp(frame.timestamp_ns / 1000000);
+  message->set_hardware_timestamp(frame.hardware_timestamp_ns);
+}
+
+size_t CanBatchEncoder::Finish(uint64_t sequence, int64_t publish_time_ns) {
+  if (format_ == CanWireFormat::kCompact) {
+    CanWireHeader header = {kCanWireMagic, kCanWireVersion, static_cast<uint16_t>(frames_), sequence,
+                            publish_time_ns};
+    memcpy(compact_.data(), &header, sizeof(header));
+    return compact_size_;
+  }
+
+  if (!batch_) batch_ = google::protobuf::Arena::CreateMessage<can::CANBatch>(arena_.get());
+  batch_->set_sequence(sequence);
+  batch_->set_publish_time(publish_time_ns);
+  return batch_->ByteSizeLong();
+}
+
+void CanBatchEncoder::SerializeTo(uint8_t *out) {
+  if (format_ == CanWireFormat::kCompact) {
+    memcpy(out, compact_.data(), compact_size_);
+  } else {
+    batch_->SerializeWithCachedSizesToArray(out);
+  }
+}
+
+void CanBatchEncoder::Clear() {
+  frames_ = 0;
+  // Frees everything but the first block, which the next batch reuses
+  batch_ = nullptr;
+  arena_->Reset();
+  compact_size_ = sizeof(CanWireHeader);
+}
+
+CanBatchDecoder::CanBatchDecoder() : arena_block_(kDecoderArenaFrames * kArenaBytesPerFrame) {
+  arena_ = make_arena(&arena_block_);
+}
+
+CanWireFormat CanBatchDecoder::FormatOf(const std::string &encoding) {
+  if (encoding == kCanBatchEncoding) return CanWireFormat::kProtobuf;
+  if (encoding == kCanCompactEncoding) return CanWireFormat::kCompact;
+  return CanWireFormat::kMessage;
+}
+
+bool CanBatchDecoder::Decode(CanWireFormat format, const uint8_t *data, size_t size, CanBatchView *batch) {
+  batch->frames.clear();
+
+  if (format == CanWireFormat::kCompact) {
+    CanWireHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != kCanWireMagic || header.version != kCanWireVersion) return false;
+    batch->sequence = header.sequence;
+    batch->publish_time_ns = header.publish_time_ns;
+
+    // The frames are used where they are
+    size_t offset = sizeof(header);
+    for (int i = 0; i < header.count; i++) {
+      if (offset + offsetof(CanWireFrame, data) > size) return false;
+      const CanWireFrame *record = reinterpret_cast<const CanWireFrame *>(data + offset);
+      if (record->len > sizeof(record->data) || offset + CanWireFrameSize(record->len) > size) return false;
+      batch->frames.push_back({record->id, record->flags, record->len, record->data, record->timestamp_ns, 0});
+      offset += CanWireFrameSize(record->len);
+    }
+    return true;
+  }
+
+  arena_->Reset();
+  joined_.clear();
+  size_t joined_offset = 0;
+
+  // A lone message has no sequence or publish time, it is a batch of one
+  if (format == CanWireFormat::kMessage) {
+    can::CANMessage *message = google::protobuf::Arena::CreateMessage<can::CANMessage>(arena_.get());
+    if (!message->ParseFromArray(data, static_cast<int>(size))) return false;
+    batch->sequence = 0;
+    batch->publish_time_ns = 0;
+    if (message->data_size() > 1) {
+      for (const std::string &part : message->data()) joined_ += part;
+    }
+    return AddMessage(*message, &joined_offset, batch);
+  }
+
+  can::CANBatch *message = google::protobuf::Arena::CreateMessage<can::CANBatch>(arena_.get());
+  if (!message->ParseFromArray(data, static_cast<int>(size))) return false;
+  batch->sequence = message->sequence();
+  batch->publish_time_ns = static_cast<int64_t>(message->publish_time());
+
+  // Data split over several elements, one byte each from older publishers, is joined before taking pointers
+  for (const can::CANMessage &frame : message->messages()) {
+    if (frame.data_size() > 1) {
+      for (const std::string &part : frame.data()) joined_ += part;
+    }
+  }
+
+  for (const can::CANMessage &frame : message->messages()) {
+    if (!AddMessage(frame, &joined_offset, batch)) return false;
+  }
+  return true;
+}
+
+bool CanBatchDecoder::AddMessage(const can::CANMessage &frame, size_t *joined_offset, CanBatchView *batch) {
+  uint8_t flags = (frame.is_extended_id() ? kCanExtended : 0) | (frame.is_remote() ? kCanRemote : 0) |
+                  (frame.is_error() ? kCanError : 0) | (frame.is_fd() ? kCanFd : 0);
+  CanFrameView view = {frame.id(), flags, 0, nullptr, static_cast<int64_t>(frame.timestamp()) * 1000000,
+                       static_cast<int64_t>(frame.hardware_timestamp())};
+  size_t len = 0;
+  if (frame.data_size() == 1) {
+    len = frame.data(0).size();
+    view.data = reinterpret_cast<const uint8_t *>(frame.data(0).data());
+  } else if (frame.data_size() > 1) {
+    for (const std::string &part : frame.data()) len += part.size();
+    view.data = reinterpret_cast<const uint8_t *>(joined_.data()) + *joined_offset;
+    *joined_offset += len;
+  }
+  if (len > sizeof(CanFrame::data)) return false;
+  view.len = static_cast<uint8_t>(len);
+  if (len > 8) view.flags |= kCanFd;
+  batch->frames.push_back(view);
+  return true;
+}
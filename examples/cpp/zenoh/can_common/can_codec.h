@@ -0,0 +1,248 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Encodes and decodes batches of CAN frames, as a protobuf CANBatch or in the compact fixed layout
+///
+/// \file can_codec.h
+///
+
+#ifndef CAN_CODEC_H
+#define CAN_CODEC_H
+
+#include <google/protobuf/arena.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "can_frame.h"
+#include "common_can.pb.h"
+
+/// \brief The zenoh encoding of a serialised can::CANBatch
+constexpr const char *kCanBatchEncoding = "application/protobuf;can.CANBatch";
+/// \brief The zenoh encoding of a compact batch, CanWireHeader then the frames
+constexpr const char *kCanCompactEncoding = "application/octet-stream;can.CompactBatch";
+
+/// \brief First four bytes of a compact batch, "CANB" in memory
+constexpr uint32_t kCanWireMagic = 0x424e4143;
+/// \brief Version of the compact layout
+constexpr uint16_t kCanWireVersion = 1;
+
+///
+/// \brief How frames are laid out on the wire, chosen per publisher and so per key expression
+///
+///
+enum class CanWireFormat {
+  /// \brief can::CANBatch, the ICD message, smallest for classic frames but has to be parsed
+  kProtobuf,
+  /// \brief CanWireHeader and CanWireFrame records, read in place with no parsing
+  kCompact,
+  /// \brief A single can::CANMessage, as the Python and Rust examples publish, only ever decoded
+  kMessage
+};
+
+///
+/// \brief The format named on the command line
+///
+/// \param name protobuf or compact
+/// \return CanWireFormat The format, throws std::runtime_error for any other name
+///
+CanWireFormat ParseCanWireFormat(const std::string &name);
+
+#pragma pack(push, 1)
+///
+/// \brief Start of a compact batch, little endian like the rest of the layout
+///
+///
+struct CanWireHeader {
+  /// \brief kCanWireMagic
+  uint32_t magic;
+  /// \brief kCanWireVersion
+  uint16_t version;
+  /// \brief Frames that follow
+  uint16_t count;
+  /// \brief Incremented per batch, a gap means batches were lost
+  uint64_t sequence;
+  /// \brief When the batch was published, nanoseconds since the Unix epoch
+  int64_t publish_time_ns;
+};
+
+///
+/// \brief One frame of a compact batch
+///
+/// Only the first CanWireFrameSize(len) bytes are sent: the data is cut to len rounded up to eight bytes, so a
+/// classic frame is 24 bytes and every record stays eight byte aligned.
+///
+struct CanWireFrame {
+  /// \brief The 11 or 29 bit identifier
+  uint32_t id;
+  /// \brief kCanExtended, kCanRemote, kCanFd and kCanError
+  uint8_t flags;
+  /// \brief Bytes of data
+  uint8_t len;
+  /// \brief Zero
+  uint16_t reserved;
+  /// \brief When the frame was received, nanoseconds since the Unix epoch
+  int64_t timestamp_ns;
+  /// \brief The data, padded with zeros
+  uint8_t data[64];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CanWireHeader) == 24, "CanWireHeader is part of the wire format");
+static_assert(sizeof(CanWireFrame) == 80, "CanWireFrame is part of the wire format");
+
+///
+/// \brief Bytes a frame takes in a compact batch
+///
+/// \param len Bytes of data
+/// \return size_t The record size
+///
+inline size_t CanWireFrameSize(uint8_t len) { return offsetof(CanWireFrame, data) + ((len + 7u) & ~7u); }
+
+///
+/// \brief A decoded batch
+///
+///
+struct CanBatchView {
+  /// \brief Batch sequence number
+  uint64_t sequence = 0;
+  /// \brief When the batch was published, nanoseconds since the Unix epoch
+  int64_t publish_time_ns = 0;
+  /// \brief The frames, in bus order
+  std::vector<CanFrameView> frames;
+};
+
+///
+/// \brief Builds a batch in either format, reused from batch to batch
+///
+///
+class CanBatchEncoder {
+ public:
+  ///
+  /// \brief Construct a new Can Batch Encoder object
+  ///
+  /// \param format The wire format
+  /// \param batch_frames Frames in a typical batch, to size the buffers so they do not grow
+  ///
+  CanBatchEncoder(CanWireFormat format, int batch_frames);
+
+  ///
+  /// \brief Add a frame to the batch
+  ///
+  /// \param frame The frame
+  ///
+  void Add(const CanFrame &frame);
+
+  ///
+  /// \brief Frames in the batch
+  ///
+  /// \return int The count
+  ///
+  int Frames() const { return frames_; }
+
+  ///
+  /// \brief Close the batch
+  ///
+  /// \param sequence Batch sequence number
+  /// \param publish_time_ns When the batch is published, nanoseconds since the Unix epoch
+  /// \return size_t The encoded size
+  ///
+  size_t Finish(uint64_t sequence, int64_t publish_time_ns);
+
+  ///
+  /// \brief Write the closed batch
+  ///
+  /// \param out At least the size returned by Finish()
+  ///
+  void SerializeTo(uint8_t *out);
+
+  ///
+  /// \brief Empty the batch, keeping the memory
+  ///
+  ///
+  void Clear();
+
+  ///
+  /// \brief The wire format
+  ///
+  /// \return CanWireFormat The format
+  ///
+  CanWireFormat Format() const { return format_; }
+
+ private:
+  /// \brief The wire format
+  CanWireFormat format_;
+  /// \brief Frames added
+  int frames_ = 0;
+  /// \brief First block of the arena, kept across resets so steady state batches do not allocate
+  std::vector<char> arena_block_;
+  /// \brief Holds the protobuf batch and its messages
+  std::unique_ptr<google::protobuf::Arena> arena_;
+  /// \brief The protobuf batch, on the arena, or nullptr
+  can::CANBatch *batch_ = nullptr;
+  /// \brief The compact batch, header first
+  std::vector<uint8_t> compact_;
+  /// \brief Bytes of compact_ in use
+  size_t compact_size_ = 0;
+};
+
+///
+/// \brief Decodes batches in either format without copying the frame data out of the payload
+///
+/// A compact batch is read in place. A protobuf batch is parsed into an arena that is reset by the next decode.
+///
+class CanBatchDecoder {
+ public:
+  ///
+  /// \brief Construct a new Can Batch Decoder object
+  ///
+  ///
+  CanBatchDecoder();
+
+  ///
+  /// \brief Decode a batch, the views stay valid until the next call and while the payload is unchanged
+  ///
+  /// \param format The wire format, from the sample's encoding
+  /// \param data The payload
+  /// \param size Payload bytes
+  /// \param batch Filled with the frames
+  /// \return true if the payload was a valid batch
+  ///
+  bool Decode(CanWireFormat format, const uint8_t *data, size_t size, CanBatchView *batch);
+
+  ///
+  /// \brief The format of a sample, from its zenoh encoding
+  ///
+  /// \param encoding The encoding as a string
+  /// \return CanWireFormat kProtobuf for kCanBatchEncoding, kCompact for kCanCompactEncoding, otherwise kMessage
+  ///
+  static CanWireFormat FormatOf(const std::string &encoding);
+
+ private:
+  ///
+  /// \brief Add a protobuf message to the batch, its data joined into joined_ first if split over several elements
+  ///
+  /// \param frame The message
+  /// \param joined_offset Where its joined data starts in joined_, moved past it
+  /// \param batch The batch to add it to
+  /// \return true if the data fits a frame
+  ///
+  bool AddMessage(const can::CANMessage &frame, size_t *joined_offset, CanBatchView *batch);
+
+  /// \brief First block of the arena
+  std::vector<char> arena_block_;
+  /// \brief Holds the last protobuf batch
+  std::unique_ptr<google::protobuf::Arena> arena_;
+  /// \brief Data of protobuf messages that split it over several elements, joined
+  std::string joined_;
+};
+
+#endif  // CAN_CODEC_H
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief A CAN or CAN FD frame as read from the bus, independent of SocketCAN and the wire format
+///
+/// \file can_frame.h
+///
+
+#ifndef CAN_FRAME_H
+#define CAN_FRAME_H
+
+#include <stdint.h>
+#include <time.h>
+
+/// \brief The identifier is 29 bit
+constexpr uint8_t kCanExtended = 0x01;
+/// \brief Remote transmission request, no data
+constexpr uint8_t kCanRemote = 0x02;
+/// \brief CAN FD frame, up to 64 bytes of data
+constexpr uint8_t kCanFd = 0x04;
+/// \brief Error frame, the identifier holds the error class
+constexpr uint8_t kCanError = 0x08;
+
+///
+/// \brief One CAN frame
+///
+///
+struct CanFrame {
+  /// \brief The 11 or 29 bit identifier, without flags
+  uint32_t id = 0;
+  /// \brief kCanExtended, kCanRemote, kCanFd and kCanError
+  uint8_t flags = 0;
+  /// \brief Bytes of data, up to 8, or 64 for CAN FD
+  uint8_t len = 0;
+  /// \brief The data, len bytes are valid
+  uint8_t data[64];
+  /// \brief When the frame was received, nanoseconds since the Unix epoch
+  int64_t timestamp_ns = 0;
+  /// \brief When the adapter received it, nanoseconds in the adapter's own clock, or 0 if it has no timestamp
+  int64_t hardware_timestamp_ns = 0;
+};
+
+///
+/// \brief A frame whose data lives elsewhere, for example in a received payload
+///
+///
+struct CanFrameView {
+  /// \brief The 11 or 29 bit identifier
+  uint32_t id;
+  /// \brief kCanExtended, kCanRemote, kCanFd and kCanError
+  uint8_t flags;
+  /// \brief Bytes of data
+  uint8_t len;
+  /// \brief The data
+  const uint8_t *data;
+  /// \brief When the frame was received, nanoseconds since the Unix epoch, to the millisecond for protobuf
+  int64_t timestamp_ns;
+  /// \brief The adapter's receive time in its own clock, 0 if it had none or the format does not carry it
+  int64_t hardware_timestamp_ns;
+};
+
+///
+/// \brief The wall clock, comparable between hosts that are time synchronised
+///
+/// \return int64_t Nanoseconds since the Unix epoch
+///
+inline int64_t RealtimeNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+///
+/// \brief A clock that does not step, for windows and intervals
+///
+/// \return int64_t CLOCK_MONOTONIC nanoseconds
+///
+inline int64_t MonotonicNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+#endif  // CAN_FRAME_H
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Generated CAN traffic for the benchmarks
+///
+/// \file frame_generator.h
+///
+
+#ifndef FRAME_GENERATOR_H
+#define FRAME_GENERATOR_H
+
+#include <stdint.h>
+
+#include "can_frame.h"
+
+///
+/// \brief Classic 8 byte frames with a running count in the data, at a fixed rate or as fast as they are taken
+///
+///
+class FrameGenerator {
+ public:
+  ///
+  /// \brief Construct a new Frame Generator object, the first frame is due now
+  ///
+  /// \param rate Frames per second, 0 for no limit
+  ///
+  explicit FrameGenerator(int rate) : rate_(rate), start_ns_(MonotonicNs()) {}
+
+  ///
+  /// \brief When the next frame is due
+  ///
+  /// \return int64_t CLOCK_MONOTONIC nanoseconds, 0 if there is no rate limit
+  ///
+  int64_t Due() const { return rate_ ? start_ns_ + static_cast<int64_t>(count_ * 1e9 / rate_) : 0; }
+
+  ///
+  /// \brief Make the next frame, stamped now
+  ///
+  /// \param frame The frame to fill
+  ///
+  void Next(CanFrame *frame) {
+    frame->id = 0x100 + (count_ & 0xff);
+    frame->flags = 0;
+    frame->len = 8;
+    for (int i = 0; i < 8; i++) frame->data[i] = static_cast<uint8_t>(count_ >> (i * 8));
+    frame->timestamp_ns = RealtimeNs();
+    frame->hardware_timestamp_ns = 0;
+    count_++;
+  }
+
+  ///
+  /// \brief The frames made so far
+  ///
+  /// \return uint64_t The count
+  ///
+  uint64_t Count() const { return count_; }
+
+ private:
+  /// \brief Frames per second, 0 for no limit
+  int rate_;
+  /// \brief When the first frame was due
+  int64_t start_ns_;
+  /// \brief Frames made
+  uint64_t count_ = 0;
+};
+
+#endif  // FRAME_GENERATOR_H
@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief A raw SocketCAN socket that reads and writes frames in batches
+///
+/// \file socket_can.cc
+///
+
+#include "socket_can.h"
+
+#include <errno.h>
+#include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+// Times a write waits a millisecond for room in a full transmit queue before giving up on the rest
+static constexpr int kWriteRetries = 10;
+// Control message space for one SCM_TIMESTAMPING
+static constexpr size_t kControlSize = CMSG_SPACE(sizeof(struct scm_timestamping));
+
+static int64_t timespec_ns(const struct timespec &time) { return time.tv_sec * 1000000000LL + time.tv_nsec; }
+
+std::vector<struct can_filter> ParseCanFilters(const std::string &text) {
+  std::vector<struct can_filter> filters;
+  std::stringstream list(text);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    if (item.empty()) continue;
+    try {
+      size_t slash = item.find('/');
+      uint32_t id = std::stoul(item.substr(0, slash), nullptr, 0);
+      bool extended = id > CAN_SFF_MASK;
+      uint32_t mask = extended ? CAN_EFF_MASK : CAN_SFF_MASK;
+      if (slash != std::string::npos) mask = std::stoul(item.substr(slash + 1), nullptr, 0);
+      // Matching the frame format too, so 0x123 does not also pass the extended frame 0x00000123
+      filters.push_back({id | (extended ? CAN_EFF_FLAG : 0), mask | CAN_EFF_FLAG});
+    } catch (const std::exception &) {
+      throw std::runtime_error("Invalid CAN filter '" + item + "', expected id or id/mask");
+    }
+  }
+  return filters;
+}
+
+SocketCan::SocketCan(const std::string &interface, int batch) : interface_(interface) {
+  socket_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (socket_ < 0) throw std::runtime_error(std::string("CAN socket: ") + strerror(errno));
+
+  struct ifreq request = {};
+  strncpy(request.ifr_name, interface_.c_str(), IFNAMSIZ - 1);
+  if (ioctl(socket_, SIOCGIFINDEX, &request) < 0) {
+    close(socket_);
+    throw std::runtime_error("CAN interface " + interface_ + ": " + strerror(errno));
+  }
+  int index = request.ifr_ifindex;
+
+  // CAN FD frames can only be written to an interface with the CAN FD MTU
+  if (ioctl(socket_, SIOCGIFMTU, &request) == 0 && request.ifr_mtu == CANFD_MTU) {
+    int enable = 1;
+    fd_ = setsockopt(socket_, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) == 0;
+  }
+
+  // The default, but the gateway relies on it: what this socket writes is never read back and forwarded again
+  int own = 0;
+  setsockopt(socket_, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &own, sizeof(own));
+
+  struct sockaddr_can address = {};
+  address.can_family = AF_CAN;
+  address.can_ifindex = index;
+  if (bind(socket_, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0) {
+    close(socket_);
+    throw std::runtime_error("CAN bind to " + interface_ + ": " + strerror(errno));
+  }
+
+  size_t size = std::max(batch, 1);
+  raw_.resize(size);
+  iovecs_.resize(size);
+  messages_.resize(size);
+  control_.resize(size * kControlSize);
+  tx_raw_.resize(size);
+  tx_iovecs_.resize(size);
+  tx_messages_.resize(size);
+}
+
+SocketCan::~SocketCan() {
+  if (socket_ >= 0) close(socket_);
+}
+
+bool SocketCan::SetFilters(const std::vector<struct can_filter> &filters) {
+  return setsockopt(socket_, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), filters.size() * sizeof(filters[0])) == 0;
+}
+
+bool SocketCan::EnableTimestamps(bool hardware) {
+  int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+  if (hardware) {
+    // Adapters that stamp in hardware may need it turned on, those that always do refuse the request
+    struct hwtstamp_config config = {};
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    struct ifreq request = {};
+    strncpy(request.ifr_name, interface_.c_str(), IFNAMSIZ - 1);
+    request.ifr_data = reinterpret_cast<char *>(&config);
+    ioctl(socket_, SIOCSHWTSTAMP, &request);
+    flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+  }
+
+  timestamps_ = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+  if (!timestamps_ && hardware) return EnableTimestamps(false);
+  hardware_ = timestamps_ && hardware;
+  return timestamps_;
+}
+
+int SocketCan::Read(CanFrame *frames, int64_t timeout_ns) {
+  // Nanoseconds, batch windows are often shorter than a millisecond
+  struct pollfd readable = {socket_, POLLIN, 0};
+  struct timespec timeout = {static_cast<time_t>(timeout_ns / 1000000000), static_cast<long>(timeout_ns % 1000000000)};
+  int ready = ppoll(&readable, 1, timeout_ns < 0 ? nullptr : &timeout, nullptr);
+  if (ready < 0) return errno == EINTR ? 0 : -1;
+  if (ready == 0) return 0;
+
+  for (size_t i = 0; i < messages_.size(); i++) {
+    iovecs_[i] = {&raw_[i], sizeof(struct canfd_frame)};
+    messages_[i].msg_hdr = {};
+    messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+    messages_[i].msg_hdr.msg_iovlen = 1;
+    if (timestamps_) {
+      messages_[i].msg_hdr.msg_control = &control_[i * kControlSize];
+      messages_[i].msg_hdr.msg_controllen = kControlSize;
+    }
+  }
+  int count = recvmmsg(socket_, messages_.data(), messages_.size(), MSG_DONTWAIT, nullptr);
+  if (count < 0) return errno == EAGAIN || errno == EINTR ? 0 : -1;
+
+  int64_t now = RealtimeNs();
+  for (int i = 0; i < count; i++) {
+    const struct canfd_frame &raw = raw_[i];
+    CanFrame &frame = frames[i];
+    frame.flags = messages_[i].msg_len == CANFD_MTU ? kCanFd : 0;
+    if (raw.can_id & CAN_EFF_FLAG) frame.flags |= kCanExtended;
+    if (raw.can_id & CAN_RTR_FLAG) frame.flags |= kCanRemote;
+    if (raw.can_id & CAN_ERR_FLAG) frame.flags |= kCanError;
+    frame.id = raw.can_id & (raw.can_id & CAN_EFF_FLAG ? CAN_EFF_MASK : CAN_SFF_MASK);
+    // can_frame.can_dlc and canfd_frame.len are the same byte
+    frame.len = std::min<uint8_t>(raw.len, (frame.flags & kCanFd) ? CANFD_MAX_DLEN : CAN_MAX_DLEN);
+    memcpy(frame.data, raw.data, frame.len);
+
+    // When the kernel received it, else now. The adapter's time is in its own clock, not the Unix epoch, so it is
+    // kept apart and never compared with the wall clock
+    frame.timestamp_ns = now;
+    frame.hardware_timestamp_ns = 0;
+    struct msghdr &header = messages_[i].msg_hdr;
+    for (struct cmsghdr *cmsg = timestamps_ ? CMSG_FIRSTHDR(&header) : nullptr; cmsg;
+         cmsg = CMSG_NXTHDR(&header, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPING) continue;
+      struct scm_timestamping stamps;
+      memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+      if (timespec_ns(stamps.ts[0])) frame.timestamp_ns = timespec_ns(stamps.ts[0]);
+      if (hardware_ && timespec_ns(stamps.ts[2])) {
+        frame.hardware_timestamp_ns = timespec_ns(stamps.ts[2]);
+        hardware_timestamps_++;
+      }
+    }
+  }
+  return count;
+}
+
+int SocketCan::Write(const CanFrameView *frames, int count) {
+  int written = 0;
+  int next = 0;
+
+  while (next < count) {
+    // Fill the messages, error frames and CAN FD frames the interface cannot carry are left out
+    int prepared = 0;
+    for (; next < count && prepared < Batch(); next++) {
+      const CanFrameView &frame = frames[next];
+      bool fd = (frame.flags & kCanFd) || frame.len > CAN_MAX_DLEN;
+      if ((frame.flags & kCanError) || (fd && !fd_) || frame.len > CANFD_MAX_DLEN) continue;
+
+      struct canfd_frame &raw = tx_raw_[prepared];
+      raw = {};
+      raw.can_id = frame.id | ((frame.flags & kCanExtended) ? CAN_EFF_FLAG : 0) |
+                   ((frame.flags & kCanRemote) ? CAN_RTR_FLAG : 0);
+      raw.len = frame.len;
+      if (frame.data) memcpy(raw.data, frame.data, frame.len);
+      tx_iovecs_[prepared] = {&raw, fd ? CANFD_MTU : CAN_MTU};
+      tx_messages_[prepared].msg_hdr = {};
+      tx_messages_[prepared].msg_hdr.msg_iov = &tx_iovecs_[prepared];
+      tx_messages_[prepared].msg_hdr.msg_iovlen = 1;
+      prepared++;
+    }
+
+    // A full transmit queue is ENOBUFS on most adapters, give it a moment to drain
+    int sent = 0;
+    int retries = 0;
+    while (sent < prepared) {
+      int result = sendmmsg(socket_, &tx_messages_[sent], prepared - sent, MSG_DONTWAIT);
+      if (result >= 0) {
+        sent += result;
+        continue;
+      }
+      if (errno == EINTR) continue;
+      if ((errno != EAGAIN && errno != ENOBUFS) || ++retries > kWriteRetries) return written + sent;
+      struct pollfd writable = {socket_, POLLOUT, 0};
+      poll(&writable, 1, 1);
+    }
+    written += sent;
+  }
+  return written;
+}
@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief A raw SocketCAN socket that reads and writes frames in batches
+///
+/// \file socket_can.h
+///
+
+#ifndef SOCKET_CAN_H
+#define SOCKET_CAN_H
+
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+
+#include "can_frame.h"
+
+///
+/// \brief Parse receive filters from the command line
+///
+/// \param text Comma separated id or id/mask, in hex with 0x or decimal, ids over 0x7FF are extended
+/// \return std::vector<struct can_filter> The filters, throws std::runtime_error if one does not parse
+///
+std::vector<struct can_filter> ParseCanFilters(const std::string &text);
+
+///
+/// \brief A CAN_RAW socket bound to one interface, for example can0 or a vcan for testing
+///
+/// CAN FD frames are enabled where the interface supports them. Reads take everything queued, up to the batch size,
+/// in one recvmmsg() call, and writes go out in one sendmmsg() call. Frames written are not read back by this
+/// socket, though other sockets on the host see them as usual.
+///
+class SocketCan {
+ public:
+  ///
+  /// \brief Open and bind the socket, throws std::runtime_error if the interface does not exist
+  ///
+  /// \param interface The interface name, for example vcan0
+  /// \param batch The most frames read or written by one call
+  ///
+  explicit SocketCan(const std::string &interface, int batch = 64);
+
+  ///
+  /// \brief Destroy the Socket Can object, closes the socket
+  ///
+  ///
+  ~SocketCan();
+
+  SocketCan(const SocketCan &) = delete;
+  SocketCan &operator=(const SocketCan &) = delete;
+
+  ///
+  /// \brief Only receive frames matching one of the filters, the kernel drops the rest before they are queued
+  ///
+  /// \param filters The filters, empty to receive nothing
+  /// \return true if the kernel took the filters
+  ///
+  bool SetFilters(const std::vector<struct can_filter> &filters);
+
+  ///
+  /// \brief Stamp received frames in the kernel rather than when Read() returns
+  ///
+  /// \param hardware Also keep the adapter's timestamp, in CanFrame::hardware_timestamp_ns, when it has one
+  /// \return true if timestamping is on
+  ///
+  bool EnableTimestamps(bool hardware);
+
+  ///
+  /// \brief Wait for frames and read all those queued
+  ///
+  /// \param frames Filled with up to Batch() frames
+  /// \param timeout_ns Longest wait for the first frame, -1 to wait forever
+  /// \return int The frames read, 0 on timeout, -1 on error
+  ///
+  int Read(CanFrame *frames, int64_t timeout_ns);
+
+  ///
+  /// \brief Write frames, waiting briefly for room in the transmit queue
+  ///
+  /// \param frames The frames
+  /// \param count How many, more than Batch() are written in several calls
+  /// \return int The frames written, fewer if the queue stayed full or the interface failed
+  ///
+  int Write(const CanFrameView *frames, int count);
+
+  ///
+  /// \brief The most frames read or written by one call
+  ///
+  /// \return int The batch size
+  ///
+  int Batch() const { return static_cast<int>(messages_.size()); }
+
+  ///
+  /// \brief The interface name
+  ///
+  /// \return const std::string& The name given to the constructor
+  ///
+  const std::string &Interface() const { return interface_; }
+
+  ///
+  /// \brief Frames received with a hardware timestamp since the socket was opened
+  ///
+  /// \return uint64_t The count
+  ///
+  uint64_t HardwareTimestamps() const { return hardware_timestamps_; }
+
+ private:
+  /// \brief The interface name
+  std::string interface_;
+  /// \brief The CAN_RAW socket
+  int socket_ = -1;
+  /// \brief The adapter supports CAN FD
+  bool fd_ = false;
+  /// \brief Kernel timestamps are on
+  bool timestamps_ = false;
+  /// \brief Keep the hardware timestamp when there is one
+  bool hardware_ = false;
+  /// \brief Frames received with a hardware timestamp
+  uint64_t hardware_timestamps_ = 0;
+  /// \brief Receive buffers, one per message
+  std::vector<struct canfd_frame> raw_;
+  /// \brief One iovec per receive buffer
+  std::vector<struct iovec> iovecs_;
+  /// \brief One message per frame
+  std::vector<struct mmsghdr> messages_;
+  /// \brief Timestamp control messages, one per receive buffer
+  std::vector<uint8_t> control_;
+  /// \brief Transmit buffers, one per message
+  std::vector<struct canfd_frame> tx_raw_;
+  /// \brief One iovec per transmit buffer
+  std::vector<struct iovec> tx_iovecs_;
+  /// \brief One message per frame written
+  std::vector<struct mmsghdr> tx_messages_;
+};
+
+#endif  // SOCKET_CAN_H
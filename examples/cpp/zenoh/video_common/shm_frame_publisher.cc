@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Publishes video frames to zenoh from shared memory, so local subscribers read them without a copy
+///
+/// \file shm_frame_publisher.cc
+///
+
+#include "shm_frame_publisher.h"
+
+#include <string.h>
+#include <time.h>
+
+#include <iostream>
+#include <utility>
+#include <variant>
+
+// Chunks are aligned to 64 bytes, 2^6, and the header is 64 bytes, so every image starts on a cache line
+static constexpr uint8_t kAlignmentPow = 6;
+
+static int64_t clock_ns(clockid_t clock) {
+  struct timespec now;
+  clock_gettime(clock, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+zenoh::Config VideoSessionConfig() {
+  zenoh::Config config = zenoh::Config::create_default();
+#ifdef VIDEO_SHM_SUPPORTED
+  config.insert_json5("transport/shared_memory/enabled", "true");
+#endif
+  return config;
+}
+
+static zenoh::Session::PublisherOptions frame_options() {
+  zenoh::Session::PublisherOptions options = zenoh::Session::PublisherOptions::create_default();
+  options.encoding = zenoh::Encoding(kVideoFrameEncoding);
+  return options;
+}
+
+ShmFramePublisher::ShmFramePublisher(zenoh::Session &session, const std::string &key, size_t pool_bytes, bool shm)
+    : publisher_(session.declare_publisher(zenoh::KeyExpr(key), frame_options())) {
+#ifdef VIDEO_SHM_SUPPORTED
+  if (shm) {
+    provider_ = std::make_unique<zenoh::PosixShmProvider>(
+        zenoh::MemoryLayout(pool_bytes, zenoh::AllocAlignment({kAlignmentPow})));
+  }
+#else
+  (void)pool_bytes;
+  if (shm) std::cerr << "zenoh was built without shared memory, frames will be copied to subscribers\n";
+#endif
+}
+
+uint8_t *ShmFramePublisher::Begin(VideoFrameHeader header, bool wait) {
+  begin_ns_ = clock_ns(CLOCK_MONOTONIC);
+  size_t size = sizeof(VideoFrameHeader) + header.image_bytes;
+
+#ifdef VIDEO_SHM_SUPPORTED
+  if (provider_) {
+    // Collecting and defragmenting only happens when the pool looks full
+    zenoh::AllocAlignment alignment({kAlignmentPow});
+    auto result = wait ? provider_->alloc_gc_defrag_blocking(size, alignment)
+                       : provider_->alloc_gc_defrag(size, alignment);
+    if (!std::holds_alternative<zenoh::ZShmMut>(result)) {
+      stats_.dropped++;
+      return nullptr;
+    }
+    chunk_.emplace(std::get<zenoh::ZShmMut>(std::move(result)));
+    open_ = chunk_->data();
+  }
+#endif
+  if (!Shm()) {
+    // zenoh takes the vector when the frame is put, so this allocates once per frame, and never waits
+    (void)wait;
+    heap_.resize(size);
+    open_ = heap_.data();
+  }
+
+  header.magic = kVideoFrameMagic;
+  header.version = kVideoFrameVersion;
+  header.header_bytes = sizeof(VideoFrameHeader);
+  memset(header.reserved, 0, sizeof(header.reserved));
+  memcpy(open_, &header, sizeof(header));
+  return open_ + sizeof(VideoFrameHeader);
+}
+
+void ShmFramePublisher::Publish() {
+  if (!open_) return;
+  VideoFrameHeader *header = reinterpret_cast<VideoFrameHeader *>(open_);
+  header->publish_time_ns = clock_ns(CLOCK_REALTIME);
+  size_t size = sizeof(VideoFrameHeader) + header->image_bytes;
+  open_ = nullptr;
+
+#ifdef VIDEO_SHM_SUPPORTED
+  if (chunk_) {
+    // Only the chunk's reference goes to local subscribers
+    publisher_.put(zenoh::Bytes(std::move(*chunk_)));
+    chunk_.reset();
+  }
+#endif
+  if (!Shm()) publisher_.put(zenoh::Bytes(std::move(heap_)));
+
+  stats_.frames++;
+  stats_.bytes += size;
+  stats_.publish_ns += clock_ns(CLOCK_MONOTONIC) - begin_ns_;
+}
+
+bool ShmFramePublisher::Publish(const VideoFrameHeader &header, const uint8_t *image, bool wait) {
+  uint8_t *out = Begin(header, wait);
+  if (!out) return false;
+  memcpy(out, image, header.image_bytes);
+  Publish();
+  return true;
+}
+
+bool ShmFramePublisher::Shm() const {
+#ifdef VIDEO_SHM_SUPPORTED
+  return provider_ != nullptr;
+#else
+  return false;
+#endif
+}
+
+VideoPublishStats ShmFramePublisher::TakeStats() {
+  VideoPublishStats stats = stats_;
+  stats_ = VideoPublishStats();
+  return stats;
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Publishes video frames to zenoh from shared memory, so local subscribers read them without a copy
+///
+/// \file shm_frame_publisher.h
+///
+
+#ifndef SHM_FRAME_PUBLISHER_H
+#define SHM_FRAME_PUBLISHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <zenoh/zenoh.hpp>
+
+#include "video_frame.h"
+
+// zenoh-c has to be built with shared memory, an unstable feature in zenoh 1.x
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+#define VIDEO_SHM_SUPPORTED
+#endif
+
+///
+/// \brief A session configuration with shared memory on, for publishers and subscribers of frames
+///
+/// \return zenoh::Config The default configuration, with shared memory transport enabled where zenoh supports it
+///
+zenoh::Config VideoSessionConfig();
+
+///
+/// \brief Publish statistics since the last call to ShmFramePublisher::TakeStats()
+///
+///
+struct VideoPublishStats {
+  /// \brief Frames published
+  uint64_t frames = 0;
+  /// \brief Frames dropped because the shared memory was full
+  uint64_t dropped = 0;
+  /// \brief Bytes published, headers and images
+  uint64_t bytes = 0;
+  /// \brief Nanoseconds from Begin() to the put returning, including the caller filling the image
+  int64_t publish_ns = 0;
+};
+
+///
+/// \brief Puts frames on a declared zenoh publisher from a POSIX shared memory pool
+///
+/// Each frame is a VideoFrameHeader and the image, written straight into a chunk of the pool. The put sends
+/// subscribers on this host a reference to the chunk, not the frame, and they read it where it is. The chunk goes
+/// back to the pool when every subscriber has dropped it. Subscribers on other hosts are sent the frame as usual.
+/// Without shared memory in zenoh, or with shm false, frames are built in memory that zenoh takes without a copy.
+///
+/// Not thread safe, one thread publishes.
+///
+class ShmFramePublisher {
+ public:
+  ///
+  /// \brief Declare the publisher and create the pool, throws zenoh::ZException on failure
+  ///
+  /// \param session An open zenoh session, from VideoSessionConfig(), which must outlive the publisher
+  /// \param key The key expression, for example video/0/raw
+  /// \param pool_bytes Size of the shared memory pool, a few frames more than subscribers hold at once
+  /// \param shm false to publish from ordinary memory, for comparison
+  ///
+  ShmFramePublisher(zenoh::Session &session, const std::string &key, size_t pool_bytes, bool shm = true);
+
+  ///
+  /// \brief Start a frame, the caller writes the image and then calls Publish()
+  ///
+  /// \param header The frame, magic, version, header_bytes and publish_time_ns are filled in
+  /// \param wait Wait for subscribers to free a chunk if the pool is full, rather than drop the frame
+  /// \return uint8_t* Where to write header.image_bytes of image, nullptr if the frame was dropped
+  ///
+  uint8_t *Begin(VideoFrameHeader header, bool wait = false);
+
+  ///
+  /// \brief Put the frame started by Begin()
+  ///
+  ///
+  void Publish();
+
+  ///
+  /// \brief Copy an image into a frame and put it
+  ///
+  /// \param header The frame, as for Begin()
+  /// \param image header.image_bytes of image
+  /// \param wait As for Begin()
+  /// \return true if the frame was published
+  ///
+  bool Publish(const VideoFrameHeader &header, const uint8_t *image, bool wait = false);
+
+  ///
+  /// \brief Frames go through shared memory
+  ///
+  /// \return true if there is a shared memory pool
+  ///
+  bool Shm() const;
+
+  ///
+  /// \brief The statistics since the last call, and reset them
+  ///
+  /// \return VideoPublishStats The statistics
+  ///
+  VideoPublishStats TakeStats();
+
+ private:
+  /// \brief The declared publisher
+  zenoh::Publisher publisher_;
+#ifdef VIDEO_SHM_SUPPORTED
+  /// \brief The shared memory pool, nullptr when not using shared memory
+  std::unique_ptr<zenoh::PosixShmProvider> provider_;
+  /// \brief The chunk of the frame started
+  std::optional<zenoh::ZShmMut> chunk_;
+#endif
+  /// \brief The frame started, when not using shared memory
+  std::vector<uint8_t> heap_;
+  /// \brief The frame started, nullptr if none
+  uint8_t *open_ = nullptr;
+  /// \brief When the frame was started, CLOCK_MONOTONIC nanoseconds
+  int64_t begin_ns_ = 0;
+  /// \brief The statistics so far
+  VideoPublishStats stats_;
+};
+
+#endif  // SHM_FRAME_PUBLISHER_H
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief The layout of a video frame published on zenoh, a fixed header followed by the image
+///
+/// \file video_frame.h
+///
+
+#ifndef VIDEO_FRAME_H
+#define VIDEO_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/// \brief The zenoh encoding of a frame, VideoFrameHeader then the image
+constexpr const char *kVideoFrameEncoding = "application/octet-stream;gxa.VideoFrame";
+/// \brief First four bytes of a frame, "VIDF" in memory
+constexpr uint32_t kVideoFrameMagic = 0x46444956;
+/// \brief Version of the layout
+constexpr uint16_t kVideoFrameVersion = 1;
+
+#pragma pack(push, 1)
+///
+/// \brief Start of every frame, little endian
+///
+/// The header is 64 bytes so the image that follows keeps the alignment of the buffer, a cache line or more.
+///
+struct VideoFrameHeader {
+  /// \brief kVideoFrameMagic
+  uint32_t magic;
+  /// \brief kVideoFrameVersion
+  uint16_t version;
+  /// \brief sizeof(VideoFrameHeader), where the image starts
+  uint16_t header_bytes;
+  /// \brief Width in pixels
+  uint32_t width;
+  /// \brief Height in lines, half the frame height for a field
+  uint32_t height;
+  /// \brief Bytes per line
+  uint32_t stride;
+  /// \brief The V4L2 fourcc, for example V4L2_PIX_FMT_YUYV
+  uint32_t fourcc;
+  /// \brief V4L2_FIELD_TOP, V4L2_FIELD_BOTTOM, or V4L2_FIELD_ANY for a whole frame
+  int32_t field;
+  /// \brief The capture sequence number, a gap means frames were dropped
+  uint32_t sequence;
+  /// \brief When the frame was captured, CLOCK_MONOTONIC nanoseconds on the publishing host
+  int64_t capture_ns;
+  /// \brief When the frame was published, nanoseconds since the Unix epoch
+  int64_t publish_time_ns;
+  /// \brief Bytes of image after the header
+  uint64_t image_bytes;
+  /// \brief Zero
+  uint8_t reserved[8];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(VideoFrameHeader) == 64, "VideoFrameHeader is part of the wire format");
+
+///
+/// \brief Check a received frame
+///
+/// \param data The payload
+/// \param size Payload bytes
+/// \return const VideoFrameHeader* The header, nullptr if the payload is not a whole frame of a known version
+///
+inline const VideoFrameHeader *ParseVideoFrame(const uint8_t *data, size_t size) {
+  if (!data || size < sizeof(VideoFrameHeader)) return nullptr;
+  const VideoFrameHeader *header = reinterpret_cast<const VideoFrameHeader *>(data);
+  if (header->magic != kVideoFrameMagic || header->version != kVideoFrameVersion) return nullptr;
+  if (header->header_bytes < sizeof(VideoFrameHeader) || header->header_bytes > size) return nullptr;
+  if (size - header->header_bytes < header->image_bytes) return nullptr;
+  return header;
+}
+
+#endif  // VIDEO_FRAME_H
@@ -0,0 +1,277 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Bridges SocketCAN interfaces and zenoh key expressions in both directions
+///
+/// \file main.cpp
+///
+
+#include <errno.h>
+#include <gflags/gflags.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zenoh/zenoh.hpp>
+
+#include "can_batch_publisher.h"
+#include "can_codec.h"
+#include "socket_can.h"
+
+DEFINE_string(interfaces, "vcan0", "Comma separated SocketCAN interfaces to bridge");
+DEFINE_string(rx_key, "can/{interface}/rx", "Frames read from the bus are published here");
+DEFINE_string(tx_key, "can/{interface}/tx", "Frames received here are written to the bus");
+DEFINE_string(direction, "both", "both, rx (bus to zenoh only) or tx (zenoh to bus only)");
+DEFINE_string(format, "protobuf", "Wire format published, protobuf or compact, both are accepted");
+DEFINE_string(filters, "", "Only forward these ids from the bus, comma separated id or id/mask, empty for all");
+DEFINE_bool(hardware_timestamps, true, "Use the adapter's receive timestamp where it has one");
+DEFINE_int32(batch_frames, 64, "Publish a batch when it has this many frames");
+DEFINE_int32(batch_us, 1000, "Publish a batch when its oldest frame has waited this many microseconds");
+DEFINE_int32(report, 5, "Seconds between statistics reports, 0 for none");
+
+static std::atomic<bool> running{true};
+
+static std::string expand(std::string key, const std::string &interface) {
+  const std::string field = "{interface}";
+  for (size_t at = key.find(field); at != std::string::npos; at = key.find(field, at + interface.size())) {
+    key.replace(at, field.size(), interface);
+  }
+  return key;
+}
+
+///
+/// \brief One interface: a thread reading the bus and publishing batches, and a subscriber writing to the bus
+///
+/// Two things stop frames going round in circles. The CAN socket never reads back what it wrote, so frames from
+/// zenoh are not published again. Every batch carries this bridge's origin as its attachment, and batches with our
+/// own origin are not written to the bus, so the rx and tx keys can overlap, for example to join several
+/// interfaces into one bus.
+///
+class Bridge {
+ public:
+  ///
+  /// \brief Open the interface and declare the publisher and subscriber
+  ///
+  /// \param session The zenoh session, which must outlive the bridge
+  /// \param interface The SocketCAN interface
+  ///
+  Bridge(zenoh::Session &session, const std::string &interface)
+      : can_(interface, FLAGS_batch_frames),
+        rx_key_(expand(FLAGS_rx_key, interface)),
+        tx_key_(expand(FLAGS_tx_key, interface)),
+        frames_(can_.Batch()) {
+    char host[64] = {};
+    gethostname(host, sizeof(host) - 1);
+    origin_ = std::string(host) + "/" + std::to_string(getpid()) + "/" + interface;
+
+    bool rx = FLAGS_direction != "tx";
+    bool tx = FLAGS_direction != "rx";
+    if (rx) {
+      if (!FLAGS_filters.empty() && !can_.SetFilters(ParseCanFilters(FLAGS_filters))) {
+        throw std::runtime_error("CAN filters refused on " + interface);
+      }
+      if (!can_.EnableTimestamps(FLAGS_hardware_timestamps)) {
+        std::cerr << interface << ": no kernel timestamps, frames are stamped when read\n";
+      }
+      publisher_ = std::make_unique<CanBatchPublisher>(session, rx_key_, FLAGS_batch_frames, FLAGS_batch_us,
+                                                       ParseCanWireFormat(FLAGS_format));
+      publisher_->SetOrigin(origin_);
+    } else {
+      // Nothing is read, so nothing should queue
+      can_.SetFilters({});
+    }
+    if (tx) {
+      subscriber_.emplace(session.declare_subscriber(
+          zenoh::KeyExpr(tx_key_), [this](const zenoh::Sample &sample) { Write(sample); }, zenoh::closures::none));
+    }
+
+    std::cout << interface << ":" << (rx ? " bus -> " + rx_key_ : "") << (tx ? " " + tx_key_ + " -> bus" : "")
+              << "\n";
+    thread_ = std::thread(&Bridge::Run, this);
+  }
+
+  ///
+  /// \brief Stop the thread, the subscriber is undeclared before the socket closes
+  ///
+  ///
+  ~Bridge() {
+    stopping_ = true;
+    if (thread_.joinable()) thread_.join();
+  }
+
+ private:
+  ///
+  /// \brief Bus to zenoh, and the statistics
+  ///
+  ///
+  void Run() {
+    int64_t report_start = MonotonicNs();
+    while (running && !stopping_) {
+      int64_t now = MonotonicNs();
+      int64_t deadline = publisher_ ? publisher_->Deadline() : 0;
+      int64_t timeout = deadline ? std::max<int64_t>(deadline - now, 0) : 100000000;
+
+      if (publisher_) {
+        int count = can_.Read(frames_.data(), timeout);
+        if (count < 0) {
+          std::cerr << can_.Interface() << ": read failed, " << strerror(errno) << "\n";
+          break;
+        }
+        for (int i = 0; i < count; i++) publisher_->Add(frames_[i]);
+        now = MonotonicNs();
+        publisher_->Poll(now);
+      } else {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(timeout));
+        now = MonotonicNs();
+      }
+
+      if (FLAGS_report && now - report_start >= FLAGS_report * 1000000000LL) {
+        Report((now - report_start) / 1e9);
+        report_start = now;
+      }
+    }
+    if (publisher_) publisher_->Flush();
+  }
+
+  ///
+  /// \brief Zenoh to bus, the subscriber callback
+  ///
+  /// \param sample A batch in either format
+  ///
+  void Write(const zenoh::Sample &sample) {
+    auto attachment = sample.get_attachment();
+    if (attachment && attachment->get().as_string() == origin_) {
+      looped_++;
+      return;
+    }
+
+    // Written straight from zenoh's buffer unless it arrived in fragments
+    const zenoh::Bytes &payload = sample.get_payload();
+    auto slices = payload.slice_iter();
+    std::optional<zenoh::Slice> first = slices.next();
+    const uint8_t *data = first ? first->data : nullptr;
+    size_t size = first ? first->len : 0;
+    if (first && slices.next()) {
+      joined_ = payload.as_vector();
+      data = joined_.data();
+      size = joined_.size();
+    }
+
+    CanWireFormat format = CanBatchDecoder::FormatOf(sample.get_encoding().as_string());
+    if (!decoder_.Decode(format, data, size, &batch_)) {
+      bad_++;
+      return;
+    }
+    int count = static_cast<int>(batch_.frames.size());
+    int written = can_.Write(batch_.frames.data(), count);
+    to_bus_ += written;
+    dropped_ += count - written;
+  }
+
+  ///
+  /// \brief Log both directions
+  ///
+  /// \param seconds Length of the period
+  ///
+  void Report(double seconds) {
+    std::string line = can_.Interface() + ":";
+    char text[256];
+    if (publisher_) {
+      CanPublishStats stats = publisher_->TakeStats();
+      snprintf(text, sizeof(text), " bus -> zenoh %.0f frames/s in %.0f batches/s, latency mean %.3f ms max %.3f ms,",
+               stats.frames / seconds, stats.batches / seconds,
+               stats.frames ? stats.latency_sum_ns / 1e6 / stats.frames : 0.0, stats.latency_max_ns / 1e6);
+      line += text;
+    }
+    snprintf(text, sizeof(text), " zenoh -> bus %.0f frames/s, %llu not written, %llu own batches ignored, %llu bad",
+             to_bus_.exchange(0) / seconds, static_cast<unsigned long long>(dropped_.exchange(0)),
+             static_cast<unsigned long long>(looped_.exchange(0)), static_cast<unsigned long long>(bad_.exchange(0)));
+    line += text;
+    if (can_.HardwareTimestamps()) line += ", hardware timestamps";
+    printf("%s\n", line.c_str());
+  }
+
+  /// \brief The CAN socket, read by the thread and written by the subscriber
+  SocketCan can_;
+  /// \brief Where bus frames are published
+  std::string rx_key_;
+  /// \brief Where frames for the bus come from
+  std::string tx_key_;
+  /// \brief Identifies this bridge's batches
+  std::string origin_;
+  /// \brief Read buffer
+  std::vector<CanFrame> frames_;
+  /// \brief Bus to zenoh, nullptr for tx only
+  std::unique_ptr<CanBatchPublisher> publisher_;
+  /// \brief Decodes batches for the bus
+  CanBatchDecoder decoder_;
+  /// \brief The last batch decoded
+  CanBatchView batch_;
+  /// \brief A fragmented payload, joined
+  std::vector<uint8_t> joined_;
+  /// \brief Frames written to the bus
+  std::atomic<uint64_t> to_bus_{0};
+  /// \brief Frames for the bus that could not be written
+  std::atomic<uint64_t> dropped_{0};
+  /// \brief Batches we published that came back
+  std::atomic<uint64_t> looped_{0};
+  /// \brief Samples that did not decode
+  std::atomic<uint64_t> bad_{0};
+  /// \brief Zenoh to bus, declared last so it is undeclared first
+  std::optional<zenoh::Subscriber<void>> subscriber_;
+  /// \brief Tells the thread to finish
+  std::atomic<bool> stopping_{false};
+  /// \brief Bus to zenoh
+  std::thread thread_;
+};
+
+int main(int argc, char *argv[]) {
+  gflags::SetUsageMessage("Bridge SocketCAN interfaces and zenoh in both directions");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::signal(SIGINT, [](int) { running = false; });
+  std::signal(SIGTERM, [](int) { running = false; });
+
+  if (FLAGS_direction != "both" && FLAGS_direction != "rx" && FLAGS_direction != "tx") {
+    std::cerr << "Unknown direction '" << FLAGS_direction << "', expected both, rx or tx\n";
+    return 1;
+  }
+
+  try {
+    zenoh::Session session = zenoh::Session::open(zenoh::Config::create_default());
+
+    std::vector<std::unique_ptr<Bridge>> bridges;
+    std::stringstream list(FLAGS_interfaces);
+    std::string interface;
+    while (std::getline(list, interface, ',')) {
+      if (!interface.empty()) bridges.push_back(std::make_unique<Bridge>(session, interface));
+    }
+    if (bridges.empty()) {
+      std::cerr << "No interfaces to bridge\n";
+      return 1;
+    }
+
+    while (running) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -6,55 +6,203 @@
 // Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
 // License. See the LICENSE file in the project root for full license details.
 //
+/// \brief Reads frames from a SocketCAN interface and publishes them to zenoh in batches
+///
+/// \file main.cpp
+///
 
+#include <errno.h>
+#include <gflags/gflags.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <iostream>
-#include <chrono>
+#include <string>
+#include <vector>
 #include <zenoh/zenoh.hpp>
-#include "common_can.pb.h" // Generated Protobuf header
-
-int main()
-{
-    try
-    {
-        // Initialize Zenoh
-        zenoh::Config config;
-        auto session = zenoh::open(config);
-
-        // Create a Protobuf CAN message
-        CANMessage can_message;
-        can_message.set_id(0x123);
-
-        // Add multiple bytes to the repeated field
-        for (int i = 0; i < 8; ++i)
-        {
-            can_message.add_data(0xFF);
-        }
-        can_message.mutable_data()->Set(7, 0xFC); // Set the last byte to 0xFC
-        can_message.set_is_extended_id(false);
-
-        // Add UTC timestamp in milliseconds since Unix epoch
-        auto now = std::chrono::system_clock::now();
-        auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-        can_message.set_timestamp(timestamp);
-
-        // Serialize the message to bytes
-        std::string serialized_message;
-        if (!can_message.SerializeToString(&serialized_message))
-        {
-            std::cerr << "Failed to serialize CAN message." << std::endl;
-            return 1;
-        }
-
-        // Publish the message
-        session.put("can0/tx/raw", serialized_message);
-
-        std::cout << "Message published successfully." << std::endl;
+
+#include "can_batch_publisher.h"
+#include "can_codec.h"
+#include "frame_generator.h"
+#include "socket_can.h"
+
+DEFINE_string(interface, "vcan0", "The SocketCAN interface to read");
+DEFINE_string(key, "can0/tx/batch", "The zenoh key expression to publish batches on");
+DEFINE_int32(batch_frames, 64, "Publish a batch when it has this many frames");
+DEFINE_int32(batch_us, 1000, "Publish a batch when its oldest frame has waited this many microseconds");
+DEFINE_string(format, "protobuf", "Wire format, protobuf (CANBatch) or compact (fixed layout, no parsing)");
+DEFINE_int32(report, 5, "Seconds between statistics reports, 0 for none");
+DEFINE_int32(benchmark_seconds, 0, "Publish generated frames for this long instead of reading the bus, then exit");
+DEFINE_int32(benchmark_rate, 0, "Generated frames per second, 0 for as fast as possible");
+DEFINE_bool(codec_benchmark, false, "Compare the size and encode and decode time of the wire formats, then exit");
+
+static std::atomic<bool> running{true};
+
+static void report(const CanPublishStats &stats, double seconds) {
+  if (stats.frames == 0) {
+    printf("No frames in %.1f s\n", seconds);
+    return;
+  }
+  printf(
+      "%.0f frames/s in %.0f batches/s, %.1f frames and %.1f bytes/frame, publish %.1f us/batch, read to put latency "
+      "mean %.3f ms max %.3f ms\n",
+      stats.frames / seconds, stats.batches / seconds, static_cast<double>(stats.frames) / stats.batches,
+      static_cast<double>(stats.bytes) / stats.frames, stats.publish_ns / 1e3 / stats.batches,
+      stats.latency_sum_ns / 1e6 / stats.frames, stats.latency_max_ns / 1e6);
+}
+
+static void accumulate(CanPublishStats *total, const CanPublishStats &stats) {
+  total->frames += stats.frames;
+  total->batches += stats.batches;
+  total->bytes += stats.bytes;
+  total->publish_ns += stats.publish_ns;
+  total->latency_sum_ns += stats.latency_sum_ns;
+  total->latency_max_ns = std::max(total->latency_max_ns, stats.latency_max_ns);
+}
+
+// Generated frames at a fixed rate or flat out
+static int benchmark(CanBatchPublisher *publisher) {
+  printf("Benchmark: %d s of generated frames at %s, batches of %d frames or %d us\n", FLAGS_benchmark_seconds,
+         FLAGS_benchmark_rate ? (std::to_string(FLAGS_benchmark_rate) + " frames/s").c_str() : "full rate",
+         FLAGS_batch_frames, FLAGS_batch_us);
+
+  FrameGenerator generator(FLAGS_benchmark_rate);
+  CanFrame frame;
+  CanPublishStats total;
+  int64_t start = MonotonicNs();
+  int64_t end = start + FLAGS_benchmark_seconds * 1000000000LL;
+  int64_t report_start = start;
+
+  for (int64_t now = start; now < end && running; now = MonotonicNs()) {
+    int64_t due = generator.Due();
+    if (due > now) {
+      // Sleep no later than the batch deadline, so the time window still applies
+      int64_t deadline = publisher->Deadline();
+      if (deadline && deadline < due) due = deadline;
+      struct timespec wake = {static_cast<time_t>(due / 1000000000), static_cast<long>(due % 1000000000)};
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr);
+      publisher->Poll(MonotonicNs());
+      continue;
     }
-    catch (const std::exception &e)
-    {
-        std::cerr << "Error: " << e.what() << std::endl;
+
+    generator.Next(&frame);
+    publisher->Add(frame);
+    publisher->Poll(now);
+
+    if (FLAGS_report && now - report_start >= FLAGS_report * 1000000000LL) {
+      CanPublishStats stats = publisher->TakeStats();
+      accumulate(&total, stats);
+      report(stats, (now - report_start) / 1e9);
+      report_start = now;
+    }
+  }
+  publisher->Flush();
+  accumulate(&total, publisher->TakeStats());
+
+  printf("Total: ");
+  report(total, (MonotonicNs() - start) / 1e9);
+  return 0;
+}
+
+// Both wire formats over the same generated batches, no zenoh involved
+static int codec_benchmark() {
+  constexpr int kFrames = 1000000;
+  int batches = std::max(kFrames / std::max(FLAGS_batch_frames, 1), 1);
+  printf("Codec benchmark: %d batches of %d classic 8 byte frames\n", batches, FLAGS_batch_frames);
+
+  for (CanWireFormat format : {CanWireFormat::kProtobuf, CanWireFormat::kCompact}) {
+    CanBatchEncoder encoder(format, FLAGS_batch_frames);
+    CanBatchDecoder decoder;
+    CanBatchView view;
+    FrameGenerator generator(0);
+    std::vector<uint8_t> buffer;
+    std::vector<CanFrame> input(FLAGS_batch_frames);
+    uint64_t frames = 0, bytes = 0, checksum = 0;
+    int64_t encode_ns = 0, decode_ns = 0;
+
+    for (int batch = 0; batch < batches; batch++) {
+      for (CanFrame &frame : input) generator.Next(&frame);
+      int64_t start = MonotonicNs();
+      for (const CanFrame &frame : input) encoder.Add(frame);
+      size_t size = encoder.Finish(batch, RealtimeNs());
+      if (buffer.size() < size) buffer.resize(size);
+      encoder.SerializeTo(buffer.data());
+      encoder.Clear();
+      int64_t encoded = MonotonicNs();
+
+      // Touch every data byte, as a consumer would
+      if (!decoder.Decode(format, buffer.data(), size, &view)) {
+        std::cerr << "Decode failed\n";
         return 1;
+      }
+      for (const CanFrameView &decoded : view.frames) {
+        for (int i = 0; i < decoded.len; i++) checksum += decoded.data[i];
+      }
+      decode_ns += MonotonicNs() - encoded;
+      encode_ns += encoded - start;
+      frames += view.frames.size();
+      bytes += size;
+    }
+
+    printf("%-8s %.1f bytes/frame, encode %.1f ns/frame, decode %.1f ns/frame (checksum %llu)\n",
+           format == CanWireFormat::kCompact ? "compact" : "protobuf", static_cast<double>(bytes) / frames,
+           static_cast<double>(encode_ns) / frames, static_cast<double>(decode_ns) / frames,
+           static_cast<unsigned long long>(checksum));
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  gflags::SetUsageMessage("Publish SocketCAN frames to zenoh in batches");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::signal(SIGINT, [](int) { running = false; });
+  std::signal(SIGTERM, [](int) { running = false; });
+
+  if (FLAGS_codec_benchmark) return codec_benchmark();
+
+  try {
+    zenoh::Session session = zenoh::Session::open(zenoh::Config::create_default());
+    // Declared once, so each batch is a put on an existing publisher rather than a key lookup
+    CanBatchPublisher publisher(session, FLAGS_key, FLAGS_batch_frames, FLAGS_batch_us,
+                                ParseCanWireFormat(FLAGS_format));
+
+    if (FLAGS_benchmark_seconds > 0) return benchmark(&publisher);
+
+    SocketCan can(FLAGS_interface);
+    std::vector<CanFrame> frames(can.Batch());
+    std::cout << "Publishing " << FLAGS_interface << " to " << FLAGS_key << " as " << FLAGS_format << ", batches of "
+              << FLAGS_batch_frames << " frames or " << FLAGS_batch_us << " us\n";
+
+    int64_t report_start = MonotonicNs();
+    while (running) {
+      // Wake for the batch window, or regularly to check for shutdown and report
+      int64_t now = MonotonicNs();
+      int64_t deadline = publisher.Deadline();
+      int64_t timeout = deadline ? std::max<int64_t>(deadline - now, 0) : 100000000;
+
+      int count = can.Read(frames.data(), timeout);
+      if (count < 0) {
+        std::cerr << "CAN read from " << FLAGS_interface << " failed: " << strerror(errno) << "\n";
+        break;
+      }
+      for (int i = 0; i < count; i++) publisher.Add(frames[i]);
+
+      now = MonotonicNs();
+      publisher.Poll(now);
+      if (FLAGS_report && now - report_start >= FLAGS_report * 1000000000LL) {
+        report(publisher.TakeStats(), (now - report_start) / 1e9);
+        report_start = now;
+      }
     }
+    publisher.Flush();
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
 
-    return 0;
-}
\ No newline at end of file
+  return 0;
+}
@@ -6,55 +6,257 @@
 // Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
 // License. See the LICENSE file in the project root for full license details.
 //
+/// \brief Receives batches of CAN frames from zenoh, in either wire format, and prints them
+///
+/// \file main.cpp
+///
 
+#include <gflags/gflags.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <ctime>
+#include <csignal>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 #include <zenoh/zenoh.hpp>
 
-#include "common_can.pb.h"  // Generated Protobuf header
+#include "async_logger.h"
+#include "can_batch_publisher.h"
+#include "can_codec.h"
+#include "frame_generator.h"
+
+DEFINE_string(key, "can0/tx/batch", "The zenoh key expression to subscribe to");
+DEFINE_int32(log_rate, 20, "Most frames printed per second, 0 to print none");
+DEFINE_int32(report, 5, "Seconds between statistics reports, 0 for none");
+DEFINE_int32(benchmark_seconds, 0, "Publish generated frames from this process for this long, measure them, then exit");
+DEFINE_int32(benchmark_rate, 0, "Generated frames per second, 0 for as fast as possible");
+DEFINE_int32(batch_frames, 64, "Frames per batch from the benchmark publisher");
+DEFINE_int32(batch_us, 1000, "Batch window of the benchmark publisher in microseconds");
+DEFINE_string(format, "protobuf", "Wire format of the benchmark publisher, protobuf or compact");
+
+static std::atomic<bool> running{true};
+
+///
+/// \brief Counters written by the subscriber callback and read by the main thread
+///
+///
+struct ReceiveStats {
+  /// \brief Frames received
+  std::atomic<uint64_t> frames{0};
+  /// \brief Batches received
+  std::atomic<uint64_t> batches{0};
+  /// \brief Batches missing from the sequence
+  std::atomic<uint64_t> lost{0};
+  /// \brief Samples that did not parse
+  std::atomic<uint64_t> errors{0};
+  /// \brief Batches that parsed but held no frames
+  std::atomic<uint64_t> empty{0};
+  /// \brief Batches with a publish time, lone messages have none
+  std::atomic<uint64_t> timed{0};
+  /// \brief Time spent in the callback
+  std::atomic<int64_t> callback_ns{0};
+  /// \brief Sum over batches of publish to receive time
+  std::atomic<int64_t> latency_sum_ns{0};
+  /// \brief The longest publish to receive time
+  std::atomic<int64_t> latency_max_ns{0};
+};
+
+///
+/// \brief Decodes each sample by its encoding, protobuf or compact, and logs the frames
+///
+/// A sample without a batch encoding is taken to be a lone can::CANMessage, as the Python and Rust examples publish,
+/// and handled as a batch of one. Callbacks for one subscriber are not run concurrently, so the decoder and sequence
+/// need no lock.
+///
+class BatchReceiver {
+ public:
+  ///
+  /// \brief Construct a new Batch Receiver object
+  ///
+  /// \param logger Prints the frames, rate limited
+  /// \param stats Updated for every sample
+  ///
+  BatchReceiver(AsyncLogger *logger, ReceiveStats *stats) : logger_(logger), stats_(stats) {}
+
+  ///
+  /// \brief The subscriber callback
+  ///
+  /// \param sample The zenoh sample, a serialised batch
+  ///
+  void Receive(const zenoh::Sample &sample) {
+    int64_t start = MonotonicNs();
+    int64_t now = RealtimeNs();
+
+    // Decode straight from zenoh's buffer, only a payload that arrived in fragments is joined into one first
+    const zenoh::Bytes &payload = sample.get_payload();
+    auto slices = payload.slice_iter();
+    std::optional<zenoh::Slice> first = slices.next();
+    const uint8_t *data = first ? first->data : nullptr;
+    size_t size = first ? first->len : 0;
+    if (first && slices.next()) {
+      joined_ = payload.as_vector();
+      data = joined_.data();
+      size = joined_.size();
+    }
+
+    CanWireFormat format = CanBatchDecoder::FormatOf(sample.get_encoding().as_string());
+    if (!decoder_.Decode(format, data, size, &batch_)) {
+      stats_->errors++;
+      return;
+    }
+
+    if (batch_.frames.empty()) stats_->empty++;
+    if (batch_.sequence > next_sequence_ && next_sequence_) stats_->lost += batch_.sequence - next_sequence_;
+    if (batch_.sequence) next_sequence_ = batch_.sequence + 1;
+    for (const CanFrameView &frame : batch_.frames) {
+      if (logger_->Admit()) logger_->Log(Format(frame));
+    }
+
+    stats_->frames += batch_.frames.size();
+    stats_->batches++;
+    if (batch_.publish_time_ns) {
+      int64_t latency = now - batch_.publish_time_ns;
+      stats_->timed++;
+      stats_->latency_sum_ns += latency;
+      if (latency > stats_->latency_max_ns) stats_->latency_max_ns = latency;
+    }
+    stats_->callback_ns += MonotonicNs() - start;
+  }
 
-void callback(const zenoh::Sample &sample) {
-  // Deserialize the message
-  CANMessage can_message;
-  if (!can_message.ParseFromArray(sample.payload.data(), sample.payload.size())) {
-    std::cerr << "Failed to parse CAN message." << std::endl;
-    return;
+ private:
+  ///
+  /// \brief One line per frame, for example "12:00:01.250  123  [8] 01 02 03 04 05 06 07 08"
+  ///
+  /// \param frame The frame
+  /// \return std::string The line
+  ///
+  static std::string Format(const CanFrameView &frame) {
+    time_t seconds = static_cast<time_t>(frame.timestamp_ns / 1000000000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char line[256];
+    int length = strftime(line, sizeof(line), "%H:%M:%S", &tm);
+    unsigned milliseconds = static_cast<unsigned>(frame.timestamp_ns / 1000000 % 1000);
+    length += snprintf(line + length, sizeof(line) - length, ".%03u  %0*X  [%u]", milliseconds,
+                       (frame.flags & kCanExtended) ? 8 : 3, frame.id, frame.len);
+    for (int i = 0; i < frame.len; i++) {
+      length += snprintf(line + length, sizeof(line) - length, " %02X", frame.data[i]);
+    }
+    return std::string(line, length);
   }
 
-  // Print the message details
-  std::cout << "\n==================== Received CAN Message ====================" << std::endl;
-  std::cout << "ID:              0x" << std::hex << can_message.id() << std::dec << std::endl;
-  std::cout << "Data:            [";
-  for (int i = 0; i < can_message.data_size(); ++i) {
-    std::cout << "0x" << std::hex << static_cast<int>(can_message.data(i)) << std::dec;
-    if (i < can_message.data_size() - 1) std::cout << ", ";
+  /// \brief Prints the frames
+  AsyncLogger *logger_;
+  /// \brief Updated for every sample
+  ReceiveStats *stats_;
+  /// \brief Decodes either format
+  CanBatchDecoder decoder_;
+  /// \brief The last batch decoded, reused so its frame vector does not reallocate
+  CanBatchView batch_;
+  /// \brief A fragmented payload, joined
+  std::vector<uint8_t> joined_;
+  /// \brief The sequence number expected next, 0 before the first batch
+  uint64_t next_sequence_ = 0;
+};
+
+// Logs the statistics, resetting them, and returns the frames counted
+static uint64_t report(ReceiveStats *stats, double seconds) {
+  uint64_t frames = stats->frames.exchange(0);
+  uint64_t batches = stats->batches.exchange(0);
+  uint64_t lost = stats->lost.exchange(0);
+  uint64_t errors = stats->errors.exchange(0);
+  uint64_t empty = stats->empty.exchange(0);
+  uint64_t timed = stats->timed.exchange(0);
+  int64_t callback_ns = stats->callback_ns.exchange(0);
+  int64_t latency_sum_ns = stats->latency_sum_ns.exchange(0);
+  int64_t latency_max_ns = stats->latency_max_ns.exchange(0);
+  if (batches == 0) {
+    printf("No batches in %.1f s, %llu bad\n", seconds, static_cast<unsigned long long>(errors));
+    return 0;
+  }
+  printf("%.0f msgs/s in %.0f batches/s, %llu batches lost, %llu bad, %llu empty, callback %.2f us/batch",
+         frames / seconds, batches / seconds, static_cast<unsigned long long>(lost),
+         static_cast<unsigned long long>(errors), static_cast<unsigned long long>(empty), callback_ns / 1e3 / batches);
+  if (timed) {
+    printf(", publish to receive latency mean %.3f ms max %.3f ms", latency_sum_ns / 1e6 / timed, latency_max_ns / 1e6);
   }
-  std::cout << "]" << std::endl;
-  std::cout << "Is Extended ID:  " << (can_message.is_extended_id() ? "true" : "false") << std::endl;
-
-  // Convert timestamp to human-readable format
-  auto timestamp_ms = can_message.timestamp();
-  std::time_t timestamp_s = timestamp_ms / 1000;
-  std::tm *tm = std::gmtime(&timestamp_s);
-  char time_buffer[100];
-  std::strftime(time_buffer, sizeof(time_buffer), "%Y-%m-%d %H:%M:%S", tm);
-  std::cout << "Timestamp:       " << time_buffer << "." << (timestamp_ms % 1000) << " UTC" << std::endl;
+  printf("\n");
+  return frames;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  gflags::SetUsageMessage("Receive batches of CAN frames from zenoh");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::signal(SIGINT, [](int) { running = false; });
+  std::signal(SIGTERM, [](int) { running = false; });
+
   try {
-    // Initialize Zenoh
-    zenoh::Config config;
-    auto session = zenoh::open(config);
+    zenoh::Session session = zenoh::Session::open(zenoh::Config::create_default());
+
+    AsyncLogger logger(FLAGS_log_rate);
+    ReceiveStats stats;
+    BatchReceiver receiver(&logger, &stats);
+    zenoh::Subscriber<void> subscriber = session.declare_subscriber(
+        zenoh::KeyExpr(FLAGS_key), [&receiver](const zenoh::Sample &sample) { receiver.Receive(sample); },
+        zenoh::closures::none);
+    std::cout << "Subscribed to " << FLAGS_key << std::endl;
+
+    // The whole path in one process: generate, batch, serialise, put, receive, parse and log
+    std::thread generator;
+    std::atomic<uint64_t> sent{0};
+    if (FLAGS_benchmark_seconds > 0) {
+      CanWireFormat format = ParseCanWireFormat(FLAGS_format);
+      generator = std::thread([&session, &sent, format] {
+        CanBatchPublisher publisher(session, FLAGS_key, FLAGS_batch_frames, FLAGS_batch_us, format);
+        FrameGenerator frames(FLAGS_benchmark_rate);
+        CanFrame frame;
+        int64_t end = MonotonicNs() + FLAGS_benchmark_seconds * 1000000000LL;
+        for (int64_t now = MonotonicNs(); now < end && running; now = MonotonicNs()) {
+          int64_t due = frames.Due();
+          if (due > now) {
+            // Wake for the batch window if it closes first
+            int64_t deadline = publisher.Deadline();
+            if (deadline && deadline < due) due = deadline;
+            struct timespec wake = {static_cast<time_t>(due / 1000000000), static_cast<long>(due % 1000000000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr);
+          } else {
+            frames.Next(&frame);
+            publisher.Add(frame);
+          }
+          publisher.Poll(MonotonicNs());
+        }
+        publisher.Flush();
+        sent = frames.Count();
+      });
+    }
 
-    // Subscribe to the topic "can0/tx/raw"
-    session.declare_subscriber("can0/tx/raw", callback);
-    std::cout << "Subscriber is ready. Waiting for messages..." << std::endl;
+    int64_t start = MonotonicNs();
+    int64_t report_start = start;
+    uint64_t total_frames = 0;
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      int64_t now = MonotonicNs();
+      // Give the last batches a moment to arrive
+      if (FLAGS_benchmark_seconds > 0 && now - start >= (FLAGS_benchmark_seconds + 1) * 1000000000LL) break;
+      if (FLAGS_report && now - report_start >= FLAGS_report * 1000000000LL) {
+        total_frames += report(&stats, (now - report_start) / 1e9);
+        report_start = now;
+      }
+    }
 
-    // Keep the subscriber alive
-    while (true) {
-      std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (generator.joinable()) {
+      generator.join();
+      total_frames += report(&stats, (MonotonicNs() - report_start) / 1e9);
+      printf("Benchmark: %llu frames sent, %llu received, %.0f msgs/s over %d s\n",
+             static_cast<unsigned long long>(sent.load()), static_cast<unsigned long long>(total_frames),
+             total_frames / static_cast<double>(FLAGS_benchmark_seconds), FLAGS_benchmark_seconds);
     }
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -62,4 +264,4 @@ int main() {
   }
 
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2025, Astute Systems PTY LTD
+//
+// This file is part of the VivoeX project developed by Astute Systems.
+//
+// Licensed under the Attribution-NonCommercial 4.0 International (CC BY-NC 4.0)
+// License. See the LICENSE file in the project root for full license details.
+//
+/// \brief Receives video frames from zenoh, reading those from local publishers in shared memory
+///
+/// \file main.cpp
+///
+
+#include <gflags/gflags.h>
+#include <linux/videodev2.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zenoh/zenoh.hpp>
+
+#include "shm_frame_publisher.h"
+#include "video_frame.h"
+
+DEFINE_string(key, "video/0/raw", "The zenoh key expression to subscribe to");
+DEFINE_bool(checksum, true, "Read every byte of each frame, as a consumer would, rather than only the header");
+DEFINE_int32(report, 5, "Seconds between statistics reports, 0 for none");
+DEFINE_int32(benchmark_seconds, 0, "Publish generated frames from a second process for this long, then exit");
+DEFINE_int32(benchmark_fps, 0, "Generated frames per second, 0 for as fast as the subscriber frees them");
+DEFINE_int32(benchmark_width, 720, "Width of the generated YUYV frames");
+DEFINE_int32(benchmark_height, 576, "Height of the generated YUYV frames");
+DEFINE_bool(shm, true, "The benchmark publisher puts frames in shared memory, false to compare with copying");
+DEFINE_int32(shm_mb, 32, "Shared memory pool of the benchmark publisher in megabytes");
+
+static std::atomic<bool> running{true};
+
+static int64_t clock_ns(clockid_t clock) {
+  struct timespec now;
+  clock_gettime(clock, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+///
+/// \brief Counters written by the subscriber callback and read by the main thread
+///
+///
+struct VideoReceiveStats {
+  /// \brief Frames received
+  std::atomic<uint64_t> frames{0};
+  /// \brief Bytes received, headers and images
+  std::atomic<uint64_t> bytes{0};
+  /// \brief Frames missing from the sequence
+  std::atomic<uint64_t> lost{0};
+  /// \brief Frames that arrived in pieces and were joined, never the case for shared memory
+  std::atomic<uint64_t> joined{0};
+  /// \brief Samples that were not frames
+  std::atomic<uint64_t> errors{0};
+  /// \brief Time spent in the callback
+  std::atomic<int64_t> callback_ns{0};
+  /// \brief Sum over frames of publish to receive time
+  std::atomic<int64_t> latency_sum_ns{0};
+  /// \brief The longest publish to receive time
+  std::atomic<int64_t> latency_max_ns{0};
+};
+
+///
+/// \brief Checks each frame where zenoh left it, in the publisher's shared memory for a local publisher
+///
+/// Callbacks for one subscriber are not run concurrently, so the sequence needs no lock.
+///
+class FrameReceiver {
+ public:
+  ///
+  /// \brief Construct a new Frame Receiver object
+  ///
+  /// \param stats Updated for every sample
+  ///
+  explicit FrameReceiver(VideoReceiveStats *stats) : stats_(stats) {}
+
+  ///
+  /// \brief The subscriber callback
+  ///
+  /// \param sample The zenoh sample, a VideoFrameHeader and the image
+  ///
+  void Receive(const zenoh::Sample &sample) {
+    int64_t start = clock_ns(CLOCK_MONOTONIC);
+    int64_t now = clock_ns(CLOCK_REALTIME);
+
+    // A frame in shared memory is one slice, a frame from another host may be in several
+    const zenoh::Bytes &payload = sample.get_payload();
+    auto slices = payload.slice_iter();
+    std::optional<zenoh::Slice> first = slices.next();
+    const uint8_t *data = first ? first->data : nullptr;
+    size_t size = first ? first->len : 0;
+    if (first && slices.next()) {
+      joined_ = payload.as_vector();
+      data = joined_.data();
+      size = joined_.size();
+      stats_->joined++;
+    }
+
+    const VideoFrameHeader *header = ParseVideoFrame(data, size);
+    if (!header) {
+      stats_->errors++;
+      return;
+    }
+    if (received_ && header->sequence != next_sequence_) stats_->lost += header->sequence - next_sequence_;
+    next_sequence_ = header->sequence + 1;
+    received_ = true;
+
+    if (FLAGS_checksum) checksum_ += Checksum(data + header->header_bytes, header->image_bytes);
+
+    int64_t latency = now - header->publish_time_ns;
+    stats_->frames++;
+    stats_->bytes += size;
+    stats_->latency_sum_ns += latency;
+    if (latency > stats_->latency_max_ns) stats_->latency_max_ns = latency;
+    stats_->callback_ns += clock_ns(CLOCK_MONOTONIC) - start;
+  }
+
+  ///
+  /// \brief Sum of every frame read, so the reads cannot be optimised away
+  ///
+  /// \return uint64_t The checksum
+  ///
+  uint64_t Checksum() const { return checksum_; }
+
+ private:
+  // Reads the image eight bytes at a time, roughly what converting or analysing it would cost in memory traffic
+  static uint64_t Checksum(const uint8_t *image, size_t bytes) {
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+      uint64_t word;
+      memcpy(&word, image + i, sizeof(word));
+      sum += word;
+    }
+    for (; i < bytes; i++) sum += image[i];
+    return sum;
+  }
+
+  /// \brief Updated for every sample
+  VideoReceiveStats *stats_;
+  /// \brief A fragmented payload, joined
+  std::vector<uint8_t> joined_;
+  /// \brief A frame has been received
+  bool received_ = false;
+  /// \brief The sequence number expected next
+  uint32_t next_sequence_ = 0;
+  /// \brief Sum of every frame read
+  std::atomic<uint64_t> checksum_{0};
+};
+
+// Logs the statistics, resetting them, and returns the bytes counted
+static uint64_t report(VideoReceiveStats *stats, double seconds) {
+  uint64_t frames = stats->frames.exchange(0);
+  uint64_t bytes = stats->bytes.exchange(0);
+  uint64_t lost = stats->lost.exchange(0);
+  uint64_t joined = stats->joined.exchange(0);
+  uint64_t errors = stats->errors.exchange(0);
+  int64_t callback_ns = stats->callback_ns.exchange(0);
+  int64_t latency_sum_ns = stats->latency_sum_ns.exchange(0);
+  int64_t latency_max_ns = stats->latency_max_ns.exchange(0);
+  if (frames == 0) {
+    printf("No frames in %.1f s\n", seconds);
+    return 0;
+  }
+  printf(
+      "%.1f frames/s, %.3f GB/s, %llu lost, %llu joined, %llu bad, callback %.1f us/frame, publish to receive "
+      "latency mean %.3f ms max %.3f ms\n",
+      frames / seconds, bytes / seconds / 1e9, static_cast<unsigned long long>(lost),
+      static_cast<unsigned long long>(joined), static_cast<unsigned long long>(errors), callback_ns / 1e3 / frames,
+      latency_sum_ns / 1e6 / frames, latency_max_ns / 1e6);
+  return bytes;
+}
+
+// The benchmark publisher, run in a child process so the frames cross between processes as they would from capture
+static int benchmark_publisher() {
+  zenoh::Session session = zenoh::Session::open(VideoSessionConfig());
+  ShmFramePublisher publisher(session, FLAGS_key, static_cast<size_t>(FLAGS_shm_mb) << 20, FLAGS_shm);
+  // Let the sessions find each other before the clock starts
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  VideoFrameHeader header = {};
+  header.width = FLAGS_benchmark_width;
+  header.height = FLAGS_benchmark_height;
+  header.stride = FLAGS_benchmark_width * 2;
+  header.fourcc = V4L2_PIX_FMT_YUYV;
+  header.field = V4L2_FIELD_ANY;
+  header.image_bytes = static_cast<uint64_t>(header.stride) * header.height;
+  // Copied into every frame, as the capture copies from the driver's buffer
+  std::vector<uint8_t> image(header.image_bytes);
+  for (size_t i = 0; i < image.size(); i++) image[i] = static_cast<uint8_t>(i * 7);
+
+  int64_t interval = FLAGS_benchmark_fps > 0 ? 1000000000LL / FLAGS_benchmark_fps : 0;
+  int64_t start = clock_ns(CLOCK_MONOTONIC);
+  int64_t end = start + FLAGS_benchmark_seconds * 1000000000LL;
+  int64_t due = start;
+  uint64_t sent = 0;
+  for (int64_t now = start; now < end && running; now = clock_ns(CLOCK_MONOTONIC)) {
+    if (interval) {
+      struct timespec wake = {static_cast<time_t>(due / 1000000000), static_cast<long>(due % 1000000000)};
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr);
+      due += interval;
+    }
+    header.sequence = static_cast<uint32_t>(sent);
+    header.capture_ns = clock_ns(CLOCK_MONOTONIC);
+    // Waiting for a free chunk is the backpressure, nothing is dropped
+    if (publisher.Publish(header, image.data(), true)) sent++;
+  }
+
+  double seconds = (clock_ns(CLOCK_MONOTONIC) - start) / 1e9;
+  VideoPublishStats stats = publisher.TakeStats();
+  printf("Published %llu frames of %llu bytes through %s, %.3f GB/s, %.1f us/frame to copy and put\n",
+         static_cast<unsigned long long>(sent), static_cast<unsigned long long>(header.image_bytes),
+         publisher.Shm() ? "shared memory" : "the network stack", stats.bytes / seconds / 1e9,
+         stats.frames ? stats.publish_ns / 1e3 / stats.frames : 0.0);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  gflags::SetUsageMessage("Receive video frames from zenoh");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::signal(SIGINT, [](int) { running = false; });
+  std::signal(SIGTERM, [](int) { running = false; });
+
+  // Forked before either process opens a session, zenoh's threads do not survive a fork
+  pid_t child = -1;
+  if (FLAGS_benchmark_seconds > 0) {
+    child = fork();
+    if (child < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (child == 0) {
+      try {
+        return benchmark_publisher();
+      } catch (const std::exception &e) {
+        std::cerr << "Publisher error: " << e.what() << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  try {
+    zenoh::Session session = zenoh::Session::open(VideoSessionConfig());
+
+    VideoReceiveStats stats;
+    FrameReceiver receiver(&stats);
+    zenoh::Subscriber<void> subscriber = session.declare_subscriber(
+        zenoh::KeyExpr(FLAGS_key), [&receiver](const zenoh::Sample &sample) { receiver.Receive(sample); },
+        zenoh::closures::none);
+    std::cout << "Subscribed to " << FLAGS_key << std::endl;
+
+    int64_t start = clock_ns(CLOCK_MONOTONIC);
+    int64_t report_start = start;
+    uint64_t total_bytes = 0;
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      int64_t now = clock_ns(CLOCK_MONOTONIC);
+      if (child > 0 && waitpid(child, nullptr, WNOHANG) == child) {
+        child = 0;
+        break;
+      }
+      if (FLAGS_report && now - report_start >= FLAGS_report * 1000000000LL) {
+        total_bytes += report(&stats, (now - report_start) / 1e9);
+        report_start = now;
+      }
+    }
+
+    if (FLAGS_benchmark_seconds > 0) {
+      total_bytes += report(&stats, (clock_ns(CLOCK_MONOTONIC) - report_start) / 1e9);
+      printf("Benchmark: %.3f GB/s received over %d s, checksum %016llx\n",
+             total_bytes / 1e9 / FLAGS_benchmark_seconds, FLAGS_benchmark_seconds,
+             static_cast<unsigned long long>(receiver.Checksum()));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (child > 0) {
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+  }
+  return 0;
+}
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Receive frames from one or more shared memory rings and show the first.
+
+Start a capture per channel first, for example:
+    capture_cpp -device=/dev/video0 -display=false -shm_ring=/gxa-video0
+then:
+    ./ring_receiver.py /gxa-video0 /gxa-video1 ...
+"""
+
+import argparse
+import threading
+import time
+
+import numpy as np
+
+from shm_ring import RingClosed, ShmRingReader
+
+# V4L2_PIX_FMT_UYVY, anything else is taken to be YUYV
+UYVY = 0x59565955
+
+
+def follow(name, counts, latest):
+    """Read one ring for ever, reopening it when the capture restarts."""
+    while True:
+        try:
+            with ShmRingReader(name) as reader:
+                while True:
+                    frame = reader.next(1000)
+                    if frame is None:
+                        continue
+                    counts[name] = (counts[name][0] + 1, reader.lost)
+                    if name in latest:
+                        # Converted straight from the shared memory, then checked it was not overwritten meanwhile
+                        image = to_bgr(frame)
+                        if reader.valid(frame):
+                            latest[name] = image
+        except (RingClosed, FileNotFoundError):
+            time.sleep(1)
+
+
+def to_bgr(frame):
+    """A BGR copy of a YUYV or UYVY frame, for display."""
+    import cv2
+
+    lines = np.frombuffer(frame.image, dtype=np.uint8).reshape(frame.height, frame.stride)
+    pixels = lines[:, : frame.width * 2].reshape(frame.height, frame.width, 2)
+    code = cv2.COLOR_YUV2BGR_UYVY if frame.fourcc == UYVY else cv2.COLOR_YUV2BGR_YUYV
+    return cv2.cvtColor(pixels, code)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("rings", nargs="*", default=["/gxa-video0"], help="shared memory ring names")
+    parser.add_argument("--no-display", action="store_true", help="only count the frames")
+    args = parser.parse_args()
+
+    counts = {name: (0, 0) for name in args.rings}
+    latest = {} if args.no_display else {args.rings[0]: None}
+    for name in args.rings:
+        threading.Thread(target=follow, args=(name, counts, latest), daemon=True).start()
+
+    last = time.monotonic()
+    previous = dict(counts)
+    try:
+        while True:
+            if latest and latest[args.rings[0]] is not None:
+                import cv2
+
+                cv2.imshow(args.rings[0], latest[args.rings[0]])
+                if cv2.waitKey(10) & 0xFF == ord("q"):
+                    break
+            else:
+                time.sleep(0.01)
+            now = time.monotonic()
+            if now - last >= 5:
+                for name in args.rings:
+                    frames, lost = counts[name]
+                    print("%s: %.1f fps, %d lost" % (name, (frames - previous[name][0]) / (now - last), lost))
+                previous = dict(counts)
+                last = now
+    except KeyboardInterrupt:
+        pass
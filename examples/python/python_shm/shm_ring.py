@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Read video frames from a shared memory ring written by capture_cpp -shm_ring.
+
+The ring is read through libshm_ring.so, built with the C++ examples. Frames are
+not copied: each image is a memoryview of the shared memory, valid until the
+writer comes round the ring again, so check valid() after using it in place.
+"""
+
+import ctypes
+import ctypes.util
+import os
+
+
+class Frame(ctypes.Structure):
+    """ShmRingFrame from examples/cpp/shm_ring/shm_ring.h."""
+
+    _fields_ = [
+        ("frame", ctypes.c_uint64),
+        ("width", ctypes.c_uint32),
+        ("height", ctypes.c_uint32),
+        ("stride", ctypes.c_uint32),
+        ("fourcc", ctypes.c_uint32),
+        ("field", ctypes.c_int32),
+        ("sequence", ctypes.c_uint32),
+        ("timestamp_ns", ctypes.c_int64),
+        ("bytes", ctypes.c_uint64),
+        ("data", ctypes.c_void_p),
+    ]
+
+    @property
+    def image(self):
+        """The image in the shared memory, as a memoryview of bytes."""
+        return memoryview((ctypes.c_uint8 * self.bytes).from_address(self.data)).cast("B")
+
+
+def _load():
+    """Load libshm_ring.so, from SHM_RING_LIBRARY, the library path or the build tree."""
+    candidates = [os.environ.get("SHM_RING_LIBRARY"), ctypes.util.find_library("shm_ring"), "libshm_ring.so"]
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates.append(os.path.join(here, "..", "..", "..", "build", "lib", "libshm_ring.so"))
+    for candidate in candidates:
+        if not candidate:
+            continue
+        try:
+            library = ctypes.CDLL(candidate)
+            break
+        except OSError:
+            continue
+    else:
+        raise OSError("libshm_ring.so not found, build the C++ examples or set SHM_RING_LIBRARY")
+
+    library.shm_ring_reader_open.argtypes = [ctypes.c_char_p]
+    library.shm_ring_reader_open.restype = ctypes.c_void_p
+    library.shm_ring_reader_close.argtypes = [ctypes.c_void_p]
+    library.shm_ring_reader_close.restype = None
+    library.shm_ring_reader_next.argtypes = [ctypes.c_void_p, ctypes.POINTER(Frame), ctypes.c_int]
+    library.shm_ring_reader_next.restype = ctypes.c_int
+    library.shm_ring_reader_valid.argtypes = [ctypes.c_void_p, ctypes.POINTER(Frame)]
+    library.shm_ring_reader_valid.restype = ctypes.c_int
+    library.shm_ring_reader_lost.argtypes = [ctypes.c_void_p]
+    library.shm_ring_reader_lost.restype = ctypes.c_uint64
+    return library
+
+
+_library = None
+
+
+class RingClosed(Exception):
+    """The writer has closed or replaced the ring, open it again."""
+
+
+class ShmRingReader:
+    """Follows a ring from its newest frame, independently of any other reader."""
+
+    def __init__(self, name):
+        global _library
+        if _library is None:
+            _library = _load()
+        self._reader = _library.shm_ring_reader_open(name.encode())
+        if not self._reader:
+            raise FileNotFoundError("No frame ring " + name)
+
+    def next(self, timeout_ms=-1):
+        """Wait for the next frame, None on timeout, raises RingClosed when the writer has gone.
+
+        The GIL is released while waiting, so a thread per ring works.
+        """
+        frame = Frame()
+        result = _library.shm_ring_reader_next(self._reader, ctypes.byref(frame), timeout_ms)
+        if result < 0:
+            raise RingClosed()
+        return frame if result else None
+
+    def valid(self, frame):
+        """Whether the frame is still in the ring, check after using frame.image."""
+        return bool(_library.shm_ring_reader_valid(self._reader, ctypes.byref(frame)))
+
+    @property
+    def lost(self):
+        """Frames overwritten before they were read."""
+        return _library.shm_ring_reader_lost(self._reader)
+
+    def close(self):
+        """Unmap the ring, images from it must not be used after this."""
+        if self._reader:
+            _library.shm_ring_reader_close(self._reader)
+            self._reader = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __del__(self):
+        self.close()
@@ -13,13 +13,15 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10\x63ommon_can.proto\x12\x03\x63\x61n\"Q\n\nCANMessage\x12\n\n\x02id\x18\x01 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x02 \x03(\x0c\x12\x16\n\x0eis_extended_id\x18\x04 \x01(\x08\x12\x11\n\ttimestamp\x18\x06 \x01(\x04\x62\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10\x63ommon_can.proto\x12\x03\x63\x61n\"\xa1\x01\n\nCANMessage\x12\n\n\x02id\x18\x01 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x02 \x03(\x0c\x12\x16\n\x0eis_extended_id\x18\x04 \x01(\x08\x12\x11\n\ttimestamp\x18\x06 \x01(\x04\x12\x11\n\tis_remote\x18\x07 \x01(\x08\x12\x10\n\x08is_error\x18\x08 \x01(\x08\x12\r\n\x05is_fd\x18\t \x01(\x08\x12\x1a\n\x12hardware_timestamp\x18\n \x01(\x04\"U\n\x08\x43\x41NBatch\x12!\n\x08messages\x18\x01 \x03(\x0b\x32\x0f.can.CANMessage\x12\x10\n\x08sequence\x18\x02 \x01(\x04\x12\x14\n\x0cpublish_time\x18\x03 \x01(\x04\x62\x06proto3')
 
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, globals())
 _builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'common_can_pb2', globals())
 if _descriptor._USE_C_DESCRIPTORS == False:
 
   DESCRIPTOR._options = None
-  _CANMESSAGE._serialized_start=25
-  _CANMESSAGE._serialized_end=106
+  _CANMESSAGE._serialized_start=26
+  _CANMESSAGE._serialized_end=187
+  _CANBATCH._serialized_start=189
+  _CANBATCH._serialized_end=274
 # @@protoc_insertion_point(module_scope)
@@ -9,7 +9,7 @@ fi
 # Build tools
 apt-get install -y build-essential cmake
 # Install SDL2 and SDL Image
-apt-get install -y libsdl2-dev libsdl2-image-dev libgpiod-dev libgflags-dev libswscale-dev libsdl2-dev gstreamer1.0-dev libgstreamer-plugins-base1.0-dev libcairo2-dev gstreamer1.0-libav
+apt-get install -y libsdl2-dev libsdl2-image-dev libgpiod-dev libgflags-dev libswscale-dev libsdl2-dev gstreamer1.0-dev libgstreamer-plugins-base1.0-dev libcairo2-dev libjson-glib-dev gstreamer1.0-libav libjpeg-dev
 
 # echo "deb [trusted=yes] https://download.eclipse.org/zenoh/debian-repo/ /" | tee -a /etc/apt/sources.list.d/zenoh.list > /dev/null
 # apt-get update